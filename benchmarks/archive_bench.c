@@ -0,0 +1,120 @@
+// Seek latency of the replay archive: random ticks of random games, each
+// rebuilt from its keyframe. The archive is built first, from synthetic
+// tetris-like games, until it reaches the given size; an archive already at
+// the path is reused. Run with an optional size in MB, seek count and path,
+// e.g. `archive_bench 10240 100000 /data/10g.bga` for a 10 GB archive.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "archive.h"
+
+#define DEFAULT_MB 256
+#define DEFAULT_SEEKS 100000
+#define DEFAULT_PATH "archive_bench.bga"
+#define WIDTH 10
+#define LENGTH 20
+#define GAME_TICKS 50000
+#define PIECE_CELLS 4
+#define TICK_BYTES 64  // A snapshot and a few changed cells, about
+
+static long nowNs() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int compareLongs(const void* a, const void* b) {
+  const long x = *(const long*)a, y = *(const long*)b;
+  return (x > y) - (x < y);
+}
+
+// A piece falls a row per tick and settles at the bottom of its column
+static void tick(BrickFrame_t* frame, uint8_t* cells, int* row, int* column) {
+  for (int i = 0; i < PIECE_CELLS; ++i)
+    if (*row >= i) cells[(*row - i) * WIDTH + *column] = 0;
+  const int below = (*row + 1) * WIDTH + *column;
+  if (*row + 1 < LENGTH && !cells[below]) {
+    ++*row;
+  } else {
+    for (int i = 0; i < PIECE_CELLS; ++i)
+      if (*row >= i) cells[(*row - i) * WIDTH + *column] = 1;
+    frame->score += 10;
+    // A full column is emptied again, like a cleared line
+    if (*row < PIECE_CELLS)
+      for (int y = 0; y < LENGTH; ++y) cells[y * WIDTH + *column] = 0;
+    *row = 0;
+    *column = rand() % WIDTH;
+  }
+  for (int i = 0; i < PIECE_CELLS; ++i)
+    if (*row >= i) cells[(*row - i) * WIDTH + *column] = 2;
+}
+
+static int build(const char* path, const long long bytes) {
+  ArchiveWriter_t* writer = archiveCreate(path, 0);
+  uint8_t cells[WIDTH * LENGTH];
+  BrickFrame_t frame = {.width = WIDTH, .length = LENGTH, .cells = cells};
+  long long written = 0;
+  int result = writer ? EXIT_SUCCESS : EXIT_FAILURE;
+  while (result == EXIT_SUCCESS && written < bytes) {
+    memset(cells, 0, sizeof(cells));
+    frame.score = 0;
+    frame.level = 1;
+    int row = 0, column = rand() % WIDTH;
+    result = archiveBeginGame(writer, WIDTH, LENGTH);
+    for (int t = 0; t < GAME_TICKS && result == EXIT_SUCCESS; ++t) {
+      tick(&frame, cells, &row, &column);
+      result = archiveAddFrame(writer, &frame);
+    }
+    written += (long long)GAME_TICKS * TICK_BYTES;
+  }
+  if (archiveFinish(writer) != EXIT_SUCCESS) result = EXIT_FAILURE;
+  return result;
+}
+
+int main(int argc, char** argv) {
+  const long long mb = argc > 1 ? atoll(argv[1]) : DEFAULT_MB;
+  const int seeks = argc > 2 ? atoi(argv[2]) : DEFAULT_SEEKS;
+  const char* path = argc > 3 ? argv[3] : DEFAULT_PATH;
+  srand(1);
+  ArchiveReader_t* reader = archiveOpen(path);
+  if (!reader) {
+    const long start = nowNs();
+    if (build(path, mb * 1024 * 1024) != EXIT_SUCCESS) {
+      fprintf(stderr, "cannot write %s\n", path);
+      return EXIT_FAILURE;
+    }
+    printf("built %s in %.1f s\n", path, (nowNs() - start) / 1e9);
+    reader = archiveOpen(path);
+  }
+  long* samples = malloc(sizeof(long) * (seeks > 0 ? seeks : 1));
+  if (!reader || !archiveGames(reader) || !samples || seeks <= 0) {
+    fprintf(stderr, "cannot read %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  const int games = archiveGames(reader);
+  long long checksum = 0;
+  for (int i = 0; i < seeks; ++i) {
+    const int game = rand() % games;
+    const uint64_t random = (uint64_t)rand() << 16 ^ (uint64_t)rand();
+    const uint64_t tick = random % archiveTicks(reader, game);
+    const long start = nowNs();
+    const BrickFrame_t* frame = archiveSeek(reader, game, tick);
+    samples[i] = nowNs() - start;
+    checksum += frame ? frame->score : -1;
+  }
+  qsort(samples, seeks, sizeof(long), compareLongs);
+  long long total = 0;
+  for (int i = 0; i < seeks; ++i) total += samples[i];
+  printf("games:    %d\n", games);
+  printf("seeks:    %d (checksum %lld)\n", seeks, checksum);
+  printf("mean:     %.2f us\n", total / 1e3 / seeks);
+  printf("p50:      %.2f us\n", samples[seeks / 2] / 1e3);
+  printf("p99:      %.2f us\n", samples[seeks * 99 / 100] / 1e3);
+  printf("max:      %.2f us\n", samples[seeks - 1] / 1e3);
+  free(samples);
+  archiveClose(reader);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+// Lockstep stepping cost: one Snake object per game against SnakeBatch.
+// Run with optional game and step counts, e.g. `batch_bench 4096 2000`.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "snake_batch.h"
+
+namespace {
+
+using namespace brick_game;
+using Clock = std::chrono::steady_clock;
+
+// Over games start again between steps, in both engines. Seeding a new
+// generator costs far more than a step, so restarts are not timed
+struct GameOverFlag : public Mediator {
+  bool over{};
+  void Notify(Event e) override {
+    if (e == Event::GameOver) over = true;
+  }
+};
+
+struct Game {
+  std::shared_ptr<GameOverFlag> flag = std::make_shared<GameOverFlag>();
+  Snake snake;
+  explicit Game(std::uint32_t seed) : snake(flag, RandomEngine{seed}) {}
+};
+
+// The same actions for both engines: mostly straight on
+std::vector<MovementAction> MakeActions(int games, int steps) {
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<int> dist(0, 9);
+  std::vector<MovementAction> actions(static_cast<std::size_t>(games) * steps);
+  for (auto& action : actions) {
+    const int n = dist(gen);
+    action = static_cast<MovementAction>(n < 5 ? n : 4);
+  }
+  return actions;
+}
+
+double RunObjects(int games, int steps,
+                  const std::vector<MovementAction>& actions, long& restarts) {
+  std::vector<std::unique_ptr<Game>> snakes;
+  for (int g = 0; g < games; ++g) snakes.push_back(std::make_unique<Game>(g));
+  Clock::duration elapsed{};
+  for (int step = 0; step < steps; ++step) {
+    const auto* row = &actions[static_cast<std::size_t>(step) * games];
+    const auto start = Clock::now();
+    for (int g = 0; g < games; ++g) snakes[g]->snake.Move(row[g], false);
+    elapsed += Clock::now() - start;
+    for (int g = 0; g < games; ++g) {
+      if (snakes[g]->flag->over) {
+        snakes[g] = std::make_unique<Game>(g + games * (step + 1));
+        ++restarts;
+      }
+    }
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         (static_cast<double>(games) * steps);
+}
+
+double RunBatch(int games, int steps,
+                const std::vector<MovementAction>& actions, long& restarts) {
+  std::vector<std::uint32_t> seeds(games);
+  for (int g = 0; g < games; ++g) seeds[g] = g;
+  SnakeBatch batch(seeds);
+  Clock::duration elapsed{};
+  for (int step = 0; step < steps; ++step) {
+    const auto start = Clock::now();
+    batch.StepAll({&actions[static_cast<std::size_t>(step) * games],
+                   static_cast<std::size_t>(games)});
+    elapsed += Clock::now() - start;
+    for (int g = 0; g < games; ++g) {
+      if (!batch.IsAlive(g)) {
+        batch.Reset(g, g + games * (step + 1));
+        ++restarts;
+      }
+    }
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         (static_cast<double>(games) * steps);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int games = argc > 1 ? std::atoi(argv[1]) : 4096;
+  const int steps = argc > 2 ? std::atoi(argv[2]) : 1000;
+  const auto actions = MakeActions(games, steps);
+  long object_restarts = 0, batch_restarts = 0;
+  const double object_ns = RunObjects(games, steps, actions, object_restarts);
+  const double batch_ns = RunBatch(games, steps, actions, batch_restarts);
+  std::printf("%d games, %d steps each\n", games, steps);
+  std::printf("  Snake objects: %8.1f ns/game step\n", object_ns);
+  std::printf("  SnakeBatch:    %8.1f ns/game step\n", batch_ns);
+  if (object_restarts != batch_restarts)
+    std::printf("  results differ (%ld vs %ld restarts)\n", object_restarts,
+                batch_restarts);
+  return object_restarts == batch_restarts ? EXIT_SUCCESS : EXIT_FAILURE;
+}
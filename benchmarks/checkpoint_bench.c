@@ -0,0 +1,109 @@
+// Cost of forking a game: bg_save() of a stepped game in the middle of play
+// and bg_restore() of it into a second game, the way a search bot branches.
+// The game library is loaded at run time, so both engines are measured by
+// the same binary. Run with an optional library and count, e.g.
+// `checkpoint_bench ../lib/libtetris.so 100000`.
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "backend.h"
+
+#define DEFAULT_LIB "../lib/libsnake.so"
+#define DEFAULT_FORKS 100000
+#define WARMUP_TICKS 30
+
+typedef struct {
+  BrickGame_t* (*create)(const BrickGameConfig_t*);
+  void (*destroy)(BrickGame_t*);
+  void (*input)(BrickGame_t*, UserAction_t, bool);
+  void (*step)(BrickGame_t*, int);
+  size_t (*save)(BrickGame_t*, void*, size_t);
+  int (*restore)(BrickGame_t*, const void*, size_t);
+} Library_t;
+
+static long nowNs() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int compareLongs(const void* a, const void* b) {
+  const long x = *(const long*)a, y = *(const long*)b;
+  return (x > y) - (x < y);
+}
+
+static int load(const char* path, Library_t* lib) {
+  void* handle = dlopen(path, RTLD_NOW);
+  if (handle) {
+    *(void**)&lib->create = dlsym(handle, "bg_create");
+    *(void**)&lib->destroy = dlsym(handle, "bg_destroy");
+    *(void**)&lib->input = dlsym(handle, "bg_input");
+    *(void**)&lib->step = dlsym(handle, "bg_step");
+    *(void**)&lib->save = dlsym(handle, "bg_save");
+    *(void**)&lib->restore = dlsym(handle, "bg_restore");
+  }
+  return handle && lib->create && lib->destroy && lib->input && lib->step &&
+                 lib->save && lib->restore
+             ? EXIT_SUCCESS
+             : EXIT_FAILURE;
+}
+
+static void report(const char* name, long* samples, const int count) {
+  qsort(samples, count, sizeof(long), compareLongs);
+  long long total = 0;
+  for (int i = 0; i < count; ++i) total += samples[i];
+  printf("%-8s  mean %.2f us  p50 %.2f us  p99 %.2f us  max %.2f us\n", name,
+         total / 1e3 / count, samples[count / 2] / 1e3,
+         samples[count * 99 / 100] / 1e3, samples[count - 1] / 1e3);
+}
+
+int main(int argc, char** argv) {
+  const char* path = argc > 1 ? argv[1] : DEFAULT_LIB;
+  const int forks = argc > 2 ? atoi(argv[2]) : DEFAULT_FORKS;
+  Library_t lib = {0};
+  if (load(path, &lib) != EXIT_SUCCESS || forks <= 0) {
+    fprintf(stderr, "cannot load %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  const BrickGameConfig_t config = {.seed = 1, .seeded = true, .stepped = true};
+  BrickGame_t* game = lib.create(&config);
+  BrickGame_t* fork = lib.create(&config);
+  const size_t size = game ? lib.save(game, NULL, 0) : 0;
+  void* buffer = malloc(size ? size : 1);
+  long* saves = malloc(sizeof(long) * forks);
+  long* restores = malloc(sizeof(long) * forks);
+  if (!fork || !size || !buffer || !saves || !restores) {
+    fprintf(stderr, "%s has no stepped games\n", path);
+    return EXIT_FAILURE;
+  }
+  lib.input(game, Start, false);
+  for (int i = 0; i < WARMUP_TICKS; ++i) {
+    lib.input(game, i % 2 ? Left : Right, false);
+    lib.step(game, 1);
+  }
+
+  int failures = 0;
+  for (int i = 0; i < forks; ++i) {
+    long start = nowNs();
+    const size_t saved = lib.save(game, buffer, size);
+    saves[i] = nowNs() - start;
+    start = nowNs();
+    failures += saved > size || lib.restore(fork, buffer, saved);
+    restores[i] = nowNs() - start;
+    // The fork plays on a little, so the next restore has work to undo
+    lib.step(fork, 1);
+  }
+  printf("library:  %s\n", path);
+  printf("size:     %zu bytes (%d failed)\n", size, failures);
+  report("save", saves, forks);
+  report("restore", restores, forks);
+  free(restores);
+  free(saves);
+  free(buffer);
+  lib.destroy(fork);
+  lib.destroy(game);
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
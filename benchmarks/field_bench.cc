@@ -0,0 +1,90 @@
+// Apple spawning cost: Field::GetNthFreeCell against the linear bitset scan
+// it replaced. Run with an optional repeat count, e.g. `field_bench 200`.
+#include <bitset>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "field.h"
+
+namespace {
+
+using brick_game::BoardSize;
+using brick_game::Cell;
+using brick_game::Field;
+using Clock = std::chrono::steady_clock;
+
+// The previous Field implementation, kept here as the baseline
+struct ScanField {
+  ScanField(BoardSize size) : size_(size), bits_(size.Cells()) {}
+  void FillCell(Cell c) { bits_[c.first * size_.width + c.second] = true; }
+  Cell GetNthFreeCell(int n) {
+    const int total = size_.Cells();
+    int curr_cell{};
+    while (true) {
+      while (curr_cell < total && bits_[curr_cell]) curr_cell++;
+      if (!n) break;
+      --n;
+      ++curr_cell;
+    }
+    if (curr_cell >= total) curr_cell = 0;
+    return {curr_cell / size_.width, curr_cell % size_.width};
+  }
+
+ private:
+  BoardSize size_;
+  std::vector<bool> bits_;
+};
+
+// Fills the board cell by cell in random order, asking for a random free cell
+// before each fill the way Snake::SpawnApple does as the snake grows
+template <typename F>
+double Run(BoardSize size, int repeats, unsigned seed, long& checksum) {
+  const int total = size.Cells();
+  std::mt19937 gen(seed);
+  std::vector<int> order(total);
+  for (int i = 0; i < total; ++i) order[i] = i;
+  long queries = 0;
+  Clock::duration elapsed{};
+  for (int r = 0; r < repeats; ++r) {
+    std::shuffle(order.begin(), order.end(), gen);
+    F field(size);
+    const auto start = Clock::now();
+    for (int filled = 0; filled < total; ++filled) {
+      const int free_cells = total - filled;
+      const Cell c = field.GetNthFreeCell(static_cast<int>(gen() % free_cells));
+      checksum += c.first * size.width + c.second;
+      const int cell = order[filled];
+      field.FillCell({cell / size.width, cell % size.width});
+      ++queries;
+    }
+    elapsed += Clock::now() - start;
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         static_cast<double>(queries);
+}
+
+bool Compare(BoardSize size, int repeats) {
+  long scan_sum = 0, rank_sum = 0;
+  const double scan_ns = Run<ScanField>(size, repeats, 1, scan_sum);
+  const double rank_ns = Run<Field>(size, repeats, 1, rank_sum);
+  std::printf("board %dx%d, %d fills per pass, %d passes\n", size.width,
+              size.length, size.Cells(), repeats);
+  std::printf("  linear scan:  %10.1f ns/spawn\n", scan_ns);
+  std::printf("  rank-select:  %10.1f ns/spawn\n", rank_ns);
+  if (scan_sum != rank_sum)
+    std::printf("  results differ (%ld vs %ld)\n", scan_sum, rank_sum);
+  return scan_sum == rank_sum;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int repeats = argc > 1 ? std::atoi(argv[1]) : 2000;
+  bool same = Compare({}, repeats);
+  same = Compare({64, 64}, std::max(1, repeats / 100)) && same;
+  return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+// Input latency under contention: a producer sends a command every 100 us
+// (10 kHz) while the game loop holds the game mutex for a few milliseconds at
+// a time, the way a hard drop animation does. Compares pushing through the
+// lock-free movement queue with pushing under the game mutex, as input did
+// before. Run with an optional duration in seconds, e.g. `input_bench 3`.
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+#include "game_instance.h"
+#include "movement_queue.h"
+
+#define INPUT_PERIOD_NS 100000L  // 10 kHz
+#define HOLD_NS 3000000L         // Game mutex held per tick
+#define IDLE_NS 2000000L         // Game mutex free between ticks
+#define MAX_SAMPLES 200000
+
+typedef struct {
+  mtx_t lock;
+  atomic_bool running;
+  long popped;
+} Contention_t;
+
+typedef struct {
+  long samples[MAX_SAMPLES];
+  int count;
+  long results[3];
+} Latency_t;
+
+static long nowNs() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static void sleepNs(const long ns) {
+  thrd_sleep(&(struct timespec){.tv_nsec = ns}, NULL);
+}
+
+// Game loop stand-in: ticks with the mutex held, drains the queue
+static int gameLoop(void* arg) {
+  Contention_t* contention = arg;
+  while (atomic_load(&contention->running)) {
+    mtx_lock(&contention->lock);
+    while (!isEmptyQueue()) {
+      popQueue();
+      ++contention->popped;
+    }
+    sleepNs(HOLD_NS);
+    mtx_unlock(&contention->lock);
+    sleepNs(IDLE_NS);
+  }
+  return EXIT_SUCCESS;
+}
+
+static int compareLong(const void* a, const void* b) {
+  const long x = *(const long*)a, y = *(const long*)b;
+  return (x > y) - (x < y);
+}
+
+static void produce(Contention_t* contention, Latency_t* latency,
+                    const int seconds, const bool locked) {
+  const long end = nowNs() + seconds * 1000000000L;
+  for (int i = 0; nowNs() < end; ++i) {
+    const MoveCommand_t command = {.move = i % 4, .hold = i % 8 == 0};
+    const long start = nowNs();
+    QueueResult_t result;
+    if (locked) {
+      mtx_lock(&contention->lock);
+      result = pushQueue(command);
+      mtx_unlock(&contention->lock);
+    } else {
+      result = pushQueue(command);
+    }
+    const long elapsed = nowNs() - start;
+    ++latency->results[result];
+    if (latency->count < MAX_SAMPLES)
+      latency->samples[latency->count++] = elapsed;
+    if (elapsed < INPUT_PERIOD_NS) sleepNs(INPUT_PERIOD_NS - elapsed);
+  }
+}
+
+static void run(const char* name, const int seconds, const bool locked) {
+  static Latency_t latency;
+  Contention_t contention = {.running = true};
+  memset(&latency, 0, sizeof(latency));
+  mtx_init(&contention.lock, mtx_plain);
+  initQueue();
+  thrd_t loop;
+  thrd_create(&loop, gameLoop, &contention);
+  produce(&contention, &latency, seconds, locked);
+  atomic_store(&contention.running, false);
+  thrd_join(loop, NULL);
+  mtx_destroy(&contention.lock);
+
+  qsort(latency.samples, latency.count, sizeof(long), compareLong);
+  double sum = 0;
+  for (int i = 0; i < latency.count; ++i) sum += latency.samples[i];
+  printf("%s: %d inputs, %ld queued, %ld coalesced, %ld dropped\n", name,
+         latency.count, latency.results[QueuePushed],
+         latency.results[QueueCoalesced], latency.results[QueueDropped]);
+  printf("  push latency  mean %9.0f  p50 %9ld  p99 %9ld  max %9ld ns\n",
+         latency.count ? sum / latency.count : 0.0,
+         latency.count ? latency.samples[latency.count / 2] : 0,
+         latency.count ? latency.samples[latency.count * 99 / 100] : 0,
+         latency.count ? latency.samples[latency.count - 1] : 0);
+}
+
+int main(int argc, char** argv) {
+  const int seconds = argc > 1 && atoi(argv[1]) > 0 ? atoi(argv[1]) : 1;
+  run("under game mutex", seconds, true);
+  run("lock-free", seconds, false);
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,9 @@
 #ifndef BACKEND_H
 #define BACKEND_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifndef __cplusplus
 #include <stdbool.h>
 #include <stdlib.h>
@@ -8,6 +11,8 @@
 
 #define FIELD_WIDTH 10
 #define FIELD_LENGTH 20
+#define FIELD_MIN_SIZE 5
+#define FIELD_MAX_SIZE 1024
 #define NEXTF_WIDTH 4
 #define NEXTF_LENGTH 4
 
@@ -32,12 +37,155 @@ typedef struct {
   int pause;
 } GameInfo_t;
 
+/* Animation a frame belongs to. While rows are being cleared their cells keep
+ * the value the engine marks cleared rows with. */
+typedef enum { NoAnimation, DropAnimation, ClearAnimation } BrickAnimation_t;
+
+/* Immutable snapshot of a game, published by the game whenever its state
+ * changes. cells holds width * length bytes in row-major order with the same
+ * values as GameInfo_t.field. dirty lists the cell numbers that differ from
+ * the frame of generation - 1, so a renderer that saw that frame only has to
+ * redraw those; dirty_count is -1 when every cell has to be redrawn. */
+typedef struct {
+  uint64_t generation; /* number of the publication, grows by one each time */
+  int width;
+  int length;
+  const uint8_t *cells;
+  const int32_t *dirty; /* dirty_count changed cells in row-major order */
+  int dirty_count;      /* -1 after a resize or too many changes */
+  uint8_t next[NEXTF_LENGTH][NEXTF_WIDTH];
+  int score;
+  int high_score;
+  int level;
+  int speed;
+  int pause;
+  int animation; /* BrickAnimation_t playing, one frame per step */
+  int progress;  /* animation progress in percent, 0 when none */
+} BrickFrame_t;
+
+/* The eight terminal colours, numbered as in curses */
+typedef enum {
+  TermDefault = -1, /* the terminal's own background */
+  TermBlack,
+  TermRed,
+  TermGreen,
+  TermYellow,
+  TermBlue,
+  TermMagenta,
+  TermCyan,
+  TermWhite
+} BrickTermColor_t;
+
+#define PALETTE_SIZE 256
+
+/* How frontends draw one cell value: graphical ones in RGBA, terminals with
+ * a background colour and two characters. */
+typedef struct {
+  uint8_t red;
+  uint8_t green;
+  uint8_t blue;
+  uint8_t alpha;
+  int8_t term_color; /* BrickTermColor_t */
+  char glyph[3];
+} BrickPaletteEntry_t;
+
+/* Looks of every cell value a game uses, indexed by the value itself so a
+ * frontend resolves a cell with one lookup. Values the game leaves zeroed
+ * are not drawn. */
+typedef struct {
+  BrickPaletteEntry_t entries[PALETTE_SIZE];
+} BrickPalette_t;
+
+/* Opaque handle of one independent game */
+typedef struct BrickGame BrickGame_t;
+
+typedef struct {
+  int width;         /* board width, 0 for FIELD_WIDTH */
+  int length;        /* board length, 0 for FIELD_LENGTH */
+  unsigned int seed; /* random seed, used if seeded is set */
+  bool seeded;       /* false to seed from the clock */
+  bool headless;     /* true to skip drop and line clear animations */
+  bool scheduled;    /* true to run on the shared scheduler, see below */
+  bool stepped;      /* true to advance only through bg_step(), see below */
+} BrickGameConfig_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void userInput(const UserAction_t action, bool hold);
 GameInfo_t updateCurrentState();
+/* Seeds the game's random generator so a run can be reproduced. Only applies
+ * before the game is started; later games continue the seeded sequence. */
+void setGameSeed(const unsigned int seed);
+/* Chooses the board size of the game that is about to start. Both sides must
+ * lie within [FIELD_MIN_SIZE, FIELD_MAX_SIZE]. Returns EXIT_SUCCESS if applied,
+ * EXIT_FAILURE if out of range or the game is already running. */
+int setFieldSize(const int width, const int length);
+/* Reports the dimensions of the field returned by updateCurrentState(),
+ * FIELD_WIDTH x FIELD_LENGTH unless changed with setFieldSize(). */
+void getFieldSize(int *width, int *length);
+
+/* Handle based API: every handle is a separate game with its own state and
+ * threads, so one process can run many games side by side. A handle has the
+ * same threading rules as the legacy calls; different handles never share
+ * state. */
+
+/* Creates a game; config may be NULL for defaults. Returns NULL if the config
+ * is out of range or resources are exhausted. */
+BrickGame_t *bg_create(const BrickGameConfig_t *config);
+/* Stops the game if it is running and releases it. The default game is
+ * never released. */
+void bg_destroy(BrickGame_t *game);
+void bg_input(BrickGame_t *game, const UserAction_t action, bool hold);
+GameInfo_t bg_state(BrickGame_t *game);
+void bg_field_size(BrickGame_t *game, int *width, int *length);
+/* Generation of the newest frame. Lock free, so a frontend can poll it every
+ * tick and skip redrawing while it has not changed. */
+uint64_t bg_generation(BrickGame_t *game);
+/* Newest frame of the game, taken without locks or copies of the field. The
+ * frame stays unchanged until the next bg_frame() call on the same handle;
+ * one reader per handle. Before the first publication the frame is empty. */
+const BrickFrame_t *bg_frame(BrickGame_t *game);
+/* Sleeps until a frame newer than seen is published or timeout_ms pass, so a
+ * frontend only wakes up when there is something to draw. Returns the newest
+ * generation, seen or below on timeout. */
+uint64_t bg_wait(BrickGame_t *game, uint64_t seen, int timeout_ms);
+/* Logs every input of the game to path, with the timer tick it came in at,
+ * until called again with NULL or the game is destroyed. A stepped game
+ * given the log's seed, ticks and inputs plays the session again, see
+ * replay.h. Only before a game starts, since the game is seeded for the
+ * log; returns EXIT_FAILURE if it runs or path cannot be written. */
+int bg_record(BrickGame_t *game, const char *path);
+/* Palette of the values in the game's cells, the same for every handle and
+ * never freed. Frontends read it once when they load the game. */
+const BrickPalette_t *bg_palette(void);
+/* The game driven by the legacy userInput()/updateCurrentState() */
+BrickGame_t *bg_default(void);
+/* Games created with BrickGameConfig_t.scheduled start no threads of their
+ * own: their timers run on one process-wide pool of workers, so thousands of
+ * games cost a handful of threads. Sets the pool size (0 for one worker per
+ * processor); only possible before the first scheduled game, returns
+ * EXIT_FAILURE afterwards. */
+int bg_scheduler_workers(int workers);
+/* Games created with BrickGameConfig_t.stepped have no timers and no
+ * animations: bg_input() applies a move before it returns and the game only
+ * falls or crawls when bg_step() says so. Meant for simulations and bots that
+ * run many games faster than real time. Advances the game by ticks timer
+ * periods; does nothing for other games. */
+void bg_step(BrickGame_t *game, int ticks);
+/* Checkpoints of stepped games: a copy of everything the game is made of,
+ * so a bot can fork a position and a server can suspend a session. Returns
+ * the size of the checkpoint and writes it to buffer only if it fits in size
+ * bytes, so bg_save(game, NULL, 0) asks for the size. Returns 0 for games
+ * that are not stepped. */
+size_t bg_save(BrickGame_t *game, void *buffer, size_t size);
+/* Puts a stepped game of the same library in the state of a checkpoint,
+ * board size included; the checkpoint may come from another game. Returns
+ * EXIT_FAILURE if the game is not stepped or buffer is not a whole checkpoint
+ * of this library, which leaves the game untouched. A successful restore
+ * ends the recording of the game, if any. */
+int bg_restore(BrickGame_t *game, const void *buffer, size_t size);
 
 #ifdef __cplusplus
 }
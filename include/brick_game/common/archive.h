@@ -0,0 +1,127 @@
+/**
+ * @file archive.h
+ * @brief Many played games in one file, any tick of any game a seek away
+ * @details
+ * - Every tick of a game is stored as the GameInfo_t snapshot it showed:
+ *   field, next shape, score, high score, level, speed and pause
+ * - Every keyframe interval ticks the snapshot is stored whole; the ticks in
+ *   between only store the cells that changed since the tick before
+ * - Each game ends with the offsets of its keyframes and the file ends with
+ *   an index of the games, which the header points to
+ * - The reader maps the file, so reaching tick T of game G takes an index
+ *   lookup, a keyframe lookup and at most interval - 1 deltas, however large
+ *   the archive is
+ * - Numbers are stored in the byte order of the machine that wrote them
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdint.h>
+
+#include "backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARCHIVE_VERSION 1           ///< Format written by archiveCreate()
+#define ARCHIVE_DEFAULT_INTERVAL 64 ///< Ticks between keyframes by default
+
+/**
+ * @brief Opaque archive being written
+ */
+typedef struct ArchiveWriter ArchiveWriter_t;
+
+/**
+ * @brief Opaque archive being read
+ */
+typedef struct ArchiveReader ArchiveReader_t;
+
+/**
+ * @brief Creates an archive
+ * @param path File to create or truncate
+ * @param interval Ticks between keyframes, 0 for ARCHIVE_DEFAULT_INTERVAL
+ * @return New writer, NULL if the file cannot be written
+ */
+ArchiveWriter_t *archiveCreate(const char *path, const int interval);
+
+/**
+ * @brief Starts the next game, ending the one before if it is still open
+ * @param writer Archive to add to
+ * @param width Field width of the game
+ * @param length Field length of the game
+ * @return EXIT_SUCCESS, EXIT_FAILURE if out of range or out of memory
+ */
+int archiveBeginGame(ArchiveWriter_t *writer, const int width,
+                     const int length);
+
+/**
+ * @brief Appends the next tick of the current game
+ * @param writer Archive to add to
+ * @param frame State of the game at this tick, of the size the game began
+ * with; its dirty list is not used
+ * @return EXIT_SUCCESS, EXIT_FAILURE if no game is open or the write fails
+ */
+int archiveAddFrame(ArchiveWriter_t *writer, const BrickFrame_t *frame);
+
+/**
+ * @brief Ends the current game
+ * @param writer Archive to add to
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the write fails
+ */
+int archiveEndGame(ArchiveWriter_t *writer);
+
+/**
+ * @brief Ends the current game, writes the index and closes the archive
+ * @param writer Archive to close, may be NULL
+ * @return EXIT_SUCCESS, EXIT_FAILURE if any write failed
+ */
+int archiveFinish(ArchiveWriter_t *writer);
+
+/**
+ * @brief Maps an archive for reading
+ * @param path File to read
+ * @return New reader, NULL if the file is missing, damaged or not an archive
+ * of this version
+ */
+ArchiveReader_t *archiveOpen(const char *path);
+
+/**
+ * @brief Gets the number of games in an archive
+ * @param reader Archive to query
+ * @return Number of games
+ */
+int archiveGames(const ArchiveReader_t *reader);
+
+/**
+ * @brief Gets the number of ticks stored for a game
+ * @param reader Archive to query
+ * @param game Game number, from 0
+ * @return Number of ticks, 0 if there is no such game
+ */
+uint64_t archiveTicks(const ArchiveReader_t *reader, const int game);
+
+/**
+ * @brief Rebuilds the state of a game at a tick
+ * @param reader Archive to read
+ * @param game Game number, from 0
+ * @param tick Tick number, from 0
+ * @return Frame owned by the reader and valid until its next seek, with the
+ * tick as generation and no dirty list; NULL if there is no such tick
+ * @warning One seek at a time per reader
+ */
+const BrickFrame_t *archiveSeek(ArchiveReader_t *reader, const int game,
+                                const uint64_t tick);
+
+/**
+ * @brief Unmaps an archive
+ * @param reader Archive to close, may be NULL
+ */
+void archiveClose(ArchiveReader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,70 @@
+/**
+ * @file checkpoint.h
+ * @brief Header every engine puts in front of its bg_save() checkpoints
+ * @details
+ * - A checkpoint is a memory image of one game, meant to be restored by the
+ *   same build of the same engine, in this process or another one
+ * - The header names the engine and the size, so a checkpoint of another
+ *   engine or a cut off one is refused before anything is read
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHECKPOINT_VERSION 1  ///< Layout written by ckInitHeader()
+
+/**
+ * @enum CheckpointEngine_t
+ * @brief Engine a checkpoint belongs to
+ */
+typedef enum {
+  CheckpointSnake = 1,  ///< Snake model
+  CheckpointTetris      ///< Tetris engine
+} CheckpointEngine_t;
+
+/**
+ * @struct CheckpointHeader_t
+ * @brief Start of every checkpoint
+ */
+typedef struct {
+  char magic[4];     ///< "BGCK"
+  uint32_t version;  ///< CHECKPOINT_VERSION
+  uint32_t engine;   ///< CheckpointEngine_t of the game
+  uint32_t layout;   ///< Size of the engine's fixed part, guards its layout
+  uint64_t size;     ///< Bytes of the whole checkpoint
+} CheckpointHeader_t;
+
+/**
+ * @brief Fills a checkpoint header
+ * @param header Header to fill
+ * @param engine Engine writing the checkpoint
+ * @param layout Size of the engine's fixed part
+ * @param size Bytes of the whole checkpoint
+ */
+void ckInitHeader(CheckpointHeader_t *header, const CheckpointEngine_t engine,
+                  const size_t layout, const size_t size);
+
+/**
+ * @brief Checks that a buffer holds a whole checkpoint of an engine
+ * @param buffer Checkpoint to check, may be NULL
+ * @param size Bytes in buffer
+ * @param engine Engine expected to have written it
+ * @param layout Size of the engine's fixed part
+ * @return true if the header matches and buffer holds all of it
+ */
+bool ckCheckHeader(const void *buffer, const size_t size,
+                   const CheckpointEngine_t engine, const size_t layout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
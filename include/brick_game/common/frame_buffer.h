@@ -0,0 +1,114 @@
+/**
+ * @file frame_buffer.h
+ * @brief Triple buffered, versioned game frames shared by all engines
+ * @details
+ * - The writer fills a private back frame and publishes it with a single
+ *   atomic exchange, so a frame is never modified once readers can see it
+ * - The reader takes the newest published frame without locks; the frame
+ *   stays intact until the reader asks for the next one
+ * - Every publication increments the generation counter, which can be polled
+ *   without touching the frames at all
+ * - Every frame lists the cells that changed since the previous publication,
+ *   so a reader that saw that one only redraws what changed
+ * @warning One writer and one reader at a time: concurrent writers must be
+ * serialized by the engine, concurrent readers by the frontend
+ */
+
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <stdint.h>
+
+#include "backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque triple buffer of BrickFrame_t
+ */
+typedef struct FrameBuffer FrameBuffer_t;
+
+/**
+ * @brief Creates a buffer of empty frames
+ * @param width Field width in cells
+ * @param length Field length in cells
+ * @return New buffer, NULL if out of memory
+ */
+FrameBuffer_t *fbCreate(const int width, const int length);
+
+/**
+ * @brief Releases the buffer and every cell array it ever allocated
+ * @param fb Buffer to release, may be NULL
+ */
+void fbDestroy(FrameBuffer_t *fb);
+
+/**
+ * @brief Changes the field size of subsequently published frames
+ * @param fb Buffer to resize (writer side)
+ * @param width New field width
+ * @param length New field length
+ * @note Frames already published keep their own size; the back frame grows
+ * its cell array on the next publication
+ */
+void fbResize(FrameBuffer_t *fb, const int width, const int length);
+
+/**
+ * @brief Sets the animation stamped on subsequently published frames
+ * @param fb Buffer to publish to (writer side)
+ * @param animation BrickAnimation_t in progress
+ * @param progress Its progress in percent
+ */
+void fbSetAnimation(FrameBuffer_t *fb, const int animation, const int progress);
+
+/**
+ * @brief Copies a legacy GameInfo_t into the back frame and publishes it
+ * @param fb Buffer to publish to (writer side)
+ * @param info State to publish; NULL field or next tables publish empty cells
+ * @note Nothing is published if the back frame cannot grow to the new size
+ */
+void fbPublishInfo(FrameBuffer_t *fb, const GameInfo_t *info);
+
+/**
+ * @brief Publishes packed cells without going through int tables
+ * @param fb Buffer to publish to (writer side)
+ * @param cells Row-major field cells, one byte each, NULL for an empty field
+ * @param next Row-major next shape cells, NULL for an empty preview
+ * @param stats Score, level, speed and pause; its tables are ignored
+ * @note Nothing is published if the back frame cannot grow to the new size
+ */
+void fbPublishCells(FrameBuffer_t *fb, const uint8_t *cells,
+                    const uint8_t *next, const GameInfo_t *stats);
+
+/**
+ * @brief Takes the newest published frame (reader side)
+ * @param fb Buffer to read
+ * @return Frame that stays unchanged until the next fbAcquire() call
+ */
+const BrickFrame_t *fbAcquire(FrameBuffer_t *fb);
+
+/**
+ * @brief Gets the generation of the newest published frame
+ * @param fb Buffer to query, NULL yields 0
+ * @return Number of frames published so far
+ */
+uint64_t fbGeneration(const FrameBuffer_t *fb);
+
+/**
+ * @brief Sleeps until a frame newer than seen is published
+ * @param fb Buffer to watch; NULL, a game that never published, sleeps the
+ * whole timeout
+ * @param seen Generation the caller already has
+ * @param timeout_ms Longest wait in milliseconds
+ * @return Generation of the newest published frame
+ * @note Publishing only signals when somebody waits, writers that are never
+ * watched pay one atomic load per frame
+ */
+uint64_t fbWait(FrameBuffer_t *fb, const uint64_t seen, const int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
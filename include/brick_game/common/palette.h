@@ -0,0 +1,40 @@
+/**
+ * @file palette.h
+ * @brief Palette of the FieldCellColors_t cell values
+ * @details
+ * - Palettes are constant tables indexed by cell value, declared by each game
+ *   and exported with bg_palette()
+ * - Frontends turn the palette into their own lookup table once, when the
+ *   game is loaded, and fall back to this one for libraries without it
+ */
+
+#ifndef PALETTE_H
+#define PALETTE_H
+
+#include "backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializer of an opaque entry drawn as two blanks on a terminal
+ */
+#define PALETTE_COLOR(r, g, b, term)                           \
+  {.red = (r),                                                 \
+   .green = (g),                                               \
+   .blue = (b),                                                \
+   .alpha = 255,                                               \
+   .term_color = (term),                                       \
+   .glyph = "  "}
+
+/**
+ * @brief Palette of games whose cells hold FieldCellColors_t values
+ */
+const BrickPalette_t *paletteDefault(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
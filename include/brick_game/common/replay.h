@@ -0,0 +1,124 @@
+/**
+ * @file replay.h
+ * @brief Compact binary log of a game's input, replayed tick for tick
+ * @details
+ * - A log starts with the "BGRP" magic followed by the format version, the
+ *   random seed and the board size, each an unsigned LEB128 varint
+ * - Every input is one varint: the timer ticks since the previous record
+ *   shifted left by REPLAY_KIND_BITS, over the action and the hold flag
+ * - Closing the log adds an end record holding the last tick, so a replay
+ *   also plays out the time after the last input
+ * - Inputs mostly arrive a few ticks apart and take one or two bytes each;
+ *   an hour of play is a few kilobytes
+ * - Ticks are the engine's timer periods, so a stepped game that is given
+ *   the same seed, ticks and inputs plays the recorded session again
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+#include "backend.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REPLAY_VERSION 1    ///< Format written by replayCreate()
+#define REPLAY_KIND_BITS 5  ///< Low bits of a record that say what it is
+#define REPLAY_HOLD 8       ///< Record kind bit set for held keys
+#define REPLAY_END 16       ///< Record kind of the end record
+
+/**
+ * @brief What a replay needs to recreate the recorded game
+ */
+typedef struct {
+  uint32_t seed;  ///< Seed of the game's random generator
+  int width;      ///< Board width
+  int length;     ///< Board length
+} ReplayHeader_t;
+
+/**
+ * @brief One recorded input
+ */
+typedef struct {
+  uint64_t tick;        ///< Timer ticks the game had run when it came in
+  UserAction_t action;  ///< Action sent
+  bool hold;            ///< Whether the key was held
+} ReplayEvent_t;
+
+/**
+ * @brief Opaque log being written
+ */
+typedef struct ReplayWriter ReplayWriter_t;
+
+/**
+ * @brief Opaque log being read
+ */
+typedef struct ReplayReader ReplayReader_t;
+
+/**
+ * @brief Creates a log and writes its header
+ * @param path File to create or truncate
+ * @param header Game the log is for
+ * @param tick Timer ticks the game has run so far; the log counts from there
+ * @return New writer, NULL if the file cannot be written
+ */
+ReplayWriter_t *replayCreate(const char *path, const ReplayHeader_t *header,
+                             const uint64_t tick);
+
+/**
+ * @brief Appends an input
+ * @param writer Log to append to, NULL records nothing
+ * @param tick Timer ticks the game has run, never less than the last one
+ * @param action Action sent to the game
+ * @param hold Whether the key was held
+ * @note Every record is flushed, a crashed process leaves a readable log
+ */
+void replayRecord(ReplayWriter_t *writer, const uint64_t tick,
+                  const UserAction_t action, const bool hold);
+
+/**
+ * @brief Writes the end record and closes the log
+ * @param writer Log to close, may be NULL
+ * @param tick Timer ticks the game has run
+ */
+void replayFinish(ReplayWriter_t *writer, const uint64_t tick);
+
+/**
+ * @brief Opens a log and reads its header
+ * @param path File to read
+ * @param header Receives the recorded game
+ * @return New reader, NULL if the file is missing or not a log of this
+ * version
+ */
+ReplayReader_t *replayOpen(const char *path, ReplayHeader_t *header);
+
+/**
+ * @brief Reads the next input
+ * @param reader Log to read
+ * @param event Receives the input
+ * @return true for an input, false at the end of the log
+ */
+bool replayNext(ReplayReader_t *reader, ReplayEvent_t *event);
+
+/**
+ * @brief Gets the last tick of the log
+ * @param reader Log read up to its end with replayNext()
+ * @return Tick of the end record, or of the last input if the log was never
+ * closed
+ */
+uint64_t replayEndTick(const ReplayReader_t *reader);
+
+/**
+ * @brief Closes a log
+ * @param reader Log to close, may be NULL
+ */
+void replayClose(ReplayReader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file scheduler.h
+ * @brief Timers of many games driven by one small pool of worker threads
+ * @details
+ * - Every timer is a task with a due time kept in a min-heap; workers sleep
+ *   until the earliest one is due, run it and put it back with the delay the
+ *   task asked for
+ * - A task may park itself until it is woken, so idle games cost nothing
+ * - A timer never runs on two workers at once, different timers run in
+ *   parallel
+ * - Replaces the per-game threads of both engines for games created with
+ *   BrickGameConfig_t.scheduled; the shared scheduler serves all of them
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCHED_TASK_IDLE (-1)  ///< Task result: park until schedWake()
+#define SCHED_TASK_DONE (-2)  ///< Task result: release the timer
+
+/**
+ * @brief Opaque scheduler with its worker threads
+ */
+typedef struct Scheduler Scheduler_t;
+
+/**
+ * @brief Handle of a timer, 0 is never a valid one
+ */
+typedef uint64_t SchedTimerId_t;
+
+/**
+ * @brief Timer callback
+ * @param arg Argument given to schedAdd()
+ * @return Delay in nanoseconds until the next run, SCHED_TASK_IDLE or
+ * SCHED_TASK_DONE
+ */
+typedef int64_t (*SchedTask_t)(void *arg);
+
+/**
+ * @brief Creates a scheduler and starts its workers
+ * @param workers Number of worker threads, at least one
+ * @return New scheduler, NULL if out of resources
+ */
+Scheduler_t *schedCreate(const int workers);
+
+/**
+ * @brief Stops the workers and releases the scheduler
+ * @param sched Scheduler to release, may be NULL
+ * @warning Cancel every timer first; pending timers are dropped unrun
+ */
+void schedDestroy(Scheduler_t *sched);
+
+/**
+ * @brief Registers a timer
+ * @param sched Scheduler to run it
+ * @param task Callback
+ * @param arg Argument of the callback
+ * @param delay Nanoseconds until the first run, SCHED_TASK_IDLE to start
+ * parked
+ * @return Timer handle, 0 if out of memory
+ */
+SchedTimerId_t schedAdd(Scheduler_t *sched, SchedTask_t task, void *arg,
+                        const int64_t delay);
+
+/**
+ * @brief Runs a parked or waiting timer as soon as possible
+ * @param sched Scheduler of the timer
+ * @param id Timer to wake; a timer that is running runs again right after
+ * @note Unknown or released timers are ignored
+ */
+void schedWake(Scheduler_t *sched, const SchedTimerId_t id);
+
+/**
+ * @brief Releases a timer
+ * @param sched Scheduler of the timer
+ * @param id Timer to cancel
+ * @note Waits for a run in progress, so the task never runs once this
+ * returns; a task may cancel its own timer without waiting
+ */
+void schedCancel(Scheduler_t *sched, const SchedTimerId_t id);
+
+/**
+ * @brief Sets the number of workers of the shared scheduler
+ * @param workers Number of worker threads, 0 for one per processor
+ * @return 0 on success, -1 if the shared scheduler is already running
+ */
+int schedSetSharedWorkers(const int workers);
+
+/**
+ * @brief Gets the process-wide scheduler, starting it on first use
+ * @return Shared scheduler, NULL if it could not be started
+ */
+Scheduler_t *schedShared(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -6,6 +6,8 @@
 #endif
 
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
 
 #include "backend.h"
 #include "input_mapping.h"
@@ -21,10 +23,57 @@ concept BrickGameModel =
       m.GetCurrentStateCopy();
     };
 
+// Модель, чей генератор случайных чисел можно засеять извне
+template <typename Model>
+concept SeedableModel =
+    BrickGameModel<Model> && requires(Model& m, unsigned int seed) {
+      { m.Seed(seed) } -> std::convertible_to<bool>;
+    };
+
+// Модель, размер поля которой выбирается перед началом игры
+template <typename Model>
+concept ResizableModel =
+    BrickGameModel<Model> && requires(Model& m, int width, int length) {
+      { m.Resize(width, length) } -> std::convertible_to<bool>;
+      { m.GetBoardSize().width } -> std::convertible_to<int>;
+      { m.GetBoardSize().length } -> std::convertible_to<int>;
+    };
+
+// Модель, публикующая неизменяемые версионированные кадры состояния
+template <typename Model>
+concept FramedModel = BrickGameModel<Model> && requires(Model& m) {
+  { m.AcquireFrame() } -> std::convertible_to<const BrickFrame_t*>;
+  { m.GetGeneration() } -> std::convertible_to<std::uint64_t>;
+  {
+    m.WaitGeneration(std::uint64_t{}, int{})
+  } -> std::convertible_to<std::uint64_t>;
+};
+
+// Модель, считающая отработанные периоды своего таймера
+template <typename Model>
+concept TickedModel = BrickGameModel<Model> && requires(const Model& m) {
+  { m.GetTicks() } -> std::convertible_to<std::uint64_t>;
+};
+
+// Модель без таймера реального времени, которую двигают вручную
+template <typename Model>
+concept SteppedModel =
+    BrickGameModel<Model> && requires(Model& m, int ticks) { m.Step(ticks); };
+
+// Модель, состояние которой можно сохранить в буфер и восстановить из него
+template <typename Model>
+concept CheckpointModel =
+    BrickGameModel<Model> && requires(Model& m, void* out, const void* in) {
+      { m.Save(out, std::size_t{}) } -> std::convertible_to<std::size_t>;
+      { m.Restore(in, std::size_t{}) } -> std::convertible_to<bool>;
+    };
+
 // Задаем модель шаблонным параметром, получаем статический полиморфизм
 // контролера и возможность переиспользования с другими играми Brickgame
 template <BrickGameModel Model>
 struct Controler {
+  // Отдельные экземпляры нужны для handle-based API (bg_create)
+  Controler() = default;
   Controler(const Controler&) = delete;
   Controler& operator=(const Controler&) = delete;
   Controler(Controler&& o) : model_(std::move(o.model_), assigner_(this)) {}
@@ -43,8 +92,69 @@ struct Controler {
 
   GameInfo_t getGameInfoCopy() { return model_.GetCurrentStateCopy(); }
 
+  const BrickFrame_t* GetFrame()
+    requires FramedModel<Model>
+  {
+    return model_.AcquireFrame();
+  }
+
+  std::uint64_t GetGeneration()
+    requires FramedModel<Model>
+  {
+    return model_.GetGeneration();
+  }
+
+  std::uint64_t WaitGeneration(std::uint64_t seen, int timeout_ms)
+    requires FramedModel<Model>
+  {
+    return model_.WaitGeneration(seen, timeout_ms);
+  }
+
+  std::uint64_t GetTicks() const
+    requires TickedModel<Model>
+  {
+    return model_.GetTicks();
+  }
+
+  void Step(int ticks)
+    requires SteppedModel<Model>
+  {
+    model_.Step(ticks);
+  }
+
+  std::size_t Save(void* buffer, std::size_t size)
+    requires CheckpointModel<Model>
+  {
+    return model_.Save(buffer, size);
+  }
+
+  bool Restore(const void* buffer, std::size_t size)
+    requires CheckpointModel<Model>
+  {
+    return model_.Restore(buffer, size);
+  }
+
+  bool SetSeed(unsigned int seed)
+    requires SeedableModel<Model>
+  {
+    return model_.Seed(seed);
+  }
+
+  bool SetFieldSize(int width, int length)
+    requires ResizableModel<Model>
+  {
+    return model_.Resize(width, length);
+  }
+
+  void GetFieldSize(int& width, int& length)
+    requires ResizableModel<Model>
+  {
+    const auto size = model_.GetBoardSize();
+    width = size.width;
+    length = size.length;
+  }
+
  private:
-  Controler() = default;
   Model model_{};
 
   struct ActionAssigner {
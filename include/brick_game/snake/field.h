@@ -1,13 +1,66 @@
 #ifndef FIELD_H
 #define FIELD_H
-#include <bitset>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <memory>
+#include <vector>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
 
 #include "backend.h"
 #include "colors.h"
 
 namespace brick_game {
 
+// Occupancy bitsets keep cell n in bit n % kWordBits of word n / kWordBits
+constexpr int kWordBits = 64;
+
+constexpr std::uint64_t CellBit(int n) {
+  return std::uint64_t{1} << (n % kWordBits);
+}
+
+// Position of the n-th set bit of word, n must be below its popcount
+inline int SelectBit(std::uint64_t word, int n) {
+#ifdef __BMI2__
+  return std::countr_zero(_pdep_u64(std::uint64_t{1} << n, word));
+#else
+  int base{};
+  for (int width = kWordBits / 2; width >= 8; width /= 2) {
+    const std::uint64_t low = word & ((std::uint64_t{1} << width) - 1);
+    const int count = std::popcount(low);
+    if (n < count) {
+      word = low;
+    } else {
+      n -= count;
+      word >>= width;
+      base += width;
+    }
+  }
+  for (; n > 0; --n) word &= word - 1;
+  return base + std::countr_zero(word);
+#endif
+}
+
+// n-th free cell in row-major order of an occupancy bitset of cells cells, 0
+// if there are not that many. Skips whole words by popcount and selects inside
+// the last one, so the cost depends on the number of words rather than on
+// occupied cells
+inline int NthFreeCell(const std::uint64_t* words, int cells, int n) {
+  const int count = (cells + kWordBits - 1) / kWordBits;
+  for (int w{}; n >= 0 && w < count; ++w) {
+    const int bits = cells - w * kWordBits;
+    const std::uint64_t valid =
+        bits >= kWordBits ? ~std::uint64_t{} : CellBit(bits) - 1;
+    const std::uint64_t free = ~words[w] & valid;
+    const int free_in_word = std::popcount(free);
+    if (n < free_in_word) return w * kWordBits + SelectBit(free, n);
+    n -= free_in_word;
+  }
+  return 0;
+}
+
 struct Cell : public std::pair<int, int> {
   Cell(int f = 0, int s = 0) : std::pair<int, int>(f, s) {}
   Cell operator+(const Cell& o) const {
@@ -16,80 +69,163 @@ struct Cell : public std::pair<int, int> {
   }
 };
 
+// Board dimensions, chosen once per game
+struct BoardSize {
+  int width = FIELD_WIDTH;
+  int length = FIELD_LENGTH;
+  int Cells() const { return width * length; }
+  bool IsValid() const {
+    return width >= FIELD_MIN_SIZE && width <= FIELD_MAX_SIZE &&
+           length >= FIELD_MIN_SIZE && length <= FIELD_MAX_SIZE;
+  }
+  bool operator==(const BoardSize&) const = default;
+};
+
+// Colors of the cells, one byte each. The int tables of GameInfo_t are only
+// built on request and only refreshed after the bytes have changed
 struct FieldView {
-  FieldView()
-      : field_ptrs_(std::make_unique_for_overwrite<int*[]>(FIELD_LENGTH)),
-        next_field_ptrs_(std::make_unique_for_overwrite<int*[]>(NEXTF_LENGTH)),
-        flat_data_(
-            std::make_unique<int[]>(FIELD_LENGTH * FIELD_WIDTH + NEXTF_WIDTH)) {
-    for (int i{}; i < FIELD_LENGTH; ++i) {
-      field_ptrs_[i] = &flat_data_[i * FIELD_WIDTH];
-    }
-    // assign all Next field ptrs to same empty array
-    for (int i{}; i < NEXTF_LENGTH; ++i) {
-      next_field_ptrs_[i] = &flat_data_[FIELD_LENGTH * FIELD_WIDTH];
+  FieldView(BoardSize size = {}) : size_(size), cells_(size.Cells()) {}
+
+  std::uint8_t* GetCells() { return cells_.data(); }
+  void SetCell(int n, std::uint8_t color) {
+    if (cells_[n] != color) {
+      cells_[n] = color;
+      tables_outdated_ = true;
     }
   }
-  int** GetField() { return field_ptrs_.get(); }
-  int** GetNext() { return next_field_ptrs_.get(); }
+  void MarkChanged() { tables_outdated_ = true; }
+
+  int** GetField() {
+    UpdateTables();
+    return field_ptrs_.get();
+  }
+  int** GetNext() {
+    UpdateTables();
+    return next_field_ptrs_.get();
+  }
 
  private:
+  BoardSize size_;
+  std::vector<std::uint8_t> cells_;
+  bool tables_outdated_ = true;
   std::unique_ptr<int*[]> field_ptrs_;
   std::unique_ptr<int*[]> next_field_ptrs_;
   std::unique_ptr<int[]> flat_data_;
+
+  void UpdateTables() {
+    if (!flat_data_) {
+      field_ptrs_ = std::make_unique_for_overwrite<int*[]>(size_.length);
+      next_field_ptrs_ = std::make_unique_for_overwrite<int*[]>(NEXTF_LENGTH);
+      flat_data_ = std::make_unique<int[]>(size_.Cells() + NEXTF_WIDTH);
+      for (int i{}; i < size_.length; ++i) {
+        field_ptrs_[i] = &flat_data_[i * size_.width];
+      }
+      // assign all Next field ptrs to same empty array
+      for (int i{}; i < NEXTF_LENGTH; ++i) {
+        next_field_ptrs_[i] = &flat_data_[size_.Cells()];
+      }
+    }
+    if (tables_outdated_) {
+      std::copy(cells_.begin(), cells_.end(), flat_data_.get());
+      tables_outdated_ = false;
+    }
+  }
 };
 
 struct Field {
-  static const int kTotalCells = FIELD_LENGTH * FIELD_WIDTH;
+  Field(BoardSize size = {})
+      : size_(size),
+        words_((size.Cells() + kWordBits - 1) / kWordBits),
+        field_view_(size) {}
+
+  BoardSize GetSize() const { return size_; }
+  int TotalCells() const { return size_.Cells(); }
+  int GetCellNum(Cell c) const {
+    const auto [y, x] = c;
+    return y * size_.width + x;
+  }
+  Cell GetCell(int n) const { return {n / size_.width, n % size_.width}; }
   void FillCell(Cell c) {
-    bitset_[GetCellNum(c)] = 1;
-    field_view_outdated_ = true;
+    const int n = GetCellNum(c);
+    words_[n / kWordBits] |= Bit(n);
+    MarkDirty(n);
+  }
+  void EmptyCell(Cell c) {
+    const int n = GetCellNum(c);
+    words_[n / kWordBits] &= ~Bit(n);
+    MarkDirty(n);
+  }
+  void Clear() {
+    std::fill(words_.begin(), words_.end(), 0);
+    RepaintAll();
+  }
+  bool CheckCell(Cell c) {
+    const int n = GetCellNum(c);
+    return words_[n / kWordBits] & Bit(n);
   }
-  void EmptyCell(Cell c) { bitset_[GetCellNum(c)] = 0; }
-  bool CheckCell(Cell c) { return bitset_[GetCellNum(c)]; }
 
+  // n-th free cell in row-major order, {0, 0} if there are not that many
   Cell GetNthFreeCell(int n) {
-    int curr_cell{};
+    return GetCell(NthFreeCell(words_.data(), TotalCells(), n));
+  }
 
-    while (true) {
-      while (curr_cell < kTotalCells && bitset_[curr_cell]) curr_cell++;
-      if (!n) break;
-      --n;
-      ++curr_cell;
+  // Row-major cell colors, valid until the field changes. Only the cells
+  // changed since the previous call are repainted
+  const std::uint8_t* GetCells(bool gameover) {
+    if (gameover != view_gameover_) {
+      view_gameover_ = gameover;
+      RepaintAll();
     }
-    if (curr_cell >= kTotalCells) curr_cell = 0;
-    return {curr_cell / FIELD_WIDTH, curr_cell % FIELD_WIDTH};
+    if (repaint_all_ || !dirty_.empty()) UpdateFieldView();
+    return field_view_.GetCells();
   }
-
   void PlaceFieldAndNext(GameInfo_t& gi, bool gameover) {
-    if (field_view_outdated_ || gameover) UpdateFieldView(gameover);
-
+    GetCells(gameover);
     gi.field = field_view_.GetField();
     gi.next = field_view_.GetNext();
   }
   void PlaceApple(Cell apple) {
-    auto [y, x] = apple;
-    field_view_.GetField()[y][x] = Red;
+    field_view_.SetCell(GetCellNum(apple), Red);
   }
 
  private:
-  std::bitset<kTotalCells> bitset_{};
-  FieldView field_view_{};
-  bool field_view_outdated_ = true;
-
-  void UpdateFieldView(bool gameover) {
-    int body_color = gameover ? Damaged : Green;
-    for (int y{}; y < FIELD_LENGTH; ++y) {
-      for (int x{}; x < FIELD_WIDTH; ++x) {
-        field_view_.GetField()[y][x] = CheckCell({y, x}) ? body_color : Empty;
-      }
-    }
-    field_view_outdated_ = false;
+  BoardSize size_;
+  std::vector<std::uint64_t> words_;
+  FieldView field_view_;
+  // Cells changed since the view was painted, unless it is repainted whole
+  std::vector<int> dirty_;
+  bool repaint_all_ = true;
+  bool view_gameover_ = false;
+
+  // A snake move changes two or three cells, a long list means the view has
+  // not been looked at for a while and a full repaint is cheaper
+  void MarkDirty(int n) {
+    if (repaint_all_) return;
+    if (static_cast<int>(dirty_.size()) < size_.Cells() / 8 + 4)
+      dirty_.push_back(n);
+    else
+      RepaintAll();
   }
-  int GetCellNum(const Cell c) {
-    const auto [y, x] = c;
-    return y * FIELD_WIDTH + x;
+  void RepaintAll() {
+    repaint_all_ = true;
+    dirty_.clear();
+  }
+  std::uint8_t CellColor(int n) const {
+    if (!(words_[n / kWordBits] & Bit(n))) return Empty;
+    return view_gameover_ ? Damaged : Green;
+  }
+  void UpdateFieldView() {
+    if (repaint_all_) {
+      std::uint8_t* cells = field_view_.GetCells();
+      for (int n{}; n < size_.Cells(); ++n) cells[n] = CellColor(n);
+      field_view_.MarkChanged();
+      repaint_all_ = false;
+    } else {
+      for (int n : dirty_) field_view_.SetCell(n, CellColor(n));
+      dirty_.clear();
+    }
   }
+  static constexpr std::uint64_t Bit(int n) { return CellBit(n); }
 };
 
 }  // namespace brick_game
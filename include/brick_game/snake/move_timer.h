@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <thread>
 
 #include "backend.h"
@@ -22,6 +23,7 @@ struct MoveTimer : public Component {
         delay_(o.delay_.load()),
         skip_movement_{o.skip_movement_.load()},
         paused{o.paused.load()},
+        ticks_{o.ticks_.load()},
         timer_{[this](auto token) { TimerLoop(token); }} {}
 
   MoveTimer& operator=(MoveTimer&& o) {
@@ -30,6 +32,7 @@ struct MoveTimer : public Component {
       delay_ = o.delay_.load();
       skip_movement_ = o.skip_movement_.load();
       paused = o.paused.load();
+      ticks_ = o.ticks_.load();
       timer_ = std::jthread{[this](auto token) { TimerLoop(token); }};
     }
     return *this;
@@ -39,6 +42,9 @@ struct MoveTimer : public Component {
 
   void PlayerMoved() { skip_movement_.store(true); }
 
+  // Periods run while not paused, counted like StepTimer counts them
+  std::uint64_t GetTicks() const { return ticks_.load(); }
+
   void IncreaseSpeed() {
     msec current = delay_.load();
     msec new_delay = msec(static_cast<int>(current.count() * kDelayDecay));
@@ -69,11 +75,13 @@ struct MoveTimer : public Component {
   std::atomic<msec> delay_ = kStartDelay;
   std::atomic_bool skip_movement_{};
   std::atomic_bool paused{};
+  std::atomic<std::uint64_t> ticks_{};
   std::jthread timer_;
 
   void TimerLoop(std::stop_token token) {
     while (!token.stop_requested()) {
       std::this_thread::sleep_for(delay_.load());
+      if (!paused) ++ticks_;
       if (!skip_movement_ && this->mediator_)
         this->mediator_->Notify(Event::TimeToMove);
       else
@@ -0,0 +1,132 @@
+#ifndef SCHEDULED_TIMER_H
+#define SCHEDULED_TIMER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <new>
+
+#include "mediator.h"
+#include "move_timer.h"
+#include "scheduler.h"
+
+namespace brick_game {
+
+// MoveTimer without a thread of its own: the ticks run as a timer on the
+// process-wide scheduler, so many games share a few worker threads. A paused
+// timer parks until Unpaused wakes it and then waits a full period, like
+// MoveTimer does.
+struct ScheduledTimer : public Component {
+  ScheduledTimer(std::shared_ptr<Mediator> m) : Component(std::move(m)) {
+    Start();
+  }
+  // o is stopped before the base is moved, so it cannot fire half moved
+  ScheduledTimer(ScheduledTimer&& o)
+      : Component(std::move(Stopped(o))),
+        delay_(o.delay_.load()),
+        skip_movement_{o.skip_movement_.load()},
+        paused_{o.paused_.load()},
+        ticks_{o.ticks_.load()} {
+    Start();
+  }
+
+  ScheduledTimer& operator=(ScheduledTimer&& o) {
+    if (this != &o) {
+      Stop();
+      o.Stop();
+      Component::operator=(std::move(o));
+      delay_ = o.delay_.load();
+      skip_movement_ = o.skip_movement_.load();
+      paused_ = o.paused_.load();
+      ticks_ = o.ticks_.load();
+      Start();
+    }
+    return *this;
+  }
+
+  ~ScheduledTimer() override { Stop(); }
+
+  void PlayerMoved() { skip_movement_.store(true); }
+
+  // Periods run while not paused, counted like StepTimer counts them
+  std::uint64_t GetTicks() const { return ticks_.load(); }
+
+  void IncreaseSpeed() {
+    msec current = delay_.load();
+    delay_.store(msec(static_cast<int>(current.count() * kDelayDecay)));
+  }
+
+  void ProcessEvent(Event e) override {
+    switch (e) {
+      case Event::PlayerMoved:
+        PlayerMoved();
+        break;
+      case Event::NewLevel:
+        IncreaseSpeed();
+        break;
+      case Event::Paused:
+        paused_ = true;
+        break;
+      case Event::Unpaused:
+        paused_ = false;
+        resumed_ = true;
+        schedWake(schedShared(), id_);
+        break;
+      default:
+        break;
+    }
+  }
+
+ private:
+  std::atomic<msec> delay_ = kStartDelay;
+  std::atomic_bool skip_movement_{};
+  std::atomic_bool paused_{};
+  std::atomic_bool resumed_{};
+  std::atomic<std::uint64_t> ticks_{};
+  SchedTimerId_t id_{};
+
+  std::int64_t Period() const {
+    return std::chrono::nanoseconds(delay_.load()).count();
+  }
+
+  // One iteration of MoveTimer::TimerLoop after its sleep
+  std::int64_t Tick() {
+    std::int64_t next = SCHED_TASK_IDLE;
+    if (resumed_.exchange(false)) {
+      next = Period();
+    } else if (!paused_) {
+      ++ticks_;
+      if (!skip_movement_ && this->mediator_)
+        this->mediator_->Notify(Event::TimeToMove);
+      else
+        skip_movement_ = false;
+      if (!paused_) next = Period();
+    }
+    return next;
+  }
+
+  static std::int64_t Fire(void* self) {
+    return static_cast<ScheduledTimer*>(self)->Tick();
+  }
+
+  void Start() {
+    Scheduler_t* sched = schedShared();
+    id_ = sched ? schedAdd(sched, &Fire, this,
+                           paused_ ? SCHED_TASK_IDLE : Period())
+                : 0;
+    if (!id_) throw std::bad_alloc();
+  }
+
+  void Stop() {
+    if (id_) schedCancel(schedShared(), id_);
+    id_ = 0;
+  }
+
+  static ScheduledTimer& Stopped(ScheduledTimer& o) {
+    o.Stop();
+    return o;
+  }
+};
+
+};  // namespace brick_game
+#endif
@@ -1,13 +1,15 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 #include <concepts>
+#include <cstdint>
 #include <initializer_list>
 #include <mutex>
-#include <queue>
+#include <random>
 
 #include "field.h"
 #include "input_mapping.h"
 #include "mediator.h"
+#include "snake_body.h"
 
 namespace brick_game {
 
@@ -31,8 +33,14 @@ struct Direction {
       MovementAction::Up};
 };
 
+// Every snake owns its generator, so games never share random state and a
+// seeded game always spawns the same apples
+using RandomEngine = std::mt19937;
+
 struct Snake : public Component {
-  Snake(std::shared_ptr<Mediator> m);
+  Snake(std::shared_ptr<Mediator> m,
+        RandomEngine gen = RandomEngine{std::random_device{}()},
+        BoardSize size = {});
   Snake(const Snake&) = delete;
   Snake(Snake&& o) noexcept;
 
@@ -41,20 +49,51 @@ struct Snake : public Component {
 
   void Move(MovementAction new_direction, bool player_command = true);
   void PlaceGameInfo(GameInfo_t& gi, bool gameover);
+  // Hands the packed cell colors to the visitor while the snake is still
+  // locked, so they cannot change under the visitor
+  template <std::invocable<const std::uint8_t*> Visitor>
+  void VisitCells(bool gameover, Visitor&& visit) {
+    std::scoped_lock<std::mutex> lock(mtx_);
+    const std::uint8_t* cells = field_.GetCells(gameover);
+    if (!gameover) field_.PlaceApple(apple_);
+    visit(cells);
+  }
   void ProcessEvent(Event) override;
+  const RandomEngine& GetRandomEngine() const { return gen_; }
+  BoardSize GetBoardSize() const { return field_.GetSize(); }
+  int GetBodySize() const { return snake_body_.Size(); }
+
+  // Everything a snake is made of but its body, which a checkpoint keeps
+  // after this as body_size cell numbers from the tail to the head. The
+  // generator is copied as it lies in memory
+  struct Checkpoint {
+    unsigned char gen[sizeof(RandomEngine)];
+    std::int32_t width;
+    std::int32_t length;
+    std::int32_t apple;
+    std::int32_t body_size;
+    MovementAction direction;
+    std::uint8_t got_apple;  // 0 or 1, never read straight into a bool
+  };
+  // body receives GetBodySize() cells, unaligned
+  void Save(Checkpoint& checkpoint, void* body);
+  // Whether Restore() can take the checkpoint and its body_size cells
+  static bool IsValid(const Checkpoint& checkpoint, const void* body);
+  // Takes over a valid checkpoint, reusing the field if the size is the same
+  void Restore(const Checkpoint& checkpoint, const void* body);
 
  private:
-  using SnakeBody = std::queue<Cell>;
   std::mutex mtx_{};
   Cell apple_;
   bool got_apple_{};
   Field field_{};
   SnakeBody snake_body_;
   Direction direction_{};
+  RandomEngine gen_;
 
   void InitializeSnake();
 
-  void AddSnakeSeg(const Cell& seg);
+  void AddSnakeSeg(Cell seg);
 
   void AddSnakeSeg(std::initializer_list<Cell> list);
 
@@ -66,7 +105,7 @@ struct Snake : public Component {
 
   int GetRandomFreeCellNum();
 
-  bool IsCollision();
+  bool IsCollision(Cell next);
 };
 
 };  // namespace brick_game
@@ -0,0 +1,85 @@
+#ifndef SNAKE_BATCH_H
+#define SNAKE_BATCH_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "field.h"
+#include "input_mapping.h"
+#include "snake.h"
+
+namespace brick_game {
+
+// Many snake games stepped in lockstep, for training and simulation. Heads,
+// directions, apples, scores, body ring buffers and occupancy bitsets are
+// kept as one array per property instead of one object graph per game, so a
+// step walks a few dense arrays. The first pass over all games is branch
+// free and compiled into vector code: it validates the turn, computes the
+// next head and checks it against the walls and the apple. Only the games
+// still alive then touch their bitset and body.
+//
+// Every game plays exactly like Snake::Move driven with the same actions:
+// same seeds give the same apples, scores, levels and game overs.
+struct SnakeBatch {
+  // One game per seed, all on boards of the same size
+  explicit SnakeBatch(std::span<const std::uint32_t> seeds,
+                      BoardSize size = {});
+
+  // Moves every live game once, like Snake::Move(actions[i]). Action keeps
+  // the direction, a reversal is ignored; over games stay as they are
+  void StepAll(std::span<const MovementAction> actions);
+  // Starts game i over with a new seed
+  void Reset(int game, std::uint32_t seed);
+
+  int GetGames() const { return static_cast<int>(alive_.size()); }
+  BoardSize GetBoardSize() const { return size_; }
+  bool IsAlive(int game) const { return alive_[game]; }
+  int GetScore(int game) const { return score_[game]; }
+  int GetLevel(int game) const { return alive_[game] ? level_[game] : 0; }
+  int GetLength(int game) const { return length_[game]; }
+  Cell GetHead(int game) const { return {head_y_[game], head_x_[game]}; }
+  Cell GetApple(int game) const;
+  // Row-major cell colors of game i, the way Snake::VisitCells() shows them
+  void GetCells(int game, std::uint8_t* cells) const;
+
+ private:
+  BoardSize size_;
+  int cells_;
+  int words_;
+  // Per game, index is the game
+  std::vector<std::int32_t> head_y_;
+  std::vector<std::int32_t> head_x_;
+  std::vector<std::int8_t> direction_;  // MovementAction, never Action
+  std::vector<std::int32_t> apple_;     // cell number
+  std::vector<std::int32_t> score_;
+  std::vector<std::int32_t> level_;
+  std::vector<std::int32_t> length_;
+  std::vector<std::int32_t> tail_;  // ring index of the tail
+  std::vector<std::uint8_t> got_apple_;
+  std::vector<std::uint8_t> alive_;
+  std::vector<RandomEngine> gen_;
+  // cells_ entries per game: body cell numbers from the tail, wrapping
+  std::vector<std::int32_t> body_;
+  // words_ entries per game
+  std::vector<std::uint64_t> occupancy_;
+  // Results of the vector pass of StepAll, reused between steps
+  std::vector<std::int32_t> next_;  // cell number, -1 off the board
+  std::vector<std::uint8_t> moves_;
+  std::vector<std::uint8_t> eats_;
+
+  std::uint64_t* Occupancy(int game) {
+    return &occupancy_[static_cast<std::size_t>(game) * words_];
+  }
+  const std::uint64_t* Occupancy(int game) const {
+    return &occupancy_[static_cast<std::size_t>(game) * words_];
+  }
+  std::int32_t* Body(int game) {
+    return &body_[static_cast<std::size_t>(game) * cells_];
+  }
+  void PushHead(int game, std::int32_t cell);
+  void SpawnApple(int game);
+};
+
+};  // namespace brick_game
+#endif
@@ -0,0 +1,63 @@
+#ifndef SNAKE_BODY_H
+#define SNAKE_BODY_H
+#include <cstdint>
+#include <vector>
+
+namespace brick_game {
+
+// Cell numbers of the snake from the tail to the head. The ring is sized to
+// the board once, so a move never allocates and touches the head and tail
+// slots only. Numbers take 16 bits; boards of more than 65536 cells, which
+// the size limits allow, fall back to 32 bits
+struct SnakeBody {
+  explicit SnakeBody(int capacity) : capacity_(capacity) {
+    if (IsWide())
+      wide_.resize(capacity_);
+    else
+      narrow_.resize(capacity_);
+  }
+
+  int Size() const { return size_; }
+  int Capacity() const { return capacity_; }
+  int Front() const { return Get(tail_); }
+  int Back() const { return Get(Slot(size_ - 1)); }
+  // i-th cell from the tail
+  int At(int i) const { return Get(Slot(i)); }
+  // The body never holds more cells than the board has
+  void Push(int cell) {
+    Set(Slot(size_), cell);
+    ++size_;
+  }
+  void Pop() {
+    tail_ = Slot(1);
+    --size_;
+  }
+  void Clear() { tail_ = size_ = 0; }
+
+ private:
+  static constexpr int kNarrowCells = 1 << 16;
+  int capacity_;
+  int tail_{};
+  int size_{};
+  std::vector<std::uint16_t> narrow_;
+  std::vector<std::uint32_t> wide_;
+
+  bool IsWide() const { return capacity_ > kNarrowCells; }
+  int Slot(int i) const {
+    i += tail_;
+    return i < capacity_ ? i : i - capacity_;
+  }
+  int Get(int slot) const {
+    return IsWide() ? static_cast<int>(wide_[slot]) : narrow_[slot];
+  }
+  void Set(int slot, int cell) {
+    if (IsWide())
+      wide_[slot] = static_cast<std::uint32_t>(cell);
+    else
+      narrow_[slot] = static_cast<std::uint16_t>(cell);
+  }
+};
+
+};  // namespace brick_game
+
+#endif
@@ -1,16 +1,25 @@
 #ifndef SNAKE_MODEL_H
 #define SNAKE_MODEL_H
 
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <utility>
 
 #include "backend.h"
+#include "frame_buffer.h"
 #include "fsm.h"
 #include "mediator.h"
 #include "move_timer.h"
 #include "observable.h"
+#include "scheduled_timer.h"
 #include "simple_file_storage.h"
 #include "snake.h"
 #include "stats_keeper.h"
+#include "step_timer.h"
 
 namespace brick_game {
 
@@ -31,20 +40,97 @@ struct SnakeMediator : public Observer<SnakeFSM>, public Mediator {
   State state_;
 };
 
-struct SnakeModel {
-  SnakeModel();
+// Publishes a frame after every timer driven move; subscribed to TimeToMove
+// after the snake, so it runs once the move and its consequences are done
+struct FramePublisher : public Component {
+  FramePublisher(std::shared_ptr<Mediator> m, std::function<void()> publish)
+      : Component(std::move(m)), publish_(std::move(publish)) {}
+  void ProcessEvent(Event) override { publish_(); }
+
+ private:
+  std::function<void()> publish_;
+};
+
+// Source of movement ticks: MoveTimer runs in real time on its own thread,
+// ScheduledTimer in real time on the shared scheduler, StepTimer only
+// advances when the model's Step() is called
+template <typename Timer>
+concept IsMoveTimer =
+    std::derived_from<Timer, Component> &&
+    std::constructible_from<Timer, std::shared_ptr<Mediator>> &&
+    std::is_move_assignable_v<Timer>;
+
+// Timers whose state can be copied out and back, which only makes sense for
+// the ones that do not run on their own
+template <typename Timer>
+concept CheckpointTimer =
+    requires(Timer& t, const typename Timer::Checkpoint& c) {
+      { t.Save() } -> std::same_as<typename Timer::Checkpoint>;
+      { Timer::IsValid(c) } -> std::same_as<bool>;
+      t.Restore(c);
+    };
+
+template <IsMoveTimer Timer>
+struct BasicSnakeModel {
+  BasicSnakeModel();
+  explicit BasicSnakeModel(std::uint32_t seed);
+  // The frame publisher keeps a pointer to the model
+  BasicSnakeModel(const BasicSnakeModel&) = delete;
+  BasicSnakeModel& operator=(const BasicSnakeModel&) = delete;
   void TakeMoveAction(MovementAction a);
   void TakeGameControlAction(ControlAction a);
   GameInfo_t GetCurrentStateCopy();
+  // Restarts the random stream of a game that is not started yet, later games
+  // continue the same stream. Returns false if the game is already running
+  bool Seed(std::uint32_t seed);
+  // Board size of the next game, applies only before it is started
+  bool Resize(int width, int length);
+  BoardSize GetBoardSize() const { return snake_->GetBoardSize(); }
+  // Newest published frame, unchanged until the next call; single reader
+  const BrickFrame_t* AcquireFrame() { return fbAcquire(frames_.get()); }
+  std::uint64_t GetGeneration() const { return fbGeneration(frames_.get()); }
+  std::uint64_t WaitGeneration(std::uint64_t seen, int timeout_ms) {
+    return fbWait(frames_.get(), seen, timeout_ms);
+  }
+
+  // Timer periods run since the model was made, across every game it played
+  std::uint64_t GetTicks() const {
+    return ticks_before_reset_ + move_timer_->GetTicks();
+  }
+
+  // Advances a headless model by the given number of timer periods
+  void Step(int ticks = 1)
+    requires requires(Timer& t) { t.Step(ticks); }
+  {
+    move_timer_->Step(ticks);
+  }
+
+  // Copies the whole game to buffer if it fits in size bytes and returns the
+  // size of the checkpoint, so Save(nullptr, 0) asks for it
+  std::size_t Save(void* buffer, std::size_t size)
+    requires CheckpointTimer<Timer>;
+  // Takes over the game of a checkpoint, board size included. Returns false
+  // and leaves the model as it was if buffer is not a whole checkpoint
+  bool Restore(const void* buffer, std::size_t size)
+    requires CheckpointTimer<Timer>;
 
  private:
   std::shared_ptr<SnakeMediator> mediator_;
   std::shared_ptr<SnakeFSM> fsm_;
   std::shared_ptr<Snake> snake_;
   std::shared_ptr<StatsKeeper<SimpleFileStorage>> stats_keeper_;
-  std::shared_ptr<MoveTimer> move_timer_;
+  std::shared_ptr<Timer> move_timer_;
+  std::shared_ptr<FramePublisher> frame_publisher_;
+  std::unique_ptr<FrameBuffer_t, decltype(&fbDestroy)> frames_;
+  std::mutex publish_mtx_;
+  std::uint64_t ticks_before_reset_{};
   void Connect();
   void Reset();
+  void PublishFrame();
 };
+
+using SnakeModel = BasicSnakeModel<MoveTimer>;
+using ScheduledSnakeModel = BasicSnakeModel<ScheduledTimer>;
+using HeadlessSnakeModel = BasicSnakeModel<StepTimer>;
 };  // namespace brick_game
 #endif
\ No newline at end of file
@@ -44,6 +44,23 @@ struct StatsKeeper : public Component, public DataStorage {
     SaveHighscore();
   }
 
+  // Plain copy of the stats, for checkpoints
+  struct Checkpoint {
+    int score;
+    int level;
+    int highscore;
+  };
+  Checkpoint Save() const { return {score_, level_, highscore_}; }
+  static bool IsValid(const Checkpoint& c) {
+    return c.score >= 0 && c.highscore >= 0 && c.level >= 1 &&
+           c.level <= kMaxLevel;
+  }
+  void Restore(const Checkpoint& c) {
+    score_ = c.score;
+    level_ = c.level;
+    highscore_ = c.highscore;
+  }
+
   int GetScore() { return score_; }
   int GetHighscore() { return highscore_; }
 
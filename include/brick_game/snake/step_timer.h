@@ -0,0 +1,92 @@
+#ifndef STEP_TIMER_H
+#define STEP_TIMER_H
+
+#include <cstdint>
+
+#include "mediator.h"
+#include "move_timer.h"
+
+namespace brick_game {
+
+// Headless counterpart of MoveTimer: no thread and no sleeping. Each tick
+// passed to Step() stands for one elapsed timer period, so the model advances
+// exactly as fast as the caller drives it and always in the same order.
+struct StepTimer : public Component {
+  StepTimer(std::shared_ptr<Mediator> m) : Component(std::move(m)) {}
+  StepTimer(StepTimer&&) = default;
+  StepTimer& operator=(StepTimer&&) = default;
+  ~StepTimer() override = default;
+
+  void Step(int ticks = 1) {
+    for (; ticks > 0; --ticks) Tick();
+  }
+
+  void PlayerMoved() { skip_movement_ = true; }
+
+  void IncreaseSpeed() {
+    delay_ = msec(static_cast<int>(delay_.count() * kDelayDecay));
+  }
+
+  // Period a real-time MoveTimer would sleep before the next tick
+  msec GetDelay() const { return delay_; }
+  std::uint64_t GetTicks() const { return ticks_; }
+
+  // Plain copy of the timer, for checkpoints
+  struct Checkpoint {
+    msec::rep delay;
+    std::uint64_t ticks;
+    // 0 or 1, never read straight into a bool
+    std::uint8_t skip_movement;
+    std::uint8_t paused;
+  };
+  Checkpoint Save() const {
+    return {delay_.count(), ticks_, skip_movement_, paused_};
+  }
+  static bool IsValid(const Checkpoint& c) {
+    return c.delay > 0 && c.skip_movement <= 1 && c.paused <= 1;
+  }
+  void Restore(const Checkpoint& c) {
+    delay_ = msec(c.delay);
+    ticks_ = c.ticks;
+    skip_movement_ = c.skip_movement == 1;
+    paused_ = c.paused == 1;
+  }
+
+  void ProcessEvent(Event e) override {
+    switch (e) {
+      case Event::PlayerMoved:
+        PlayerMoved();
+        break;
+      case Event::NewLevel:
+        IncreaseSpeed();
+        break;
+      case Event::Paused:
+        paused_ = true;
+        break;
+      case Event::Unpaused:
+        paused_ = false;
+        break;
+      default:
+        break;
+    }
+  }
+
+ private:
+  msec delay_ = kStartDelay;
+  std::uint64_t ticks_{};
+  bool skip_movement_{};
+  bool paused_{};
+
+  // Mirrors one iteration of MoveTimer::TimerLoop, minus the sleep
+  void Tick() {
+    if (paused_) return;
+    ++ticks_;
+    if (!skip_movement_ && this->mediator_)
+      this->mediator_->Notify(Event::TimeToMove);
+    else
+      skip_movement_ = false;
+  }
+};
+
+};  // namespace brick_game
+#endif
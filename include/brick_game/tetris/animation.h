@@ -0,0 +1,80 @@
+/**
+ * @file animation.h
+ * @brief Timed animation state of the tetris game loop
+ * @details
+ * - Hard drops and line clears advance one step per ANIMATION_SLEEP_TIME
+ *   instead of sleeping in the game loop, so the game mutex stays free and
+ *   input keeps flowing while they play
+ * - The game loop sleeps until the next step is due and publishes a frame
+ *   per step, the frame carries the animation and its progress
+ * - Headless games (BrickGameConfig_t.headless) never start an animation,
+ *   drops land and rows clear at once
+ * @warning Only the game loop thread drives the animation of its game
+ */
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <threads.h>
+
+#include "backend.h"
+
+#define DROP_LANDING_STEPS 5  ///< Steps a dropped piece rests before input
+#define CLEAR_STEPS 8         ///< Steps filled rows flash before removal
+
+/**
+ * @struct Animation_t
+ * @brief Animation in progress
+ */
+typedef struct {
+  BrickAnimation_t kind;  ///< NoAnimation when idle
+  int step;               ///< Steps done
+  int steps;              ///< Steps in total
+  struct timespec due;    ///< When the next step is due, TIME_UTC
+} Animation_t;
+
+/**
+ * @brief Starts an animation, its first step is due ANIMATION_SLEEP_TIME
+ * from now
+ * @param kind Animation to play
+ * @param steps Number of steps
+ * @note Does nothing in headless games
+ */
+void startAnimation(const BrickAnimation_t kind, const int steps);
+
+/**
+ * @brief Stops the animation in progress
+ */
+void stopAnimation();
+
+/**
+ * @brief Checks whether an animation is in progress
+ * @return true until the animation is stopped
+ */
+bool isAnimating();
+
+/**
+ * @brief Checks whether the next animation step is due
+ * @return true if an animation is in progress and its step time has come
+ */
+bool isAnimationDue();
+
+/**
+ * @brief Counts the step being played and schedules the next one
+ * @return Number of the step, 1 for the first one
+ */
+int nextAnimationStep();
+
+/**
+ * @brief Gets the animation in progress
+ * @return Animation of the current game
+ */
+const Animation_t* getAnimation();
+
+/**
+ * @brief Gets the animation progress for frames
+ * @return Progress in percent, 0 when idle
+ */
+int getAnimationProgress();
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file bitboard.h
+ * @brief Occupancy bitboard behind the bitboard tetris engine
+ * @details
+ * - Keeps one bit per settled cell, a row is a run of 64-bit words, so a
+ *   classic 10-wide row is a single word compared against 0x3FF
+ * - Every shape and rotation is precomputed as up to four row masks, so a
+ *   collision check is a handful of shifts and ANDs instead of per-cell
+ *   rotation math and field lookups
+ * - Line clears shift the row array like destroyRows() shifts the field
+ * - Used when the library is built with TETRIS_BITBOARD, the cell engine
+ *   never touches it
+ * @warning Works on the game bound to the calling thread, like every other
+ * tetris module; callers hold the game mutex
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#include "backend.h"
+#include "tetromino.h"
+
+/**
+ * @struct Bitboard_t
+ * @brief Settled cells of one game, bit x % 64 of word x / 64 of each row
+ */
+typedef struct {
+  uint64_t* rows;  ///< length rows of words words each
+  int words;       ///< Words per row
+  int width;       ///< Field width the rows are sized for
+  int length;      ///< Field length the rows are sized for
+} Bitboard_t;
+
+/**
+ * @brief Sizes the bitboard for the current field and empties it
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if out of memory
+ */
+int initBitboard();
+
+/**
+ * @brief Releases the bitboard memory
+ */
+void freeBitboard();
+
+/**
+ * @brief Rebuilds the bitboard from the cells of a field
+ * @param field Field whose non-empty cells are occupied
+ * @note Needed whenever the field was written directly (tests, restored
+ * games); the moving piece must not be on the field
+ */
+void rebuildBitboard(FieldCell_t** field);
+
+/**
+ * @brief Checks whether a tetromino is off the field or overlaps settled cells
+ * @param tetromino Tetromino in its new position
+ * @return true if the position is not allowed
+ * @note Cells above the field are allowed, like in canMove()
+ */
+bool collidesOnBitboard(const Tetromino_t* tetromino);
+
+/**
+ * @brief Marks the cells of a settling tetromino as occupied
+ * @param tetromino Tetromino being settled
+ */
+void settleOnBitboard(const Tetromino_t* tetromino);
+
+/**
+ * @brief Checks whether every cell of a row is occupied
+ * @param row Row index
+ * @return true if the row is full
+ */
+bool isBitboardRowFull(const int row);
+
+/**
+ * @brief Removes rows ending before row and shifts the rows above down
+ * @param row Index of the first row below the removed block
+ * @param combo Number of removed rows
+ * @note Mirrors destroyRows()
+ */
+void removeBitboardRows(const int row, const int combo);
+
+#endif
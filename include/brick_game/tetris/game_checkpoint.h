@@ -0,0 +1,68 @@
+/**
+ * @file game_checkpoint.h
+ * @brief Checkpoints of the current game, behind bg_save() and bg_restore()
+ * @details
+ * - A checkpoint is a fixed part followed by the field cells, one byte each
+ * - The fixed part holds the stats, state, piece in play, animation, random
+ *   generator, tick count and next shape, so a restored game goes on exactly
+ *   as the saved one would have
+ * - Only stepped games are checkpointed: nothing of theirs runs in the
+ *   background and their movement queue is empty between calls
+ */
+
+#ifndef GAME_CHECKPOINT_H
+#define GAME_CHECKPOINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "animation.h"
+#include "checkpoint.h"
+#include "game_data.h"
+
+/// Next shape cells in a checkpoint, the last one holds the shape number
+#define CHECKPOINT_NEXT_CELLS (NEXTF_LENGTH * NEXTF_WIDTH + 1)
+
+/**
+ * @struct TetrisCheckpoint_t
+ * @brief Fixed part of a tetris checkpoint, the field cells follow it
+ */
+typedef struct {
+  CheckpointHeader_t header;               ///< Engine, layout and size
+  int32_t width;                           ///< Field width
+  int32_t length;                          ///< Field length
+  GameState_t state;                       ///< Game state
+  int score;                               ///< Current score
+  int high_score;                          ///< Best score so far
+  int level;                               ///< Current level
+  int speed;                               ///< Current speed
+  int pause;                               ///< Whether the game is paused
+  Tetromino_t current;                     ///< Piece in play
+  Animation_t animation;                   ///< Always idle, games are headless
+  uint32_t rng_state;                      ///< Random generator state
+  uint8_t rng_seeded;                      ///< Generator seeded, 0 or 1
+  uint64_t ticks;                          ///< Gravity ticks run
+  FieldCell_t next[CHECKPOINT_NEXT_CELLS]; ///< Next shape and its number
+} TetrisCheckpoint_t;
+
+/**
+ * @brief Copies the current game to a buffer
+ * @param buffer Buffer to fill, may be NULL
+ * @param size Bytes in buffer
+ * @return Size of the checkpoint; buffer is only written if it fits
+ */
+size_t saveGame(void *buffer, const size_t size);
+
+/**
+ * @brief Puts the current game in the state of a checkpoint
+ * @param buffer Checkpoint written by saveGame()
+ * @param size Bytes in buffer
+ * @return EXIT_SUCCESS, EXIT_FAILURE if buffer is not a whole tetris
+ * checkpoint, in which case the game is left untouched, or if the game data
+ * cannot be allocated
+ * @note Starts or ends the game as the checkpoint requires and takes over its
+ * board size
+ */
+int restoreGame(const void *buffer, const size_t size);
+
+#endif
@@ -10,9 +10,12 @@
 #ifndef GAME_DATA_H
 #define GAME_DATA_H
 
+#include <stdint.h>
 #include <threads.h>
 
 #include "backend.h"
+#include "scheduler.h"
+#include "tetromino.h"
 
 /**
  * @enum GameState_t
@@ -27,11 +30,13 @@ typedef enum {
 
 /**
  * @struct Threads_t
- * @brief Container for game threads
+ * @brief Container for game threads, or their timers in scheduled mode
  */
 typedef struct {
-  thrd_t main;       ///< Main game thread
-  thrd_t scheduler;  ///< Scheduler/controller thread
+  thrd_t main;             ///< Main game thread
+  thrd_t scheduler;        ///< Scheduler/controller thread
+  SchedTimerId_t logic;    ///< Game logic timer, scheduled mode
+  SchedTimerId_t gravity;  ///< Auto-shift timer, scheduled mode
 } Threads_t;
 
 /**
@@ -44,10 +49,18 @@ int initGameData();
 
 /**
  * @brief Gets the main game information structure
- * @return Pointer to GameInfo_t containing field, score, speed, etc.
+ * @return Pointer to PackedGameInfo_t containing field, score, speed, etc.
  * @note Thread-safe when used with proper mutex locking
  */
-GameInfo_t* getGameInfo();
+PackedGameInfo_t* getGameInfo();
+
+/**
+ * @brief Builds the int table view of the game info for the legacy API
+ * @return State with int tables, rebuilt only if a frame was published since
+ * the previous call
+ * @note The caller must hold the mutex
+ */
+GameInfo_t exportGameInfo();
 
 /**
  * @brief Gets the global game mutex
@@ -61,6 +74,27 @@ mtx_t* getMutex();
  */
 cnd_t* getPauseCondition();
 
+/**
+ * @brief Gets the condition the main game loop sleeps on
+ * @return Pointer to condition variable signalled when the movement queue gets
+ * a command or the game is about to end
+ */
+cnd_t* getWorkCondition();
+
+/**
+ * @brief Gets the mutex paired with the work condition
+ * @return Pointer to mutex held only while the game loop decides to sleep, so
+ * waking it never waits for the game mutex
+ */
+mtx_t* getWorkMutex();
+
+/**
+ * @brief Wakes the main game loop if it sleeps on the work condition, or its
+ * logic timer in scheduled mode
+ * @note Safe with or without the game mutex held
+ */
+void wakeGameLoop();
+
 /**
  * @brief Gets the game thread handles
  * @return Pointer to Threads_t structure containing game threads
@@ -87,10 +121,117 @@ bool isGameState(const GameState_t state);
  */
 void setGameState(const GameState_t state);
 
+/**
+ * @brief Sets the field dimensions used by the next initGameData()
+ * @param width Field width in cells
+ * @param length Field length in cells
+ * @note Bounds are checked by the caller; the setting survives cleanUpData()
+ */
+void setBoardSize(const int width, const int length);
+
+/**
+ * @brief Gets the field width
+ * @return Configured width, FIELD_WIDTH by default
+ */
+int getFieldWidth();
+
+/**
+ * @brief Gets the field length
+ * @return Configured length, FIELD_LENGTH by default
+ */
+int getFieldLength();
+
+/**
+ * @brief Chooses between own threads and the shared scheduler
+ * @param scheduled true to run the next games on the shared scheduler
+ * @note Survives cleanUpData() like the board size
+ */
+void setScheduled(const bool scheduled);
+
+/**
+ * @brief Checks whether the game runs on the shared scheduler
+ * @return true in scheduled mode
+ */
+bool isScheduled();
+
+/**
+ * @brief Chooses between timers and stepping by hand
+ * @param stepped true to advance the next games only through bg_step()
+ * @note Survives cleanUpData() like the board size
+ */
+void setStepped(const bool stepped);
+
+/**
+ * @brief Checks whether the game is stepped by hand
+ * @return true in stepped mode
+ */
+bool isStepped();
+
+/**
+ * @brief Gets the tetromino in play
+ * @return Pointer to the piece the game logic moves
+ */
+Tetromino_t* getCurrentTetromino();
+
+/**
+ * @brief Turns animations off or on
+ * @param headless true to land drops and clear rows without animating
+ * @note Survives cleanUpData() like the board size
+ */
+void setHeadless(const bool headless);
+
+/**
+ * @brief Checks whether animations are off
+ * @return true for headless games
+ */
+bool isHeadless();
+
+/**
+ * @brief Seeds the game's random generator
+ * @param seed Seed value, equal seeds produce equal shape sequences
+ * @note Generator state survives cleanUpData(), so consecutive games continue
+ * one sequence instead of repeating the same shapes
+ */
+void seedRandom(const uint32_t seed);
+
+/**
+ * @brief Checks whether the random generator has been seeded
+ * @return true after the first seedRandom() call
+ */
+bool isRandomSeeded();
+
+/**
+ * @brief Gets the generator state, seeding another game with it continues
+ * the same sequence
+ * @return Current random generator state
+ */
+uint32_t getRandomState();
+
+/**
+ * @brief Advances the game's random generator
+ * @return Next pseudo-random value of the seeded sequence
+ */
+uint32_t nextRandom();
+
 /**
  * @brief Cleans up all game resources
- * @note Destroys mutex/cond and zeros all game data
+ * @note Destroys mutex/cond and zeros all game data except the random
+ * generator state, board size and field storage
  */
 void cleanUpData();
 
+/**
+ * @brief Publishes the current game info as a new frame
+ * @note The caller must hold the mutex or be the only thread touching the
+ * game, frames have a single writer
+ */
+void publishFrame();
+
+/**
+ * @brief Releases the field memory, legacy tables and frames kept between
+ * games
+ * @note Only for games that are being destroyed, after cleanUpData()
+ */
+void freeGameData();
+
 #endif
\ No newline at end of file
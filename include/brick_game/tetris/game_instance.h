@@ -0,0 +1,165 @@
+/**
+ * @file game_instance.h
+ * @brief Per-game storage behind the handle-based backend API
+ * @details
+ * - Groups every piece of state a tetris game needs into one BrickGame_t, so a
+ *   process can host any number of independent games
+ * - Modules reach their state through getCurrentGame() instead of file-level
+ *   statics; the current game is thread-local
+ * - Game threads bind their own instance, bg_* entry points bind the handle
+ *   they were given for the duration of the call
+ * - Legacy userInput()/updateCurrentState() operate on the default game
+ */
+
+#ifndef GAME_INSTANCE_H
+#define GAME_INSTANCE_H
+
+#include <stdatomic.h>
+
+#include "animation.h"
+#include "bitboard.h"
+#include "controller.h"
+#include "frame_buffer.h"
+#include "game_data.h"
+#include "replay.h"
+#include "tetromino.h"
+
+#ifndef QUEUE_SIZE
+#define QUEUE_SIZE 8     ///< Capacity of the movement queue, a power of two
+#endif
+#define NO_MOVEMENT -1  ///< Marks an empty pending movement
+
+/**
+ * @struct GameRuntimeData_t
+ * @brief Game state, synchronization primitives and threads
+ */
+typedef struct {
+  PackedGameInfo_t info; ///< State the engine works on
+  GameState_t state;     ///< Current game state
+  mtx_t mutex;           ///< Guards info and the movement queue
+  cnd_t pause_cond;      ///< Signalled on unpause
+  mtx_t work_mutex;      ///< Guards the game loop sleep on work_cond
+  cnd_t work_cond;       ///< Signalled on new input and state changes
+  Threads_t threads;     ///< Game threads
+  uint32_t rng_state;    ///< Random generator state
+  bool rng_seeded;       ///< Whether rng_state has been seeded
+  int width;             ///< Configured field width, 0 for default
+  int length;            ///< Configured field length, 0 for default
+  bool headless;         ///< Skip animations
+  bool scheduled;        ///< Run on the shared scheduler
+  bool stepped;          ///< Advance only through bg_step()
+  Tetromino_t current;   ///< Piece in play
+  Animation_t animation; ///< Animation in progress
+} GameRuntimeData_t;
+
+/**
+ * @struct FieldStorage_t
+ * @brief Field memory, kept between games and reallocated on size change
+ */
+typedef struct {
+  FieldCell_t* cells;   ///< Row-major cell array
+  FieldCell_t** rows;   ///< Row pointers into cells
+  int width;            ///< Allocated width
+  int length;           ///< Allocated length
+} FieldStorage_t;
+
+/**
+ * @struct NextStorage_t
+ * @brief Next shape preview memory, the extra cell holds the shape number
+ */
+typedef struct {
+  FieldCell_t cells[NEXTF_LENGTH * NEXTF_WIDTH + 1];  ///< Preview cells
+  FieldCell_t* rows[NEXTF_LENGTH];  ///< Row pointers into cells
+} NextStorage_t;
+
+/**
+ * @struct LegacyView_t
+ * @brief int tables handed out by updateCurrentState(), built on demand
+ */
+typedef struct {
+  GameInfo_t info;                          ///< Last state handed out
+  uint64_t generation;                      ///< Frame the tables were built from
+  int* cells;                               ///< Field copy as int
+  int** rows;                               ///< Row pointers into cells
+  int width;                                ///< Allocated width
+  int length;                               ///< Allocated length
+  int next_cells[NEXTF_LENGTH * NEXTF_WIDTH];  ///< Next shape copy as int
+  int* next_rows[NEXTF_LENGTH];             ///< Row pointers into next_cells
+} LegacyView_t;
+
+/**
+ * @struct QueueSlot_t
+ * @brief One cell of the movement ring
+ * @details sequence equals the producer position that may fill the slot,
+ * that position + 1 once the command is readable, and the position of the
+ * next lap once the consumer took it.
+ */
+typedef struct {
+  atomic_size_t sequence;  ///< Turn of the slot
+  MoveCommand_t command;   ///< Queued command
+} QueueSlot_t;
+
+/**
+ * @struct MovementQueue_t
+ * @brief Lock-free ring of pending movement commands, many producers and the
+ * game loop as the only consumer
+ */
+typedef struct {
+  QueueSlot_t slots[QUEUE_SIZE];  ///< Ring cells
+  atomic_size_t tail;             ///< Next producer position
+  size_t head;                    ///< Next consumer position
+  atomic_uint held;               ///< Bit per move with a held command queued
+  atomic_bool waiting;            ///< Game loop sleeps on the work condition
+} MovementQueue_t;
+
+/**
+ * @struct Actions_t
+ * @brief Input interpreted by the controller and waiting for execution
+ */
+typedef struct {
+  MoveCommand_t movement;  ///< Pending movement, NO_MOVEMENT if none
+  Command_t command;       ///< Pending game command, NULL if none
+} Actions_t;
+
+/**
+ * @brief Everything one tetris game owns
+ */
+struct BrickGame {
+  GameRuntimeData_t data;  ///< Runtime state
+  FieldStorage_t field;    ///< Field memory
+  NextStorage_t next;      ///< Next shape memory
+  MovementQueue_t queue;   ///< Pending movements
+  Actions_t actions;       ///< Pending controller actions
+  LegacyView_t legacy;     ///< int view for the legacy API
+  Bitboard_t bitboard;     ///< Settled cells, bitboard engine only
+  _Atomic(FrameBuffer_t*) frames;  ///< Published frames, created on demand
+  atomic_uint_fast64_t ticks;      ///< Gravity ticks run, the replay clock
+  ReplayWriter_t* recorder;        ///< Input log, NULL when not recording
+};
+
+/**
+ * @brief Gets the game used by the legacy single-game API
+ * @return Pointer to the process-wide default game
+ */
+BrickGame_t* getDefaultGame();
+
+/**
+ * @brief Gets the game bound to the calling thread
+ * @return Bound game, or the default game if none is bound
+ */
+BrickGame_t* getCurrentGame();
+
+/**
+ * @brief Binds a game to the calling thread
+ * @param game Game to bind, NULL to fall back to the default game
+ * @return Previously bound game, to be restored by the caller
+ */
+BrickGame_t* bindGame(BrickGame_t* game);
+
+/**
+ * @brief Prepares freshly allocated zeroed game memory for use
+ * @param game Game to initialize
+ */
+void initGameInstance(BrickGame_t* game);
+
+#endif
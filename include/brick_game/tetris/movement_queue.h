@@ -1,11 +1,14 @@
 /**
  * @file movement_queue.h
- * @brief Circular queue for storing tetromino movement commands.
+ * @brief Lock-free queue for storing tetromino movement commands.
  * @details
- * - Implements a FIFO queue with a fixed size (`QUEUE_SIZE = 5`).
- * - Automatically overwrites the oldest command when full (circular buffer
- * behavior).
- * - Designed for single-threaded use (no built-in locking).
+ * - Bounded multi-producer single-consumer ring of `QUEUE_SIZE` commands
+ *   (a power of two, 8 unless defined at build time).
+ * - Producers (the UI thread and the auto-shift scheduler) never take the
+ *   game mutex; the game loop is the only consumer.
+ * - A full queue drops the new command and keeps the pending ones in order.
+ * - Auto-repeat of a held key is coalesced: a held command is dropped while
+ *   the same held move is still pending.
  */
 
 #ifndef MV_QUEUE_H
@@ -14,37 +17,50 @@
 #include "backend.h"
 #include "tetromino.h"
 
+/**
+ * @enum QueueResult_t
+ * @brief What pushQueue() did with a command
+ */
+typedef enum {
+  QueuePushed,     ///< Queued for the game loop
+  QueueCoalesced,  ///< Same held move already pending, dropped
+  QueueDropped     ///< Queue full, dropped
+} QueueResult_t;
+
 /**
  * @brief Initializes or resets the movement queue.
- * @note Also used by `flushQueue` macro to clear the queue.
+ * @warning Not safe while producers are running; use `flushQueue` then.
  */
 void initQueue();
 
 /**
  * @brief Removes and returns the oldest command from the queue.
- * @return MoveCommand_t The dequeued movement command.
- * @warning Undefined behavior if the queue is empty (check with
- * `isEmptyQueue()`).
+ * @return MoveCommand_t The dequeued movement command, a zeroed command if
+ * the queue is empty.
+ * @note Consumer side: only the game loop pops.
  */
 MoveCommand_t popQueue();
 
 /**
  * @brief Adds a new movement command to the queue.
  * @param action The command to enqueue (of type `MoveCommand_t`).
- * @note Overwrites the oldest command if the queue is full.
+ * @return Whether the command was queued, coalesced or dropped.
+ * @note Lock-free and safe from any thread; wakes the main game loop if it
+ * sleeps.
  */
-void pushQueue(const MoveCommand_t action);
+QueueResult_t pushQueue(const MoveCommand_t action);
 
 /**
  * @brief Checks if the queue is empty.
  * @return `true` if empty, `false` otherwise.
+ * @note Consumer side: exact for the game loop, a hint for anyone else.
  */
 bool isEmptyQueue();
 
 /**
- * @macro flushQueue
- * @brief Clears all commands in the queue (alias for `initQueue`).
+ * @brief Drops every pending command.
+ * @note Consumer side, safe while producers are running.
  */
-#define flushQueue initQueue
+void flushQueue();
 
-#endif
\ No newline at end of file
+#endif
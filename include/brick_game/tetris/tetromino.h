@@ -58,11 +58,32 @@ typedef enum {
   CellStateCount  ///< Total count of cell states
 } FieldCellState_t;
 
+/**
+ * @typedef FieldCell_t
+ * @brief One field cell packed into a byte, holds a FieldCellState_t
+ */
+typedef uint8_t FieldCell_t;
+
+/**
+ * @struct PackedGameInfo_t
+ * @brief GameInfo_t with byte cells, the representation the engine works on
+ * @note The int tables of GameInfo_t are only built for the legacy API
+ */
+typedef struct {
+  FieldCell_t** field;  ///< Row pointers into the packed field
+  FieldCell_t** next;   ///< Row pointers into the packed next shape
+  int score;            ///< Current score
+  int high_score;       ///< Best score so far
+  int level;            ///< Current level
+  int speed;            ///< Current speed
+  int pause;            ///< Whether the game is paused
+} PackedGameInfo_t;
+
 /**
  * @typedef Movement_t
  * @brief Function pointer for tetromino movement operations
  */
-typedef int (*Movement_t)(GameInfo_t*, Tetromino_t*);
+typedef int (*Movement_t)(PackedGameInfo_t*, Tetromino_t*);
 
 /**
  * @brief Gets movement function for a command
@@ -76,33 +97,33 @@ Movement_t getMovement(const MoveCommand_t cmd);
  * @param next Pointer to next shape buffer
  * @return New tetromino with default position
  */
-Tetromino_t getNextTetromino(int** next);
+Tetromino_t getNextTetromino(FieldCell_t** next);
 
 /**
  * @brief Generates a new random shape in next buffer
  * @param next Pointer to next shape buffer
  */
-void setRandomShape(int** next);
+void setRandomShape(FieldCell_t** next);
 
 /**
  * @brief Removes tetromino from field (sets to Empty)
  * @param current Tetromino to remove
  * @param field Game field to modify
  */
-void removeTetromino(const Tetromino_t* current, int** field);
+void removeTetromino(const Tetromino_t* current, FieldCell_t** field);
 
 /**
  * @brief Locks tetromino in place (sets to Settled)
  * @param current Tetromino to settle
  * @param field Game field to modify
  */
-void settleTetromino(const Tetromino_t* current, int** field);
+void settleTetromino(const Tetromino_t* current, FieldCell_t** field);
 
 /**
  * @brief Places tetromino on field (sets to Volatile)
  * @param new Tetromino to place
  * @param field Game field to modify
  */
-void putTetromino(const Tetromino_t* new, int** field);
+void putTetromino(const Tetromino_t* new, FieldCell_t** field);
 
 #endif
\ No newline at end of file
@@ -1,40 +1,58 @@
 #ifndef TETR_INNER_H
 #define TETR_INNER_H
 
+#include "game_data.h"
 #include "movement_queue.h"
 #include "tetromino_mover.h"
 
 #define FIELD_STATES 3
 #define TOTAL_PIECES 4
 #define TOTAL_TETROMINOS 7
+#define TOTAL_ROTATIONS 4
+#define TOTAL_KICKS 3
 #define SHAPE_NUMBER(X) ((X) - FIELD_STATES)
-#define START_X (FIELD_WIDTH / 2)
+#define START_X (getFieldWidth() / 2)
 #define START_Y -1
 #define NEXT_SHAPE_NUM(next) *(next[0] + NEXTF_LENGTH * NEXTF_WIDTH)
 
-#define RANDOM_SHAPE (rand() % (CellStateCount - FIELD_STATES)) + FIELD_STATES
-#define I_SHAPE {{0, -1}, {0, 0}, {0, 1}, {0, 2}}
-#define O_SHAPE {{0, 0}, {0, 1}, {1, 0}, {1, 1}}
-#define T_SHAPE {{-1, 0}, {0, 0}, {1, 0}, {0, 1}}
-#define S_SHAPE {{-1, 1}, {0, 1}, {0, 0}, {1, 0}}
-#define Z_SHAPE {{-1, 0}, {0, 0}, {0, 1}, {1, 1}}
-#define J_SHAPE {{-1, -1}, {-1, 0}, {0, 0}, {1, 0}}
-#define L_SHAPE {{-1, 1}, {-1, 0}, {0, 0}, {1, 0}}
+#define RANDOM_SHAPE \
+  (nextRandom() % (CellStateCount - FIELD_STATES)) + FIELD_STATES
+// Pieces of each shape as (y, x) offsets from the center, passed through F
+#define I_SHAPE(F) F(0, -1), F(0, 0), F(0, 1), F(0, 2)
+#define O_SHAPE(F) F(0, 0), F(0, 1), F(1, 0), F(1, 1)
+#define T_SHAPE(F) F(-1, 0), F(0, 0), F(1, 0), F(0, 1)
+#define S_SHAPE(F) F(-1, 1), F(0, 1), F(0, 0), F(1, 0)
+#define Z_SHAPE(F) F(-1, 0), F(0, 0), F(0, 1), F(1, 1)
+#define J_SHAPE(F) F(-1, -1), F(-1, 0), F(0, 0), F(1, 0)
+#define L_SHAPE(F) F(-1, 1), F(-1, 0), F(0, 0), F(1, 0)
+
+// Same formulas as applyRotation(), evaluated by the compiler
+#define ROTATE_0(row, col) {.x = (col), .y = (row)}
+#define ROTATE_90(row, col) {.x = -(row), .y = (col)}
+#define ROTATE_180(row, col) {.x = -(col), .y = -(row)}
+#define ROTATE_270(row, col) {.x = (row), .y = -(col)}
+#define ALL_ROTATIONS(SHAPE)                                      \
+  {{SHAPE(ROTATE_0)}, {SHAPE(ROTATE_90)}, {SHAPE(ROTATE_180)}, \
+   {SHAPE(ROTATE_270)}}
+#define NO_ROTATIONS(SHAPE) \
+  {{SHAPE(ROTATE_0)}, {SHAPE(ROTATE_0)}, {SHAPE(ROTATE_0)}, {SHAPE(ROTATE_0)}}
 
 typedef enum { Angle0, Angle90, Angle180, Angle270 } Angle_t;
 
-bool canMove(const Tetromino_t*, int** field);
-bool canRotate(Tetromino_t*, int** field);
+bool canMove(const Tetromino_t*, FieldCell_t** field);
+bool canRotate(Tetromino_t*, FieldCell_t** field);
+const Coordinates_t* getPieceOffsets(const Tetromino_t* tetromino);
+const int* getWallKicks(const Tetromino_t* tetromino);
 Coordinates_t applyRotation(const Tetromino_t* tetromino,
                             Coordinates_t piece_coords);
 Coordinates_t getTetrPieceCoords(const Tetromino_t* tetromino,
                                  const int pieceNumber);
-void setFieldCellState(int** field, const FieldCellState_t state,
+void setFieldCellState(FieldCell_t** field, const FieldCellState_t state,
                        const Tetromino_t* tetromino);
-int moveDown(GameInfo_t* info, Tetromino_t* current);
-int moveLeft(GameInfo_t* info, Tetromino_t* current);
-int moveRight(GameInfo_t* info, Tetromino_t* current);
-int smashDown(GameInfo_t* info, Tetromino_t* current);
-int rotate(GameInfo_t* info, Tetromino_t* current);
+int moveDown(PackedGameInfo_t* info, Tetromino_t* current);
+int moveLeft(PackedGameInfo_t* info, Tetromino_t* current);
+int moveRight(PackedGameInfo_t* info, Tetromino_t* current);
+int smashDown(PackedGameInfo_t* info, Tetromino_t* current);
+int rotate(PackedGameInfo_t* info, Tetromino_t* current);
 
 #endif
\ No newline at end of file
@@ -23,30 +23,15 @@
 #include "backend.h"  // Provides GameInfo_t and user input interface for game state management
 #include "tetromino.h"  // Defines tetromino structures and operations used in movement logic
 
-/**
- * @def MAIN_SLEEP_TIME
- * @brief Duration in nanoseconds to pause between iterations of the main game
- * loop
- * @details Set to 5,000,000 nanoseconds (5 milliseconds), this constant
- * controls the polling frequency of the main game loop. It determines how often
- * the game checks for user input, updates the tetromino position, and processes
- * game logic. A shorter duration increases responsiveness but may tax system
- * resources, while a longer duration conserves resources at the cost of
- * perceived lag. This value strikes a balance for smooth gameplay in a typical
- * Tetris implementation.
- */
-#define MAIN_SLEEP_TIME (5000000)
-
 /**
  * @def ANIMATION_SLEEP_TIME
- * @brief Duration in nanoseconds for the row destruction animation delay
+ * @brief Duration in nanoseconds of one animation step
  * @details Defined as 20,000,000 nanoseconds (20 milliseconds), this constant
- * sets the pause duration during the visual feedback of clearing filled rows.
- * It’s used to create a brief delay that enhances the player experience by
- * making line clears more noticeable before the field updates. The value is
- * multiplied in the implementation to extend the total animation time (e.g., 8
- * times this value for a full sequence), ensuring the effect is visible without
- * overly slowing gameplay.
+ * sets the pace of the hard drop and line clear animations. A hard drop moves
+ * the piece one row per step and rests DROP_LANDING_STEPS steps once landed;
+ * filled rows flash for CLEAR_STEPS steps (160 ms) before they are removed.
+ * The game loop waits for the next step without holding the game mutex, so
+ * rendering and input are never stalled by an animation.
  */
 #define ANIMATION_SLEEP_TIME (20000000)
 
@@ -96,10 +81,9 @@
  * @details Uses the C11 thrd_sleep() function with a timespec structure to
  * pause the calling thread for the given duration. The macro simplifies timing
  * control throughout the mover system, abstracting the struct initialization
- * (only nanoseconds are set, seconds remain 0). It’s used with MAIN_SLEEP_TIME,
- * ANIMATION_SLEEP_TIME, and GET_SLEEP_DURATION to regulate game pacing and
- * animations. Note that actual sleep time may vary slightly due to system
- * scheduling.
+ * (only nanoseconds are set, seconds remain 0). It’s used with
+ * GET_SLEEP_DURATION to pace the auto-shift scheduler. Note that actual sleep
+ * time may vary slightly due to system scheduling.
  */
 #define SLEEP(x) thrd_sleep(&(struct timespec){.tv_nsec = (x)}, NULL)
 
@@ -110,8 +94,8 @@
  * successfully, EXIT_FAILURE if either thread creation fails
  * @details Sets up the multi-threaded movement system by creating two threads:
  * one for the main game loop (mainGameLoop) and one for the auto-shift
- * scheduler (autoShiftScheduler). Both threads operate on the shared GameInfo_t
- * structure from backend.h to manage game state. This function is typically
+ * scheduler (autoShiftScheduler). Both threads are bound to the calling
+ * thread's current game and operate on its GameInfo_t to manage game state. This function is typically
  * called after game data initialization to start the core gameplay mechanics.
  * If either thread fails to start, it returns an error to allow the caller to
  * handle the failure (e.g., by cleaning up resources).
@@ -120,14 +104,17 @@ int initTetrominoMover();
 
 /**
  * @brief Executes the primary game loop in a dedicated thread
- * @param arg Pointer to the GameInfo_t structure containing the current game
- * state
+ * @param arg Pointer to the BrickGame_t the thread plays, bound to the thread
+ * on start
  * @return EXIT_SUCCESS upon normal completion (e.g., when the game ends)
  * @details Runs as the main thread’s entry point, continuously processing game
  * logic such as tetromino movement, row clearing, and state updates. It loops
- * while the game is in RunState or PauseState, sleeping between iterations (via
- * MAIN_SLEEP_TIME) to control frame rate. The arg parameter provides access to
- * shared game data, which it modifies in a thread-safe manner using mutexes.
+ * while the game is in RunState or PauseState, sleeping on the work condition
+ * until pushQueue() queues a command (user input or the auto-shift tick), rows
+ * marked as filled wait to be destroyed, the next animation step is due, or
+ * the game ends, so an idle game costs no wakeups and input is handled as soon
+ * as it arrives. The arg parameter provides access to shared game data, which
+ * it modifies in a thread-safe manner using mutexes.
  * This function drives the core gameplay experience, responding to user inputs
  * and updating the field.
  */
@@ -135,8 +122,8 @@ int mainGameLoop(void* arg);
 
 /**
  * @brief Manages automatic downward movement of tetrominos in a separate thread
- * @param arg Pointer to the GameInfo_t structure containing the current game
- * state
+ * @param arg Pointer to the BrickGame_t the thread plays, bound to the thread
+ * on start
  * @return EXIT_SUCCESS upon normal completion (e.g., when the game ends)
  * @details Operates as the scheduler thread, periodically queuing downward
  * movement commands for the current tetromino based on the game’s speed (via
@@ -161,4 +148,21 @@ int autoShiftScheduler(void* arg);
  */
 void waitTetrominoMoverEnd();
 
+/**
+ * @brief Runs the game logic of a stepped game until it has nothing to do
+ * @details Stepped games have no game loop; this is the loop body run inline
+ * after input was queued: it moves the tetromino by every queued command and
+ * destroys filled rows, then publishes a frame if anything changed.
+ */
+void drainGameLogic();
+
+/**
+ * @brief Advances a stepped game by a number of auto-shift periods
+ * @param ticks Periods to play, each one moves the tetromino down one row
+ * @details What autoShiftScheduler() would do in ticks periods, without
+ * sleeping: every tick queues a downward move and drains the game logic.
+ * Stops early when the game leaves RunState.
+ */
+void stepGameLogic(const int ticks);
+
 #endif
\ No newline at end of file
@@ -12,11 +12,12 @@
 #define MAX_SPEED 10
 #define LEVEL_THRESHOLD 600
 
-void tickGameLogic(GameInfo_t* info, Tetromino_t* tetromino);
-void moveTetromino(GameInfo_t* info, Tetromino_t* tetromino);
-void markFilledRows(int** field);
-void markRow(int** field, int row);
-int destroyMarkedRows(GameInfo_t* info, const Tetromino_t* current);
-void destroyRows(int** field, const int row, const int combo);
-void endGame(GameInfo_t* info);
+bool tickGameLogic(PackedGameInfo_t* info, Tetromino_t* tetromino);
+bool stepAnimation(PackedGameInfo_t* info, Tetromino_t* tetromino);
+void moveTetromino(PackedGameInfo_t* info, Tetromino_t* tetromino);
+void markFilledRows(FieldCell_t** field);
+void markRow(FieldCell_t** field, int row);
+int destroyMarkedRows(PackedGameInfo_t* info, const Tetromino_t* current);
+void destroyRows(FieldCell_t** field, const int row, const int combo);
+void endGame(PackedGameInfo_t* info);
 #endif
\ No newline at end of file
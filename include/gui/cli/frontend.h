@@ -23,10 +23,14 @@
  * @name Window Dimension Constants
  * @{
  */
+#define FIELD_WIN_HEIGHT_OF(length) \
+  ((length) + 2)  ///< Field window height (rows) for a board length
+#define FIELD_WIN_WIDTH_OF(width) \
+  ((width) * 2 + 2)  ///< Field window width (columns) for a board width
 #define FIELD_WIN_HEIGHT \
-  (FIELD_LENGTH + 2)  ///< Game field window height (rows)
+  FIELD_WIN_HEIGHT_OF(FIELD_LENGTH)  ///< Game field window height (rows)
 #define FIELD_WIN_WIDTH \
-  (FIELD_WIDTH * 2 + 2)         ///< Game field window width (columns)
+  FIELD_WIN_WIDTH_OF(FIELD_WIDTH)  ///< Game field window width (columns)
 #define STATS_WIN_WIDTH (12)    ///< Stats window width
 #define CONTEXT_WIN_HEIGHT (5)  ///< Context window height
 #define SCREEN_WIDTH \
@@ -47,6 +51,42 @@ typedef enum {
   GameScreen       ///< Active gameplay screen
 } GameScreen_t;
 
+/**
+ * @brief Cells currently drawn in the field window
+ */
+typedef struct {
+  uint8_t* cells;       ///< Drawn cell values, NULL before the first frame
+  int width;            ///< Board size the cells were drawn for
+  int length;           ///< Board length the cells were drawn for
+  uint64_t generation;  ///< Frame shown, 0 when the field needs a full redraw
+} FieldCache_t;
+
+/**
+ * @brief How the field window draws one cell value
+ */
+typedef struct {
+  short pair;     ///< Colour pair, 0 for the terminal colours
+  char glyph[3];  ///< The two characters of the cell
+} CellStyle_t;
+
+/**
+ * @brief Values currently drawn in the stats and context windows
+ */
+typedef struct {
+  bool valid;  ///< False when the panels need a full redraw
+  int next[NEXTF_LENGTH][NEXTF_WIDTH];  ///< Next shape shown
+  int stats[4];       ///< High score, score, level and speed shown
+  int condition;      ///< Pause or game over line shown
+  int points_shown;   ///< Points message shown, 0 when there is none
+  bool level_shown;   ///< Whether the new level message is shown
+  bool tracking;      ///< Whether the fields below follow the game
+  int prev_score;     ///< Score when the points message was last armed
+  int prev_level;     ///< Level the new level message compares against
+  int points_earned;  ///< Points of the running message
+  bool level_up;      ///< Whether the running message reports a new level
+  long long progress_until;  ///< Milliseconds the running message lasts to
+} PanelCache_t;
+
 /**
  * @brief Structure holding NCurses window handles
  */
@@ -54,6 +94,11 @@ typedef struct {
   WINDOW* field_win;    ///< Window for main game field
   WINDOW* stats_win;    ///< Window for statistics and next piece
   WINDOW* context_win;  ///< Window for contextual information
+  int field_width;      ///< Board width the windows are laid out for
+  int field_length;     ///< Board length the windows are laid out for
+  FieldCache_t drawn;   ///< What field_win shows
+  PanelCache_t panels;  ///< What stats_win and context_win show
+  CellStyle_t styles[PALETTE_SIZE];  ///< Looks of every cell value
 } GameWindows_t;
 
 /**
@@ -85,13 +130,50 @@ typedef void (*inputFunc_t)(const UserAction_t action, bool hold);
  */
 typedef GameInfo_t (*updateFunc_t)(void);
 
+/**
+ * @brief Function pointer type for querying the board size
+ */
+typedef void (*sizeFunc_t)(int* width, int* length);
+
+/**
+ * @brief Function pointer type for getting the game behind the legacy calls
+ */
+typedef BrickGame_t* (*gameFunc_t)(void);
+
+/**
+ * @brief Function pointer type for getting the palette of a game
+ */
+typedef const BrickPalette_t* (*paletteFunc_t)(void);
+
+/**
+ * @brief Function pointer type for taking the newest frame of a game
+ */
+typedef const BrickFrame_t* (*frameFunc_t)(BrickGame_t* game);
+
+/**
+ * @brief Function pointer type for waiting on the next frame of a game
+ */
+typedef uint64_t (*waitFunc_t)(BrickGame_t* game, uint64_t seen,
+                               int timeout_ms);
+
+/**
+ * @brief Function pointer type for logging a game's input to a file
+ */
+typedef int (*recordFunc_t)(BrickGame_t* game, const char* path);
+
 /**
  * @brief Game interface structure
  */
 typedef struct {
   inputFunc_t userInput;            ///< Function to handle user input
   updateFunc_t updateCurrentState;  ///< Function to update game state
-  void* handle;                     ///< Handle to loaded game library
+  sizeFunc_t getFieldSize;  ///< Board size query, NULL if not exported
+  frameFunc_t getFrame;     ///< Frame query, NULL if not exported
+  waitFunc_t waitFrame;     ///< Frame wait, NULL if not exported
+  recordFunc_t record;      ///< Input log, NULL if not exported
+  BrickGame_t* game;        ///< Game driven by userInput(), for getFrame
+  const BrickPalette_t* palette;  ///< Cell looks, never NULL once loaded
+  void* handle;             ///< Handle to loaded game library
 } Interface_t;
 
 /**
@@ -124,6 +206,26 @@ typedef struct {
  */
 int initDisplay(GameData_t* controls);
 
+/**
+ * @brief Resizes and moves the game windows to fit a board
+ * @param windows Windows to lay out
+ * @param width Board width in cells
+ * @param length Board length in cells
+ * @return OK on success, error code otherwise
+ *
+ * @note Boards larger than the terminal are clipped to it
+ */
+int layoutWindows(GameWindows_t* windows, int width, int length);
+
+/**
+ * @brief Sets up colour pairs and cell styles for the values of a palette
+ * @param windows Windows whose cell styles are replaced
+ * @param palette Palette of the game about to be drawn
+ *
+ * @note Values the palette leaves zeroed are drawn as blanks
+ */
+void applyPalette(GameWindows_t* windows, const BrickPalette_t* palette);
+
 /**
  * @brief Handles fatal errors
  * @param ctrls Pointer to controls structure
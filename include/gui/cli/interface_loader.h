@@ -39,8 +39,8 @@ int loadGameInterface(const char *game_name, Interface_t *interface);
  * @param interface Pointer to the `Interface_t` struct to clean up.
  *
  * @note Safe to call even if `interface` is partially loaded or NULL.
- * @post `interface->handle`, `interface->userInput`, and
- * `interface->updateCurrentState` are set to NULL.
+ * @post `interface->handle`, `interface->userInput`,
+ * `interface->updateCurrentState` and the optional functions are set to NULL.
  */
 void unloadGameInterface(Interface_t *interface);
 
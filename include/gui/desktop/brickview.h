@@ -1,30 +1,57 @@
 #ifndef BRICKVIEW_H
 #define BRICKVIEW_H
 
-#include <QGraphicsScene>
-#include <QGraphicsView>
+#include <QBrush>
+#include <QFrame>
+#include <QPixmap>
+#include <array>
+#include <cstdint>
+#include <vector>
 
-class BrickView : public QGraphicsView {
+#include "backend.h"
+
+// Paints the board straight from an array of cell values, without a scene.
+// Changed cells are drawn once into a cached pixmap and paintEvent only
+// copies the exposed part of it to the screen
+class BrickView : public QFrame {
   Q_OBJECT
 
  public:
   explicit BrickView(QWidget* parent = nullptr);
   void InitField(int width, int height);
+  // Brushes of every cell value, built here once instead of per cell
+  void SetPalette(const BrickPalette_t* palette);
   void UpdateField(int** data);
+  // Row-major cells of a width x height board. With a dirty list only the
+  // listed cells are looked at, without one every cell is
+  void UpdateCells(const std::uint8_t* data, int width, int height,
+                   const std::int32_t* dirty = nullptr, int dirty_count = -1);
+
+ protected:
+  void paintEvent(QPaintEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
 
  private:
-  QGraphicsScene* scene_;
-  int cell_size_;
-  int grid_width_;
-  int grid_height_;
-  struct Cell {
-    QGraphicsRectItem* item;
-    int cashed_value;
+  // A cell is filled with its colour inside an edge of a darker one
+  struct CellStyle {
+    QBrush fill;
+    QBrush edge;
+    int edge_width;
   };
 
-  QVector<QVector<Cell>> cells_;
-  void AssignColor(Cell& c, QColor);
-  void DismissColor(Cell& c);
+  std::array<CellStyle, PALETTE_SIZE> styles_;
+  int cell_size_{};
+  int grid_width_{};
+  int grid_height_{};
+  QPoint origin_;                    // top left corner of the board
+  std::vector<std::uint8_t> cells_;  // values painted on pixmap_
+  QPixmap pixmap_;
+  QRect changed_;  // part of pixmap_ painted since the last update()
+
+  void Relayout();
+  void SetCell(QPainter& painter, int n, int color);
+  void PaintCell(QPainter& painter, int n);
+  void ScheduleUpdate();
 };
 
 #endif  // BRICKVIEW_H
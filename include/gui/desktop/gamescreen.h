@@ -14,11 +14,21 @@ class GameScreen;
 
 using inputFunc_t = void (*)(UserAction_t, bool);
 using updateFunc_t = GameInfo_t (*)();
+using sizeFunc_t = void (*)(int*, int*);
+using gameFunc_t = BrickGame_t* (*)();
+using frameFunc_t = const BrickFrame_t* (*)(BrickGame_t*);
+using generationFunc_t = uint64_t (*)(BrickGame_t*);
+using paletteFunc_t = const BrickPalette_t* (*)();
 
 struct Interface_t {
   QLibrary* handle{};
   inputFunc_t userInput{};
   updateFunc_t updateCurrentState{};
+  sizeFunc_t getFieldSize{};  // optional, classic size if not exported
+  frameFunc_t getFrame{};     // optional, drawn from GameInfo_t if not exported
+  generationFunc_t getGeneration{};  // optional, frames are taken every tick
+  BrickGame_t* game{};        // game behind userInput(), for getFrame
+  const BrickPalette_t* palette{};  // cell looks, never null once loaded
 };
 
 class GameScreen : public QFrame {
@@ -46,7 +56,14 @@ class GameScreen : public QFrame {
   Ui::GameScreen* ui;
   Interface_t interface_;
   QTimer* refresh_timer_;
+  uint64_t shown_generation_{};  // frame on the views, 0 before the first
+  GameInfo_t shown_stats_{};     // values on the numbers and the status label
+  bool stats_shown_{};           // false until shown_stats_ is on screen
+  bool idle_{};                  // shown game is paused or over
   void UnloadGameInterface();
+  void InitViews();
+  void ShowFrame(const BrickFrame_t* frame);
+  void ShowStats(const GameInfo_t& game_info);
 };
 
 #endif  // GAMESCREEN_H
@@ -0,0 +1,34 @@
+#ifndef GAME_LIBRARY_H
+#define GAME_LIBRARY_H
+
+#include <string>
+
+#include "backend.h"
+
+namespace brick_game {
+
+// Handle API of one game library, loaded at run time like the CLI loads its
+// games. The snake and tetris libraries export the same bg_* names, so they
+// are never linked into one executable
+struct GameLibrary {
+  // Throws std::runtime_error if the library or one of its calls is missing
+  explicit GameLibrary(const std::string& path);
+  GameLibrary(const GameLibrary&) = delete;
+  GameLibrary& operator=(const GameLibrary&) = delete;
+  ~GameLibrary();
+
+  decltype(&bg_create) create{};
+  decltype(&bg_destroy) destroy{};
+  decltype(&bg_input) input{};
+  decltype(&bg_frame) frame{};
+  decltype(&bg_step) step{};
+
+ private:
+  void* handle_{};
+};
+
+// lib<game>.so next to the executable, in ../lib like the install layout
+std::string DefaultLibraryPath(const std::string& game);
+
+};  // namespace brick_game
+#endif
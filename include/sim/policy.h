@@ -0,0 +1,47 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "game_library.h"
+
+namespace brick_game {
+
+enum class SimGame { Snake, Tetris };
+
+// One input of a scripted turn
+using ScriptedInput = std::pair<UserAction_t, bool>;
+// Inputs sent before each tick; empty turns only tick
+using Script = std::vector<std::vector<ScriptedInput>>;
+
+// Reads a script: one turn per line of whitespace separated inputs, left,
+// right, up, down, action and drop (a held down), '#' starts a comment.
+// Throws std::invalid_argument on unknown words
+Script ParseScript(std::istream& in);
+
+// Decides the inputs of one game. Play() runs before every tick of a stepped
+// game and may send any number of inputs, each applied at once
+struct Policy {
+  virtual ~Policy() = default;
+  virtual void Play(const GameLibrary& lib, BrickGame_t* game) = 0;
+};
+
+enum class PolicyKind { Random, Scripted, Greedy };
+
+struct PolicySpec {
+  PolicyKind kind = PolicyKind::Random;
+  std::shared_ptr<const Script> script;  // shared by all games
+};
+
+// Fresh policy for one game; random choices are drawn from the game's seed so
+// a run only depends on its seeds
+std::unique_ptr<Policy> MakePolicy(const PolicySpec& spec, SimGame game,
+                                   std::uint32_t seed);
+
+};  // namespace brick_game
+#endif
@@ -0,0 +1,25 @@
+#ifndef REPLAY_PLAYER_H
+#define REPLAY_PLAYER_H
+
+#include <cstdint>
+#include <string>
+
+#include "game_library.h"
+
+namespace brick_game {
+
+// Outcome of playing a recorded session again
+struct ReplayResult {
+  std::uint64_t inputs{};  // inputs fed to the game
+  std::uint64_t ticks{};   // timer periods the log covers
+  int score{};
+  bool finished{};  // the game was over at the end of the log
+};
+
+// Feeds a log written through bg_record() to a stepped game of the same seed
+// and size, stepping it straight to each input's tick. Throws
+// std::runtime_error if the log cannot be read or the game cannot be created
+ReplayResult PlayReplay(const GameLibrary& lib, const std::string& path);
+
+};  // namespace brick_game
+#endif
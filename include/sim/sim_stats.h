@@ -0,0 +1,37 @@
+#ifndef SIM_STATS_H
+#define SIM_STATS_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace brick_game {
+
+// Outcome of one simulated game
+struct GameResult {
+  std::uint32_t seed{};
+  int score{};
+  std::uint64_t ticks{};  // length of the game in timer periods
+  bool finished{};        // false if it hit the tick limit first
+};
+
+// Aggregate over a batch of games
+struct SimSummary {
+  std::size_t games{};
+  std::size_t finished{};
+  double seconds{};
+  double mean_score{};
+  int min_score{};
+  int max_score{};
+  std::uint64_t total_ticks{};
+  // Game length percentiles: 10, 50, 90, 99 and the longest game
+  std::uint64_t length_percentiles[5]{};
+  // Games by length, bucket b holds lengths in [2^b, 2^(b+1)), 0 in bucket 0
+  std::vector<std::size_t> length_histogram;
+};
+
+SimSummary Summarize(std::vector<GameResult> results, double seconds);
+void PrintSummary(std::ostream& out, const SimSummary& summary);
+
+};  // namespace brick_game
+#endif
@@ -0,0 +1,86 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace brick_game {
+
+// Runs a batch of independent jobs on a fixed number of threads. Every worker
+// starts with an even share of the indices and takes them from the back of
+// its own deque; once it runs dry it steals from the front of the others, so
+// a worker stuck with long games is helped by those that drew short ones.
+// Jobs never wait for each other, a plain mutex per deque is enough.
+struct WorkStealingPool {
+  explicit WorkStealingPool(unsigned workers)
+      : workers_(workers ? workers : 1) {}
+
+  unsigned GetWorkers() const { return workers_; }
+  // Jobs taken from another worker's deque during the last Run()
+  std::uint64_t GetSteals() const { return steals_; }
+
+  // Calls job(worker, index) once for every index in [0, count) and returns
+  // after all of them finished
+  template <std::invocable<unsigned, std::size_t> Job>
+  void Run(std::size_t count, Job&& job) {
+    std::vector<std::unique_ptr<Queue>> queues;
+    for (unsigned w{}; w < workers_; ++w) {
+      queues.push_back(std::make_unique<Queue>());
+      for (std::size_t i = count * w / workers_;
+           i < count * (w + 1) / workers_; ++i)
+        queues.back()->jobs.push_back(i);
+    }
+    std::vector<std::uint64_t> steals(workers_);
+    {
+      std::vector<std::jthread> threads;
+      for (unsigned w{}; w < workers_; ++w) {
+        threads.emplace_back([&, w] {
+          while (auto index = Take(queues, w, steals[w])) job(w, *index);
+        });
+      }
+    }
+    steals_ = 0;
+    for (auto s : steals) steals_ += s;
+  }
+
+ private:
+  struct Queue {
+    std::mutex mtx;
+    std::deque<std::size_t> jobs;
+  };
+
+  unsigned workers_;
+  std::uint64_t steals_{};
+
+  std::optional<std::size_t> Take(std::vector<std::unique_ptr<Queue>>& queues,
+                                  unsigned self, std::uint64_t& steals) {
+    std::optional<std::size_t> index;
+    {
+      std::scoped_lock<std::mutex> lock(queues[self]->mtx);
+      if (!queues[self]->jobs.empty()) {
+        index = queues[self]->jobs.back();
+        queues[self]->jobs.pop_back();
+      }
+    }
+    for (unsigned n = 1; !index && n < workers_; ++n) {
+      Queue& victim = *queues[(self + n) % workers_];
+      std::scoped_lock<std::mutex> lock(victim.mtx);
+      if (!victim.jobs.empty()) {
+        index = victim.jobs.front();
+        victim.jobs.pop_front();
+        ++steals;
+      }
+    }
+    return index;
+  }
+};
+
+};  // namespace brick_game
+#endif
@@ -0,0 +1,377 @@
+// mmap() and friends are POSIX, the library is built as plain C11
+#define _POSIX_C_SOURCE 200809L
+
+#include "archive.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAGIC "BGAR"
+#define MAGIC_SIZE 4
+#define CELL_BITS 8     ///< A change holds cell << CELL_BITS | value
+#define RECORD_ALIGN 4  ///< Records start on multiples of this
+#define INITIAL_GAMES 16
+#define INITIAL_KEYFRAMES 64
+
+/**
+ * @brief Start of the file, rewritten with the index when it is closed
+ */
+typedef struct {
+  char magic[MAGIC_SIZE];
+  uint32_t version;
+  uint32_t interval;  ///< Ticks between keyframes
+  uint32_t games;     ///< Entries in the index
+  uint64_t index;     ///< Offset of the index
+} FileHeader_t;
+
+/**
+ * @brief Index entry of one game
+ */
+typedef struct {
+  uint64_t keyframes;  ///< Offset of the game's keyframe offsets
+  uint64_t ticks;      ///< Ticks stored
+  int32_t width;
+  int32_t length;
+} GameEntry_t;
+
+/**
+ * @brief GameInfo_t of one tick without the field, which follows it: every
+ * cell in a keyframe, changes cells in a delta
+ */
+typedef struct {
+  int32_t score;
+  int32_t high_score;
+  int32_t level;
+  int32_t speed;
+  int32_t pause;
+  uint32_t changes;  ///< Changed cells in a delta, cell count in a keyframe
+  uint8_t next[NEXTF_LENGTH][NEXTF_WIDTH];
+} Snapshot_t;
+
+struct ArchiveWriter {
+  FILE* file;
+  uint64_t offset;    ///< Bytes written so far
+  uint32_t interval;  ///< Ticks between keyframes
+  bool failed;        ///< A write went wrong, the archive is unusable
+  GameEntry_t* games;
+  int game_count;
+  int game_capacity;
+  bool open;           ///< The last game takes frames
+  uint8_t* cells;      ///< Field of the previous tick
+  uint32_t* changes;   ///< Changes of the tick being written
+  uint64_t* keyframes; ///< Keyframe offsets of the open game
+  uint64_t keyframe_capacity;
+};
+
+struct ArchiveReader {
+  const uint8_t* data;  ///< Mapped file
+  size_t size;
+  uint32_t interval;
+  uint32_t games;
+  uint64_t index;
+  BrickFrame_t frame;  ///< Last seek
+  uint8_t* cells;      ///< Field of frame
+  size_t cells_size;
+};
+
+static void put(ArchiveWriter_t* writer, const void* data, const size_t size) {
+  if (size && fwrite(data, 1, size, writer->file) != size)
+    writer->failed = true;
+  writer->offset += size;
+}
+
+static void padRecord(ArchiveWriter_t* writer) {
+  static const uint8_t zeros[RECORD_ALIGN] = {0};
+  put(writer, zeros, (RECORD_ALIGN - writer->offset % RECORD_ALIGN) %
+                         RECORD_ALIGN);
+}
+
+static bool growArray(void** array, uint64_t* capacity, const uint64_t needed,
+                      const size_t item, const uint64_t initial) {
+  bool grown = true;
+  if (needed > *capacity) {
+    const uint64_t doubled = *capacity ? *capacity * 2 : initial;
+    const uint64_t wanted = doubled > needed ? doubled : needed;
+    void* bigger = realloc(*array, wanted * item);
+    if (bigger) {
+      *array = bigger;
+      *capacity = wanted;
+    } else
+      grown = false;
+  }
+  return grown;
+}
+
+static void writeHeader(ArchiveWriter_t* writer, const uint64_t index) {
+  FileHeader_t header = {.version = ARCHIVE_VERSION,
+                         .interval = writer->interval,
+                         .games = (uint32_t)writer->game_count,
+                         .index = index};
+  memcpy(header.magic, MAGIC, MAGIC_SIZE);
+  put(writer, &header, sizeof(header));
+}
+
+ArchiveWriter_t* archiveCreate(const char* path, const int interval) {
+  ArchiveWriter_t* writer = interval >= 0 ? calloc(1, sizeof(*writer)) : NULL;
+  if (writer) {
+    writer->interval = interval ? interval : ARCHIVE_DEFAULT_INTERVAL;
+    writer->file = fopen(path, "wb");
+  }
+  if (writer && writer->file) {
+    // Placeholder until archiveFinish() knows where the index goes
+    writeHeader(writer, 0);
+    if (!writer->failed) return writer;
+  }
+  if (writer && writer->file) fclose(writer->file);
+  free(writer);
+  return NULL;
+}
+
+int archiveBeginGame(ArchiveWriter_t* writer, const int width,
+                     const int length) {
+  int exit_code = EXIT_FAILURE;
+  archiveEndGame(writer);
+  uint64_t capacity = (uint64_t)writer->game_capacity;
+  if (width >= 1 && width <= FIELD_MAX_SIZE && length >= 1 &&
+      length <= FIELD_MAX_SIZE &&
+      growArray((void**)&writer->games, &capacity,
+                (uint64_t)writer->game_count + 1, sizeof(GameEntry_t),
+                INITIAL_GAMES)) {
+    writer->game_capacity = (int)capacity;
+    const size_t cells = (size_t)width * length;
+    uint8_t* field = realloc(writer->cells, cells);
+    if (field) writer->cells = field;
+    uint32_t* changes = realloc(writer->changes, cells * sizeof(uint32_t));
+    if (changes) writer->changes = changes;
+    if (field && changes) {
+      writer->games[writer->game_count++] =
+          (GameEntry_t){.width = width, .length = length};
+      writer->open = true;
+      exit_code = EXIT_SUCCESS;
+    }
+  }
+  return exit_code;
+}
+
+// Lists the cells that differ from the previous tick and takes them over
+static uint32_t diffCells(ArchiveWriter_t* writer, const uint8_t* cells,
+                          const uint32_t count) {
+  uint32_t changes = 0;
+  for (uint32_t cell = 0; cell < count; cell++) {
+    if (cells[cell] != writer->cells[cell]) {
+      writer->changes[changes++] = cell << CELL_BITS | cells[cell];
+      writer->cells[cell] = cells[cell];
+    }
+  }
+  return changes;
+}
+
+int archiveAddFrame(ArchiveWriter_t* writer, const BrickFrame_t* frame) {
+  GameEntry_t* game =
+      writer->open ? &writer->games[writer->game_count - 1] : NULL;
+  if (!game || frame->width != game->width || frame->length != game->length)
+    return EXIT_FAILURE;
+  const uint32_t count = (uint32_t)game->width * (uint32_t)game->length;
+  const bool keyframe = game->ticks % writer->interval == 0;
+  Snapshot_t snapshot = {.score = frame->score,
+                         .high_score = frame->high_score,
+                         .level = frame->level,
+                         .speed = frame->speed,
+                         .pause = frame->pause};
+  memcpy(snapshot.next, frame->next, sizeof(snapshot.next));
+  if (keyframe) {
+    const uint64_t index = game->ticks / writer->interval;
+    if (!growArray((void**)&writer->keyframes, &writer->keyframe_capacity,
+                   index + 1, sizeof(uint64_t), INITIAL_KEYFRAMES))
+      return EXIT_FAILURE;
+    writer->keyframes[index] = writer->offset;
+    memcpy(writer->cells, frame->cells, count);
+    snapshot.changes = count;
+    put(writer, &snapshot, sizeof(snapshot));
+    put(writer, frame->cells, count);
+    padRecord(writer);
+  } else {
+    snapshot.changes = diffCells(writer, frame->cells, count);
+    put(writer, &snapshot, sizeof(snapshot));
+    put(writer, writer->changes, snapshot.changes * sizeof(uint32_t));
+  }
+  game->ticks++;
+  return writer->failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int archiveEndGame(ArchiveWriter_t* writer) {
+  if (writer->open) {
+    GameEntry_t* game = &writer->games[writer->game_count - 1];
+    const uint64_t keyframes =
+        (game->ticks + writer->interval - 1) / writer->interval;
+    game->keyframes = writer->offset;
+    put(writer, writer->keyframes, keyframes * sizeof(uint64_t));
+    writer->open = false;
+  }
+  return writer->failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int archiveFinish(ArchiveWriter_t* writer) {
+  int exit_code = EXIT_FAILURE;
+  if (writer) {
+    archiveEndGame(writer);
+    const uint64_t index = writer->offset;
+    put(writer, writer->games, writer->game_count * sizeof(GameEntry_t));
+    if (fseek(writer->file, 0, SEEK_SET) == 0)
+      writeHeader(writer, index);
+    else
+      writer->failed = true;
+    if (fclose(writer->file) != 0) writer->failed = true;
+    if (!writer->failed) exit_code = EXIT_SUCCESS;
+    free(writer->games);
+    free(writer->cells);
+    free(writer->changes);
+    free(writer->keyframes);
+    free(writer);
+  }
+  return exit_code;
+}
+
+// size bytes at offset, NULL if they run past the end of the file
+static const uint8_t* at(const ArchiveReader_t* reader, const uint64_t offset,
+                         const uint64_t size) {
+  return offset <= reader->size && size <= reader->size - offset
+             ? reader->data + offset
+             : NULL;
+}
+
+static bool mapFile(ArchiveReader_t* reader, const char* path) {
+  bool mapped = false;
+  const int fd = open(path, O_RDONLY);
+  struct stat info;
+  if (fd >= 0 && fstat(fd, &info) == 0 &&
+      (size_t)info.st_size >= sizeof(FileHeader_t)) {
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      // Seeks jump around, reading ahead would only waste memory
+      posix_madvise(data, info.st_size, POSIX_MADV_RANDOM);
+      reader->data = data;
+      reader->size = (size_t)info.st_size;
+      mapped = true;
+    }
+  }
+  if (fd >= 0) close(fd);
+  return mapped;
+}
+
+ArchiveReader_t* archiveOpen(const char* path) {
+  ArchiveReader_t* reader = calloc(1, sizeof(*reader));
+  FileHeader_t header;
+  if (reader && mapFile(reader, path)) {
+    memcpy(&header, reader->data, sizeof(header));
+    if (!memcmp(header.magic, MAGIC, MAGIC_SIZE) &&
+        header.version == ARCHIVE_VERSION && header.interval &&
+        at(reader, header.index,
+           (uint64_t)header.games * sizeof(GameEntry_t))) {
+      reader->interval = header.interval;
+      reader->games = header.games;
+      reader->index = header.index;
+      return reader;
+    }
+  }
+  archiveClose(reader);
+  return NULL;
+}
+
+int archiveGames(const ArchiveReader_t* reader) { return (int)reader->games; }
+
+static bool getGame(const ArchiveReader_t* reader, const int game,
+                    GameEntry_t* entry) {
+  const bool found = game >= 0 && (uint32_t)game < reader->games;
+  if (found)
+    memcpy(entry, reader->data + reader->index + game * sizeof(GameEntry_t),
+           sizeof(*entry));
+  return found;
+}
+
+uint64_t archiveTicks(const ArchiveReader_t* reader, const int game) {
+  GameEntry_t entry;
+  return getGame(reader, game, &entry) ? entry.ticks : 0;
+}
+
+// Reads one record at *offset and moves *offset past it
+static bool readRecord(ArchiveReader_t* reader, uint64_t* offset,
+                       const bool keyframe, const uint32_t count) {
+  Snapshot_t snapshot;
+  const uint8_t* record = at(reader, *offset, sizeof(snapshot));
+  if (!record) return false;
+  memcpy(&snapshot, record, sizeof(snapshot));
+  *offset += sizeof(snapshot);
+  if (keyframe) {
+    const uint8_t* cells = at(reader, *offset, count);
+    if (snapshot.changes != count || !cells) return false;
+    memcpy(reader->cells, cells, count);
+    *offset += count + (RECORD_ALIGN - count % RECORD_ALIGN) % RECORD_ALIGN;
+  } else {
+    const uint8_t* changes =
+        at(reader, *offset, (uint64_t)snapshot.changes * sizeof(uint32_t));
+    if (!changes) return false;
+    for (uint32_t i = 0; i < snapshot.changes; i++) {
+      uint32_t change;
+      memcpy(&change, changes + i * sizeof(uint32_t), sizeof(change));
+      if ((change >> CELL_BITS) >= count) return false;
+      reader->cells[change >> CELL_BITS] = (uint8_t)change;
+    }
+    *offset += (uint64_t)snapshot.changes * sizeof(uint32_t);
+  }
+  BrickFrame_t* frame = &reader->frame;
+  frame->score = snapshot.score;
+  frame->high_score = snapshot.high_score;
+  frame->level = snapshot.level;
+  frame->speed = snapshot.speed;
+  frame->pause = snapshot.pause;
+  memcpy(frame->next, snapshot.next, sizeof(frame->next));
+  return true;
+}
+
+const BrickFrame_t* archiveSeek(ArchiveReader_t* reader, const int game,
+                                const uint64_t tick) {
+  GameEntry_t entry;
+  if (!getGame(reader, game, &entry) || tick >= entry.ticks ||
+      entry.width < 1 || entry.width > FIELD_MAX_SIZE || entry.length < 1 ||
+      entry.length > FIELD_MAX_SIZE)
+    return NULL;
+  const uint32_t count = (uint32_t)entry.width * (uint32_t)entry.length;
+  if (count > reader->cells_size) {
+    uint8_t* cells = realloc(reader->cells, count);
+    if (!cells) return NULL;
+    reader->cells = cells;
+    reader->cells_size = count;
+  }
+  const uint8_t* keyframe =
+      at(reader, entry.keyframes + tick / reader->interval * sizeof(uint64_t),
+         sizeof(uint64_t));
+  uint64_t offset = 0;
+  if (!keyframe) return NULL;
+  memcpy(&offset, keyframe, sizeof(offset));
+  bool intact = readRecord(reader, &offset, true, count);
+  for (uint64_t i = 0; intact && i < tick % reader->interval; i++)
+    intact = readRecord(reader, &offset, false, count);
+  BrickFrame_t* frame = &reader->frame;
+  frame->generation = tick;
+  frame->width = entry.width;
+  frame->length = entry.length;
+  frame->cells = reader->cells;
+  frame->dirty = NULL;
+  frame->dirty_count = -1;
+  return intact ? frame : NULL;
+}
+
+void archiveClose(ArchiveReader_t* reader) {
+  if (reader) {
+    if (reader->data) munmap((void*)reader->data, reader->size);
+    free(reader->cells);
+    free(reader);
+  }
+}
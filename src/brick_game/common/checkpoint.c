@@ -0,0 +1,26 @@
+#include "checkpoint.h"
+
+#include <string.h>
+
+#define MAGIC "BGCK"
+#define MAGIC_SIZE 4
+
+void ckInitHeader(CheckpointHeader_t* header, const CheckpointEngine_t engine,
+                  const size_t layout, const size_t size) {
+  memcpy(header->magic, MAGIC, MAGIC_SIZE);
+  header->version = CHECKPOINT_VERSION;
+  header->engine = engine;
+  header->layout = (uint32_t)layout;
+  header->size = size;
+}
+
+bool ckCheckHeader(const void* buffer, const size_t size,
+                   const CheckpointEngine_t engine, const size_t layout) {
+  CheckpointHeader_t header;
+  if (!buffer || size < sizeof(header)) return false;
+  memcpy(&header, buffer, sizeof(header));
+  return !memcmp(header.magic, MAGIC, MAGIC_SIZE) &&
+         header.version == CHECKPOINT_VERSION && header.engine == engine &&
+         header.layout == layout && header.size >= layout &&
+         header.size <= size;
+}
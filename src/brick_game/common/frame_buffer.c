@@ -0,0 +1,284 @@
+#include "frame_buffer.h"
+
+#include <stdatomic.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+#define FRAME_COUNT 3
+#define FRAME_INDEX_MASK 3u
+#define FRAME_FRESH 4u  ///< Set in middle when the writer swapped a new frame
+#define FRAME_NONE 3u   ///< No frame published yet
+/// Frames with more changed cells than size / FRAME_DIRTY_SHARE are marked for
+/// a full redraw, which is cheaper than drawing that many cells one by one
+#define FRAME_DIRTY_SHARE 8
+#define FRAME_DIRTY_MIN 16
+
+typedef struct {
+  BrickFrame_t frame;     ///< Frame handed to the reader
+  uint8_t* cells;         ///< Owned cell array, frame.cells points here
+  size_t capacity;        ///< Size of cells in bytes
+  int32_t* dirty;         ///< Owned dirty list, frame.dirty points here
+  size_t dirty_capacity;  ///< Entries of dirty
+} FrameSlot_t;
+
+/**
+ * @details The writer owns back, the reader owns front and middle is swapped
+ * between them atomically, so neither side ever touches a slot the other one
+ * is using
+ */
+struct FrameBuffer {
+  FrameSlot_t slots[FRAME_COUNT];
+  unsigned back;                ///< Writer's slot
+  unsigned published;           ///< Writer's last publication, FRAME_NONE
+  unsigned front;               ///< Reader's slot
+  _Atomic unsigned middle;      ///< Exchanged slot plus FRAME_FRESH flag
+  _Atomic uint64_t generation;  ///< Publications so far
+  _Atomic int waiters;          ///< Readers sleeping in fbWait()
+  mtx_t wait_mtx;               ///< Guards the sleep of the readers
+  cnd_t wake;                   ///< Signalled on publication when waited for
+  int width;                    ///< Size of the next publication
+  int length;
+  int animation;                ///< Animation of the next publication
+  int progress;
+};
+
+static size_t dirtyLimit(const size_t size) {
+  return size / FRAME_DIRTY_SHARE + FRAME_DIRTY_MIN;
+}
+
+static int reserveCells(FrameSlot_t* slot, const size_t size) {
+  int exit_code = EXIT_SUCCESS;
+  if (slot->capacity < size) {
+    uint8_t* cells = calloc(size, sizeof(uint8_t));
+    int32_t* dirty = calloc(dirtyLimit(size), sizeof(int32_t));
+    if (cells && dirty) {
+      free(slot->cells);
+      free(slot->dirty);
+      slot->cells = cells;
+      slot->capacity = size;
+      slot->frame.cells = cells;
+      slot->dirty = dirty;
+      slot->dirty_capacity = dirtyLimit(size);
+      slot->frame.dirty = dirty;
+    } else {
+      free(cells);
+      free(dirty);
+      exit_code = EXIT_FAILURE;
+    }
+  }
+  return exit_code;
+}
+
+FrameBuffer_t* fbCreate(const int width, const int length) {
+  FrameBuffer_t* fb = calloc(1, sizeof(FrameBuffer_t));
+  const size_t size = (size_t)width * length;
+  bool allocated = fb != NULL;
+  if (allocated && mtx_init(&fb->wait_mtx, mtx_plain) != thrd_success) {
+    free(fb);
+    fb = NULL;
+    allocated = false;
+  }
+  if (allocated && cnd_init(&fb->wake) != thrd_success) {
+    mtx_destroy(&fb->wait_mtx);
+    free(fb);
+    fb = NULL;
+    allocated = false;
+  }
+  for (int i = 0; i < FRAME_COUNT && allocated; ++i) {
+    allocated = reserveCells(&fb->slots[i], size) == EXIT_SUCCESS;
+    fb->slots[i].frame.width = width;
+    fb->slots[i].frame.length = length;
+    fb->slots[i].frame.dirty_count = -1;
+  }
+  if (fb && allocated) {
+    fb->back = 0;
+    fb->published = FRAME_NONE;
+    atomic_init(&fb->middle, 1u);
+    fb->front = 2;
+    atomic_init(&fb->generation, 0);
+    atomic_init(&fb->waiters, 0);
+    fb->width = width;
+    fb->length = length;
+  } else {
+    fbDestroy(fb);
+    fb = NULL;
+  }
+  return fb;
+}
+
+void fbDestroy(FrameBuffer_t* fb) {
+  if (fb) {
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+      free(fb->slots[i].cells);
+      free(fb->slots[i].dirty);
+    }
+    cnd_destroy(&fb->wake);
+    mtx_destroy(&fb->wait_mtx);
+    free(fb);
+  }
+}
+
+void fbSetAnimation(FrameBuffer_t* fb, const int animation,
+                    const int progress) {
+  fb->animation = animation;
+  fb->progress = progress;
+}
+
+void fbResize(FrameBuffer_t* fb, const int width, const int length) {
+  fb->width = width;
+  fb->length = length;
+}
+
+// Sizes the back frame for the next publication, NULL if out of memory
+static BrickFrame_t* beginFrame(FrameBuffer_t* fb) {
+  FrameSlot_t* slot = &fb->slots[fb->back];
+  BrickFrame_t* frame = NULL;
+  if (reserveCells(slot, (size_t)fb->width * fb->length) == EXIT_SUCCESS) {
+    frame = &slot->frame;
+    frame->width = fb->width;
+    frame->length = fb->length;
+  }
+  return frame;
+}
+
+/**
+ * @details Compares the filled back frame with the previous publication,
+ * which stays untouched until the writer gets it back as its back frame.
+ * Unchanged stretches are skipped a word at a time
+ */
+static void collectDirty(FrameBuffer_t* fb, BrickFrame_t* frame) {
+  FrameSlot_t* slot = &fb->slots[fb->back];
+  const BrickFrame_t* previous =
+      fb->published == FRAME_NONE ? NULL : &fb->slots[fb->published].frame;
+  frame->dirty_count = -1;
+  if (previous && previous->width == frame->width &&
+      previous->length == frame->length) {
+    const size_t size = (size_t)frame->width * frame->length;
+    const uint8_t* old_cells = previous->cells;
+    const uint8_t* new_cells = slot->cells;
+    size_t count = 0;
+    bool overflow = false;
+    size_t n = 0;
+    while (n < size && !overflow) {
+      if (size - n >= sizeof(uint64_t) &&
+          !memcmp(old_cells + n, new_cells + n, sizeof(uint64_t))) {
+        n += sizeof(uint64_t);
+      } else {
+        if (old_cells[n] != new_cells[n]) {
+          overflow = count == slot->dirty_capacity;
+          if (!overflow) slot->dirty[count++] = (int32_t)n;
+        }
+        ++n;
+      }
+    }
+    if (!overflow) frame->dirty_count = (int)count;
+  }
+}
+
+// Stamps the back frame and swaps it in for the reader
+static void commitFrame(FrameBuffer_t* fb, BrickFrame_t* frame,
+                        const GameInfo_t* stats) {
+  collectDirty(fb, frame);
+  frame->score = stats->score;
+  frame->high_score = stats->high_score;
+  frame->level = stats->level;
+  frame->speed = stats->speed;
+  frame->pause = stats->pause;
+  frame->animation = fb->animation;
+  frame->progress = fb->progress;
+  frame->generation =
+      atomic_load_explicit(&fb->generation, memory_order_relaxed) + 1;
+  fb->published = fb->back;
+  fb->back = atomic_exchange_explicit(&fb->middle, fb->back | FRAME_FRESH,
+                                      memory_order_acq_rel) &
+             FRAME_INDEX_MASK;
+  // Sequentially consistent with the waiter count, so either the writer sees
+  // a waiter or the waiter sees the new generation before it sleeps
+  atomic_store(&fb->generation, frame->generation);
+  if (atomic_load(&fb->waiters)) {
+    mtx_lock(&fb->wait_mtx);
+    cnd_broadcast(&fb->wake);
+    mtx_unlock(&fb->wait_mtx);
+  }
+}
+
+void fbPublishInfo(FrameBuffer_t* fb, const GameInfo_t* info) {
+  BrickFrame_t* frame = beginFrame(fb);
+  if (frame) {
+    uint8_t* cells = fb->slots[fb->back].cells;
+    const int width = frame->width, length = frame->length;
+    for (int i = 0; i < length; ++i) {
+      uint8_t* row = cells + (size_t)i * width;
+      if (info->field)
+        for (int j = 0; j < width; ++j) row[j] = (uint8_t)info->field[i][j];
+      else
+        memset(row, 0, width);
+    }
+    for (int i = 0; i < NEXTF_LENGTH; ++i) {
+      for (int j = 0; j < NEXTF_WIDTH; ++j)
+        frame->next[i][j] = info->next ? (uint8_t)info->next[i][j] : 0;
+    }
+    commitFrame(fb, frame, info);
+  }
+}
+
+void fbPublishCells(FrameBuffer_t* fb, const uint8_t* cells,
+                    const uint8_t* next, const GameInfo_t* stats) {
+  BrickFrame_t* frame = beginFrame(fb);
+  if (frame) {
+    const size_t size = (size_t)frame->width * frame->length;
+    if (cells)
+      memcpy(fb->slots[fb->back].cells, cells, size);
+    else
+      memset(fb->slots[fb->back].cells, 0, size);
+    if (next)
+      memcpy(frame->next, next, sizeof(frame->next));
+    else
+      memset(frame->next, 0, sizeof(frame->next));
+    commitFrame(fb, frame, stats);
+  }
+}
+
+const BrickFrame_t* fbAcquire(FrameBuffer_t* fb) {
+  if (atomic_load_explicit(&fb->middle, memory_order_relaxed) & FRAME_FRESH) {
+    fb->front = atomic_exchange_explicit(&fb->middle, fb->front,
+                                         memory_order_acq_rel) &
+                FRAME_INDEX_MASK;
+  }
+  return &fb->slots[fb->front].frame;
+}
+
+uint64_t fbGeneration(const FrameBuffer_t* fb) {
+  return fb ? atomic_load_explicit(&fb->generation, memory_order_acquire) : 0;
+}
+
+uint64_t fbWait(FrameBuffer_t* fb, const uint64_t seen, const int timeout_ms) {
+  uint64_t generation = fbGeneration(fb);
+  if (generation <= seen && timeout_ms > 0) {
+    const struct timespec timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_nsec = (long)(timeout_ms % 1000) * 1000000L};
+    if (fb) {
+      struct timespec deadline;
+      timespec_get(&deadline, TIME_UTC);
+      deadline.tv_sec += timeout.tv_sec;
+      deadline.tv_nsec += timeout.tv_nsec;
+      if (deadline.tv_nsec >= 1000000000L) {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      mtx_lock(&fb->wait_mtx);
+      atomic_fetch_add(&fb->waiters, 1);
+      int wait_code = thrd_success;
+      while ((generation = atomic_load(&fb->generation)) <= seen &&
+             wait_code == thrd_success)
+        wait_code = cnd_timedwait(&fb->wake, &fb->wait_mtx, &deadline);
+      atomic_fetch_sub(&fb->waiters, 1);
+      mtx_unlock(&fb->wait_mtx);
+    } else {
+      thrd_sleep(&timeout, NULL);
+    }
+  }
+  return generation;
+}
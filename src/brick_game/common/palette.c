@@ -0,0 +1,22 @@
+#include "palette.h"
+
+#include "colors.h"
+
+static const BrickPalette_t default_palette = {
+    .entries = {
+        [Empty] = PALETTE_COLOR(160, 160, 164, TermDefault),
+        [Static] = PALETTE_COLOR(255, 255, 255, TermWhite),
+        [Damaged] = {.red = 255,
+                     .alpha = 128,
+                     .term_color = TermWhite,
+                     .glyph = "$ "},
+        [Red] = PALETTE_COLOR(255, 0, 0, TermRed),
+        [Magenta] = PALETTE_COLOR(255, 0, 255, TermMagenta),
+        [Green] = PALETTE_COLOR(0, 255, 0, TermGreen),
+        [Cyan] = PALETTE_COLOR(0, 255, 255, TermBlue),
+        [Yellow] = PALETTE_COLOR(255, 255, 0, TermYellow),
+        [Orange] = PALETTE_COLOR(255, 165, 0, TermYellow),
+        [Blue] = PALETTE_COLOR(0, 0, 255, TermBlue),
+    }};
+
+const BrickPalette_t *paletteDefault(void) { return &default_palette; }
@@ -0,0 +1,141 @@
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAGIC "BGRP"
+#define MAGIC_SIZE 4
+#define VARINT_MAX_BYTES 10
+#define KIND_MASK ((1u << REPLAY_KIND_BITS) - 1)
+#define ACTION_MASK 7u
+
+struct ReplayWriter {
+  FILE* file;
+  uint64_t tick;  ///< Tick of the last record
+};
+
+struct ReplayReader {
+  FILE* file;
+  uint64_t tick;  ///< Tick of the last record read
+};
+
+static bool writeVarint(FILE* file, uint64_t value) {
+  uint8_t bytes[VARINT_MAX_BYTES];
+  size_t size = 0;
+  do {
+    bytes[size] = value & 0x7f;
+    value >>= 7;
+    if (value) bytes[size] |= 0x80;
+    size++;
+  } while (value);
+  return fwrite(bytes, 1, size, file) == size;
+}
+
+static bool readVarint(FILE* file, uint64_t* value) {
+  *value = 0;
+  bool more = true;
+  for (int shift = 0; more && shift < 7 * VARINT_MAX_BYTES; shift += 7) {
+    const int byte = fgetc(file);
+    if (byte == EOF) return false;
+    *value |= (uint64_t)(byte & 0x7f) << shift;
+    more = byte & 0x80;
+  }
+  return !more;
+}
+
+// Ticks never run backwards, a smaller one is taken as no time passed
+static uint64_t recordValue(uint64_t* last, const uint64_t tick,
+                            const unsigned kind) {
+  const uint64_t delta = tick > *last ? tick - *last : 0;
+  if (tick > *last) *last = tick;
+  return delta << REPLAY_KIND_BITS | kind;
+}
+
+ReplayWriter_t* replayCreate(const char* path, const ReplayHeader_t* header,
+                             const uint64_t tick) {
+  ReplayWriter_t* writer = calloc(1, sizeof(ReplayWriter_t));
+  if (writer) {
+    writer->tick = tick;
+    writer->file = fopen(path, "wb");
+  }
+  if (writer && writer->file &&
+      fwrite(MAGIC, 1, MAGIC_SIZE, writer->file) == MAGIC_SIZE &&
+      writeVarint(writer->file, REPLAY_VERSION) &&
+      writeVarint(writer->file, header->seed) &&
+      writeVarint(writer->file, (uint64_t)header->width) &&
+      writeVarint(writer->file, (uint64_t)header->length) &&
+      fflush(writer->file) == 0)
+    return writer;
+  if (writer && writer->file) fclose(writer->file);
+  free(writer);
+  return NULL;
+}
+
+void replayRecord(ReplayWriter_t* writer, const uint64_t tick,
+                  const UserAction_t action, const bool hold) {
+  if (writer) {
+    const unsigned kind = ((unsigned)action & ACTION_MASK) |
+                          (hold ? REPLAY_HOLD : 0u);
+    writeVarint(writer->file, recordValue(&writer->tick, tick, kind));
+    fflush(writer->file);
+  }
+}
+
+void replayFinish(ReplayWriter_t* writer, const uint64_t tick) {
+  if (writer) {
+    writeVarint(writer->file, recordValue(&writer->tick, tick, REPLAY_END));
+    fclose(writer->file);
+    free(writer);
+  }
+}
+
+ReplayReader_t* replayOpen(const char* path, ReplayHeader_t* header) {
+  ReplayReader_t* reader = calloc(1, sizeof(ReplayReader_t));
+  char magic[MAGIC_SIZE];
+  uint64_t version = 0, seed = 0, width = 0, length = 0;
+  if (reader) reader->file = fopen(path, "rb");
+  if (reader && reader->file &&
+      fread(magic, 1, MAGIC_SIZE, reader->file) == MAGIC_SIZE &&
+      !memcmp(magic, MAGIC, MAGIC_SIZE) &&
+      readVarint(reader->file, &version) && version == REPLAY_VERSION &&
+      readVarint(reader->file, &seed) && seed <= UINT32_MAX &&
+      readVarint(reader->file, &width) && width <= FIELD_MAX_SIZE &&
+      readVarint(reader->file, &length) && length <= FIELD_MAX_SIZE) {
+    *header = (ReplayHeader_t){
+        .seed = (uint32_t)seed, .width = (int)width, .length = (int)length};
+    return reader;
+  }
+  replayClose(reader);
+  return NULL;
+}
+
+bool replayNext(ReplayReader_t* reader, ReplayEvent_t* event) {
+  uint64_t value = 0;
+  bool found = false;
+  if (reader->file && readVarint(reader->file, &value)) {
+    reader->tick += value >> REPLAY_KIND_BITS;
+    const unsigned kind = value & KIND_MASK;
+    if (kind < REPLAY_END) {
+      *event = (ReplayEvent_t){.tick = reader->tick,
+                               .action = (UserAction_t)(kind & ACTION_MASK),
+                               .hold = kind & REPLAY_HOLD};
+      found = true;
+    }
+  }
+  // Nothing is read past the end record
+  if (!found && reader->file) {
+    fclose(reader->file);
+    reader->file = NULL;
+  }
+  return found;
+}
+
+uint64_t replayEndTick(const ReplayReader_t* reader) { return reader->tick; }
+
+void replayClose(ReplayReader_t* reader) {
+  if (reader) {
+    if (reader->file) fclose(reader->file);
+    free(reader);
+  }
+}
@@ -0,0 +1,334 @@
+#include "scheduler.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <threads.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC 1000000000LL
+#define NOT_IN_HEAP (-1)
+#define INITIAL_TIMERS 16
+
+typedef struct {
+  SchedTask_t task;
+  void* arg;
+  int64_t due;       ///< TIME_UTC nanoseconds of the next run
+  uint32_t version;  ///< Bumped on release, stale handles stop matching
+  int heap_pos;      ///< Index in the heap, NOT_IN_HEAP if parked or running
+  int next_free;     ///< Free list link
+  bool used;
+  bool running;
+  bool wake;       ///< Woken while running, run again right away
+  bool cancelled;  ///< Cancelled while running, release after the run
+} SchedTimer_t;
+
+/**
+ * @details One mutex guards the timers and the heap; it is never held while
+ * a task runs, so tasks may take their game locks and call back into the
+ * scheduler
+ */
+struct Scheduler {
+  mtx_t mutex;
+  cnd_t work;      ///< Heap changed or stopping
+  cnd_t released;  ///< A running timer was released
+  SchedTimer_t* timers;
+  int* heap;  ///< Slots ordered by due time
+  int heap_size;
+  int capacity;
+  int free_slot;  ///< Head of the free list, -1 if none
+  bool stopping;
+  thrd_t* workers;
+  int worker_count;
+};
+
+static _Thread_local SchedTimerId_t running_timer = 0;
+
+static int64_t nowNs() {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static struct timespec toTimespec(const int64_t ns) {
+  return (struct timespec){.tv_sec = ns / NSEC_PER_SEC,
+                           .tv_nsec = ns % NSEC_PER_SEC};
+}
+
+static SchedTimerId_t getId(const Scheduler_t* sched, const int slot) {
+  return (SchedTimerId_t)sched->timers[slot].version << 32 |
+         (uint32_t)(slot + 1);
+}
+
+// Slot of a live timer, -1 for unknown or released handles
+static int findSlot(const Scheduler_t* sched, const SchedTimerId_t id) {
+  const int slot = (int)(id & 0xFFFFFFFFu) - 1;
+  return slot >= 0 && slot < sched->capacity && sched->timers[slot].used &&
+                 sched->timers[slot].version == (uint32_t)(id >> 32)
+             ? slot
+             : -1;
+}
+
+static void swapHeap(Scheduler_t* sched, const int a, const int b) {
+  const int slot = sched->heap[a];
+  sched->heap[a] = sched->heap[b];
+  sched->heap[b] = slot;
+  sched->timers[sched->heap[a]].heap_pos = a;
+  sched->timers[sched->heap[b]].heap_pos = b;
+}
+
+static bool isEarlier(const Scheduler_t* sched, const int a, const int b) {
+  return sched->timers[sched->heap[a]].due < sched->timers[sched->heap[b]].due;
+}
+
+static void siftUp(Scheduler_t* sched, int pos) {
+  while (pos > 0 && isEarlier(sched, pos, (pos - 1) / 2)) {
+    swapHeap(sched, pos, (pos - 1) / 2);
+    pos = (pos - 1) / 2;
+  }
+}
+
+static void siftDown(Scheduler_t* sched, int pos) {
+  bool settled = false;
+  while (!settled) {
+    int first = pos;
+    const int left = 2 * pos + 1, right = 2 * pos + 2;
+    if (left < sched->heap_size && isEarlier(sched, left, first)) first = left;
+    if (right < sched->heap_size && isEarlier(sched, right, first))
+      first = right;
+    if (first != pos) {
+      swapHeap(sched, pos, first);
+      pos = first;
+    } else
+      settled = true;
+  }
+}
+
+// Queues a timer at its due time and lets a worker look at the new top
+static void pushHeap(Scheduler_t* sched, const int slot) {
+  const int pos = sched->heap_size++;
+  sched->heap[pos] = slot;
+  sched->timers[slot].heap_pos = pos;
+  siftUp(sched, pos);
+  if (sched->timers[slot].heap_pos == 0) cnd_signal(&sched->work);
+}
+
+static void removeHeap(Scheduler_t* sched, const int pos) {
+  const int slot = sched->heap[pos];
+  const int last = --sched->heap_size;
+  if (pos != last) {
+    swapHeap(sched, pos, last);
+    siftDown(sched, pos);
+    siftUp(sched, pos);
+  }
+  sched->timers[slot].heap_pos = NOT_IN_HEAP;
+}
+
+static void releaseTimer(Scheduler_t* sched, const int slot) {
+  SchedTimer_t* timer = &sched->timers[slot];
+  if (timer->heap_pos != NOT_IN_HEAP) removeHeap(sched, timer->heap_pos);
+  const uint32_t version = timer->version + 1;
+  *timer = (SchedTimer_t){.version = version,
+                          .heap_pos = NOT_IN_HEAP,
+                          .next_free = sched->free_slot};
+  sched->free_slot = slot;
+}
+
+static bool growTimers(Scheduler_t* sched) {
+  const int capacity = sched->capacity ? sched->capacity * 2 : INITIAL_TIMERS;
+  SchedTimer_t* timers =
+      realloc(sched->timers, capacity * sizeof(SchedTimer_t));
+  int* heap = timers ? realloc(sched->heap, capacity * sizeof(int)) : NULL;
+  if (timers) sched->timers = timers;
+  if (heap) {
+    sched->heap = heap;
+    for (int i = capacity - 1; i >= sched->capacity; --i) {
+      timers[i] = (SchedTimer_t){.heap_pos = NOT_IN_HEAP,
+                                 .next_free = sched->free_slot};
+      sched->free_slot = i;
+    }
+    sched->capacity = capacity;
+  }
+  return heap != NULL;
+}
+
+// Runs one due timer with the mutex released and files it by its result
+static void runTimer(Scheduler_t* sched, const int slot) {
+  SchedTimer_t* timer = &sched->timers[slot];
+  removeHeap(sched, timer->heap_pos);
+  if (sched->heap_size) cnd_signal(&sched->work);
+  timer->running = true;
+  timer->wake = false;
+  const SchedTask_t task = timer->task;
+  void* arg = timer->arg;
+  running_timer = getId(sched, slot);
+  mtx_unlock(&sched->mutex);
+  const int64_t result = task(arg);
+  mtx_lock(&sched->mutex);
+  running_timer = 0;
+  timer = &sched->timers[slot];
+  timer->running = false;
+  if (timer->cancelled || result == SCHED_TASK_DONE) {
+    releaseTimer(sched, slot);
+    cnd_broadcast(&sched->released);
+  } else if (result >= 0 || timer->wake) {
+    timer->due = nowNs() + (result >= 0 ? result : 0);
+    pushHeap(sched, slot);
+  }
+  timer->wake = false;
+}
+
+static int workerLoop(void* arg) {
+  Scheduler_t* sched = arg;
+  mtx_lock(&sched->mutex);
+  while (!sched->stopping) {
+    if (!sched->heap_size) {
+      cnd_wait(&sched->work, &sched->mutex);
+    } else {
+      const int slot = sched->heap[0];
+      const int64_t due = sched->timers[slot].due;
+      if (due > nowNs()) {
+        const struct timespec until = toTimespec(due);
+        cnd_timedwait(&sched->work, &sched->mutex, &until);
+      } else
+        runTimer(sched, slot);
+    }
+  }
+  mtx_unlock(&sched->mutex);
+  return EXIT_SUCCESS;
+}
+
+Scheduler_t* schedCreate(const int workers) {
+  Scheduler_t* sched = workers > 0 ? calloc(1, sizeof(Scheduler_t)) : NULL;
+  bool started = sched != NULL;
+  if (started) {
+    sched->free_slot = -1;
+    sched->workers = calloc(workers, sizeof(thrd_t));
+    started = sched->workers && growTimers(sched) &&
+              mtx_init(&sched->mutex, mtx_plain) == thrd_success;
+    if (started && cnd_init(&sched->work) != thrd_success) {
+      mtx_destroy(&sched->mutex);
+      started = false;
+    }
+    if (started && cnd_init(&sched->released) != thrd_success) {
+      cnd_destroy(&sched->work);
+      mtx_destroy(&sched->mutex);
+      started = false;
+    }
+    for (int i = 0; i < workers && started; ++i) {
+      if (thrd_create(&sched->workers[i], workerLoop, sched) == thrd_success)
+        ++sched->worker_count;
+      else
+        started = false;
+    }
+    if (!started && sched->worker_count) {
+      schedDestroy(sched);
+      sched = NULL;
+    } else if (!started) {
+      free(sched->workers);
+      free(sched->timers);
+      free(sched->heap);
+      free(sched);
+      sched = NULL;
+    }
+  }
+  return sched;
+}
+
+void schedDestroy(Scheduler_t* sched) {
+  if (sched) {
+    mtx_lock(&sched->mutex);
+    sched->stopping = true;
+    cnd_broadcast(&sched->work);
+    mtx_unlock(&sched->mutex);
+    for (int i = 0; i < sched->worker_count; ++i)
+      thrd_join(sched->workers[i], NULL);
+    cnd_destroy(&sched->released);
+    cnd_destroy(&sched->work);
+    mtx_destroy(&sched->mutex);
+    free(sched->workers);
+    free(sched->timers);
+    free(sched->heap);
+    free(sched);
+  }
+}
+
+SchedTimerId_t schedAdd(Scheduler_t* sched, SchedTask_t task, void* arg,
+                        const int64_t delay) {
+  SchedTimerId_t id = 0;
+  mtx_lock(&sched->mutex);
+  if (sched->free_slot >= 0 || growTimers(sched)) {
+    const int slot = sched->free_slot;
+    SchedTimer_t* timer = &sched->timers[slot];
+    sched->free_slot = timer->next_free;
+    timer->task = task;
+    timer->arg = arg;
+    timer->used = true;
+    if (delay >= 0) {
+      timer->due = nowNs() + delay;
+      pushHeap(sched, slot);
+    }
+    id = getId(sched, slot);
+  }
+  mtx_unlock(&sched->mutex);
+  return id;
+}
+
+void schedWake(Scheduler_t* sched, const SchedTimerId_t id) {
+  mtx_lock(&sched->mutex);
+  const int slot = findSlot(sched, id);
+  if (slot >= 0) {
+    SchedTimer_t* timer = &sched->timers[slot];
+    const int64_t now = nowNs();
+    if (timer->running) {
+      timer->wake = true;
+    } else if (timer->heap_pos == NOT_IN_HEAP) {
+      timer->due = now;
+      pushHeap(sched, slot);
+    } else if (timer->due > now) {
+      timer->due = now;
+      siftUp(sched, timer->heap_pos);
+      if (timer->heap_pos == 0) cnd_signal(&sched->work);
+    }
+  }
+  mtx_unlock(&sched->mutex);
+}
+
+void schedCancel(Scheduler_t* sched, const SchedTimerId_t id) {
+  mtx_lock(&sched->mutex);
+  const int slot = findSlot(sched, id);
+  if (slot >= 0 && sched->timers[slot].running) {
+    sched->timers[slot].cancelled = true;
+    while (id != running_timer && findSlot(sched, id) >= 0)
+      cnd_wait(&sched->released, &sched->mutex);
+  } else if (slot >= 0)
+    releaseTimer(sched, slot);
+  mtx_unlock(&sched->mutex);
+}
+
+static atomic_int shared_workers = 0;
+static atomic_bool shared_started = false;
+static Scheduler_t* shared = NULL;
+static once_flag shared_once = ONCE_FLAG_INIT;
+
+static void startShared() {
+  atomic_store(&shared_started, true);
+  int workers = atomic_load(&shared_workers);
+  if (workers <= 0) workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  shared = schedCreate(workers > 0 ? workers : 1);
+}
+
+int schedSetSharedWorkers(const int workers) {
+  int exit_code = -1;
+  if (!atomic_load(&shared_started) && workers >= 0) {
+    atomic_store(&shared_workers, workers);
+    exit_code = 0;
+  }
+  return exit_code;
+}
+
+Scheduler_t* schedShared(void) {
+  call_once(&shared_once, startShared);
+  return shared;
+}
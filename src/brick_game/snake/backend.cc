@@ -1,11 +1,184 @@
 #include "backend.h"
 
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <variant>
+
 #include "controler.h"
+#include "palette.h"
+#include "replay.h"
+#include "scheduler.h"
 #include "snake_model.h"
 
+using SnakeControler = brick_game::Controler<brick_game::SnakeModel>;
+using ScheduledControler =
+    brick_game::Controler<brick_game::ScheduledSnakeModel>;
+using SteppedControler = brick_game::Controler<brick_game::HeadlessSnakeModel>;
+
+// Own timer thread by default, the shared scheduler for scheduled games and
+// no timer at all for stepped ones
+struct BrickGame {
+  BrickGame() = default;
+  template <typename Kind>
+  explicit BrickGame(std::in_place_type_t<Kind> kind) : controler(kind) {}
+  ~BrickGame() { StopRecording(); }
+  std::variant<SnakeControler, ScheduledControler, SteppedControler> controler;
+  ReplayWriter_t* recorder{};  // input log, null when not recording
+
+  std::uint64_t GetTicks() const {
+    return std::visit([](const auto& c) { return c.GetTicks(); }, controler);
+  }
+  void StopRecording() {
+    replayFinish(recorder, GetTicks());
+    recorder = nullptr;
+  }
+};
+
+BrickGame_t* bg_create(const BrickGameConfig_t* config) {
+  BrickGame_t* game = nullptr;
+  try {
+    if (config && config->stepped)
+      game = new BrickGame(std::in_place_type<SteppedControler>);
+    else if (config && config->scheduled)
+      game = new BrickGame(std::in_place_type<ScheduledControler>);
+    else
+      game = new BrickGame{};
+  } catch (const std::exception&) {
+    return nullptr;
+  }
+  if (config && (config->width || config->length) &&
+      !std::visit(
+          [config](auto& c) {
+            return c.SetFieldSize(
+                config->width ? config->width : FIELD_WIDTH,
+                config->length ? config->length : FIELD_LENGTH);
+          },
+          game->controler)) {
+    delete game;
+    return nullptr;
+  }
+  if (config && config->seeded)
+    std::visit([config](auto& c) { c.SetSeed(config->seed); },
+               game->controler);
+  return game;
+}
+
+void bg_destroy(BrickGame_t* game) {
+  if (game != bg_default()) delete game;
+}
+
+void bg_input(BrickGame_t* game, const UserAction_t action, bool hold) {
+  if (game->recorder)
+    replayRecord(game->recorder, game->GetTicks(), action, hold);
+  std::visit([=](auto& c) { c.SendInput(action, hold); }, game->controler);
+}
+
+GameInfo_t bg_state(BrickGame_t* game) {
+  return std::visit([](auto& c) { return c.getGameInfoCopy(); },
+                    game->controler);
+}
+
+void bg_field_size(BrickGame_t* game, int* width, int* length) {
+  int w{}, l{};
+  std::visit([&](auto& c) { c.GetFieldSize(w, l); }, game->controler);
+  if (width) *width = w;
+  if (length) *length = l;
+}
+
+uint64_t bg_generation(BrickGame_t* game) {
+  return std::visit([](auto& c) { return c.GetGeneration(); },
+                    game->controler);
+}
+
+const BrickFrame_t* bg_frame(BrickGame_t* game) {
+  return std::visit([](auto& c) { return c.GetFrame(); }, game->controler);
+}
+
+uint64_t bg_wait(BrickGame_t* game, uint64_t seen, int timeout_ms) {
+  return std::visit(
+      [=](auto& c) { return c.WaitGeneration(seen, timeout_ms); },
+      game->controler);
+}
+
+// The generator's state cannot be read back, so a log gets a fresh seed
+int bg_record(BrickGame_t* game, const char* path) {
+  if (!path) {
+    game->StopRecording();
+    return EXIT_SUCCESS;
+  }
+  ReplayHeader_t header{};
+  header.seed = std::random_device{}();
+  if (!std::visit([&](auto& c) { return c.SetSeed(header.seed); },
+                  game->controler))
+    return EXIT_FAILURE;
+  bg_field_size(game, &header.width, &header.length);
+  game->StopRecording();
+  game->recorder = replayCreate(path, &header, game->GetTicks());
+  return game->recorder ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// The field holds FieldCellColors_t values
+const BrickPalette_t* bg_palette() { return paletteDefault(); }
+
+BrickGame_t* bg_default() {
+  static BrickGame game{};
+  return &game;
+}
+
+void bg_step(BrickGame_t* game, int ticks) {
+  std::visit(
+      [ticks](auto& c) {
+        if constexpr (requires { c.Step(ticks); }) c.Step(ticks);
+      },
+      game->controler);
+}
+
+std::size_t bg_save(BrickGame_t* game, void* buffer, std::size_t size) {
+  return std::visit(
+      [=](auto& c) -> std::size_t {
+        if constexpr (requires { c.Save(buffer, size); })
+          return c.Save(buffer, size);
+        else
+          return 0;
+      },
+      game->controler);
+}
+
+int bg_restore(BrickGame_t* game, const void* buffer, std::size_t size) {
+  const std::uint64_t ticks = game->GetTicks();
+  const bool restored = std::visit(
+      [=](auto& c) {
+        if constexpr (requires { c.Restore(buffer, size); })
+          return c.Restore(buffer, size);
+        else
+          return false;
+      },
+      game->controler);
+  if (restored) {
+    replayFinish(game->recorder, ticks);
+    game->recorder = nullptr;
+  }
+  return restored ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int bg_scheduler_workers(int workers) {
+  return schedSetSharedWorkers(workers) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 void userInput(const UserAction_t action, bool hold) {
-  brick_game::Controler<brick_game::SnakeModel>::GetInstance().SendInput(action, hold);
+  bg_input(bg_default(), action, hold);
+}
+GameInfo_t updateCurrentState() { return bg_state(bg_default()); }
+void setGameSeed(const unsigned int seed) {
+  std::visit([seed](auto& c) { c.SetSeed(seed); }, bg_default()->controler);
+}
+int setFieldSize(const int width, const int length) {
+  return std::visit([=](auto& c) { return c.SetFieldSize(width, length); },
+                    bg_default()->controler)
+             ? EXIT_SUCCESS
+             : EXIT_FAILURE;
+}
+void getFieldSize(int* width, int* length) {
+  bg_field_size(bg_default(), width, length);
 }
-GameInfo_t updateCurrentState() {
-  return brick_game::Controler<brick_game::SnakeModel>::GetInstance().getGameInfoCopy();
-}
\ No newline at end of file
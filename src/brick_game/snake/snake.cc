@@ -1,10 +1,21 @@
 
 #include "snake.h"
 
-#include <random>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
 namespace brick_game {
 
-Snake::Snake(std::shared_ptr<Mediator> m) : Component::Component(m) {
+static_assert(std::is_trivially_copyable_v<RandomEngine>,
+              "checkpoints copy the generator as raw memory");
+
+Snake::Snake(std::shared_ptr<Mediator> m, RandomEngine gen, BoardSize size)
+    : Component::Component(m),
+      field_(size),
+      snake_body_(size.Cells()),
+      gen_(std::move(gen)) {
   InitializeSnake();
   SpawnApple();
 }
@@ -15,7 +26,8 @@ Snake::Snake(Snake&& o) noexcept
       got_apple_(o.got_apple_),
       field_(std::move(o.field_)),
       snake_body_(std::move(o.snake_body_)),
-      direction_(std::move(o.direction_)) {}
+      direction_(std::move(o.direction_)),
+      gen_(std::move(o.gen_)) {}
 
 Snake& Snake::operator=(Snake&& o) noexcept {
   if (this != &o) {
@@ -25,13 +37,15 @@ Snake& Snake::operator=(Snake&& o) noexcept {
     field_ = std::move(o.field_);
     snake_body_ = std::move(o.snake_body_);
     direction_ = std::move(o.direction_);
+    gen_ = std::move(o.gen_);
   }
   return *this;
 }
 
 void Snake::InitializeSnake() {
-  int start_y = FIELD_LENGTH / 2;
-  int start_x = FIELD_WIDTH / 2;
+  const auto [width, length] = field_.GetSize();
+  int start_y = length / 2;
+  int start_x = width / 2;
 
   AddSnakeSeg({{start_y + 2, start_x},
                {start_y + 1, start_x},
@@ -44,12 +58,10 @@ void Snake::SpawnApple() {
 }
 
 int Snake::GetRandomFreeCellNum() {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  const size_t free_cells = field_.kTotalCells - snake_body_.size();
+  const int free_cells = field_.TotalCells() - snake_body_.Size();
   if (!free_cells) return 0;
-  std::uniform_int_distribution<int> dist(0, static_cast<int>(free_cells) - 1);
-  return dist(gen);
+  std::uniform_int_distribution<int> dist(0, free_cells - 1);
+  return dist(gen_);
 }
 
 Cell Snake::GetNextCell() {
@@ -71,7 +83,7 @@ Cell Snake::GetNextCell() {
       break;
   }
 
-  return offset + snake_body_.back();
+  return offset + field_.GetCell(snake_body_.Back());
 }
 
 void Snake::Move(MovementAction new_direction, bool palyer_action) {
@@ -79,12 +91,11 @@ void Snake::Move(MovementAction new_direction, bool palyer_action) {
   if (direction_.IsValidDirection(new_direction)) {
     direction_ = new_direction;
     Cell next = GetNextCell();
-    snake_body_.push(next);
-    if (IsCollision()) {
+    if (IsCollision(next)) {
       this->mediator_->Notify(Event::GameOver);
       return;
     }
-    field_.FillCell(next);
+    AddSnakeSeg(next);
     if (!got_apple_) {
       RemoveTailSeg();
     } else {
@@ -99,15 +110,16 @@ void Snake::Move(MovementAction new_direction, bool palyer_action) {
   }
 }
 
-bool Snake::IsCollision() {
-  const auto [y, x] = snake_body_.back();
-  if (y >= FIELD_LENGTH || y < 0 || x >= FIELD_WIDTH || x < 0) return true;
-  if (field_.CheckCell(snake_body_.back())) return true;
+bool Snake::IsCollision(Cell next) {
+  const auto [y, x] = next;
+  const auto [width, length] = field_.GetSize();
+  if (y >= length || y < 0 || x >= width || x < 0) return true;
+  if (field_.CheckCell(next)) return true;
   return false;
 }
 
-void Snake::AddSnakeSeg(const Cell& seg) {
-  snake_body_.push(seg);
+void Snake::AddSnakeSeg(Cell seg) {
+  snake_body_.Push(field_.GetCellNum(seg));
   field_.FillCell(seg);
 }
 
@@ -115,16 +127,86 @@ void Snake::AddSnakeSeg(std::initializer_list<Cell> list) {
   for (auto cell : list) AddSnakeSeg(cell);
 }
 void Snake::RemoveTailSeg() {
-  field_.EmptyCell(snake_body_.front());
-  snake_body_.pop();
+  field_.EmptyCell(field_.GetCell(snake_body_.Front()));
+  snake_body_.Pop();
 }
 
 void Snake::PlaceGameInfo(GameInfo_t& gi, bool gameover) {
   std::scoped_lock<std::mutex> lock(mtx_);
-  field_.PlaceFieldAndNext(gi, gameover);
+  field_.GetCells(gameover);
   if (!gameover) field_.PlaceApple(apple_);
+  field_.PlaceFieldAndNext(gi, gameover);
 }
 
 void Snake::ProcessEvent(Event) { Move(MovementAction::Action, false); }
 
+void Snake::Save(Checkpoint& checkpoint, void* body) {
+  std::scoped_lock<std::mutex> lock(mtx_);
+  const BoardSize size = field_.GetSize();
+  std::memcpy(checkpoint.gen, &gen_, sizeof(gen_));
+  checkpoint.width = size.width;
+  checkpoint.length = size.length;
+  checkpoint.apple = field_.GetCellNum(apple_);
+  checkpoint.body_size = snake_body_.Size();
+  checkpoint.direction = static_cast<MovementAction>(direction_);
+  checkpoint.got_apple = got_apple_;
+  auto* out = static_cast<unsigned char*>(body);
+  for (int i{}; i < snake_body_.Size(); ++i) {
+    const std::int32_t cell = snake_body_.At(i);
+    std::memcpy(out + i * sizeof(cell), &cell, sizeof(cell));
+  }
+}
+
+static bool IsAdjacent(int a, int b, int width) {
+  const int dy = a / width - b / width, dx = a % width - b % width;
+  return std::abs(dy) + std::abs(dx) == 1;
+}
+
+bool Snake::IsValid(const Checkpoint& checkpoint, const void* body) {
+  const BoardSize size{checkpoint.width, checkpoint.length};
+  bool valid = size.IsValid() && checkpoint.apple >= 0 &&
+               checkpoint.apple < size.Cells() && checkpoint.body_size > 0 &&
+               checkpoint.body_size <= size.Cells() &&
+               checkpoint.direction >= MovementAction::Left &&
+               checkpoint.direction < MovementAction::Action &&
+               checkpoint.got_apple <= 1;
+  // Each cell once, each next to the one before, as Field and SnakeBody keep
+  // one bit per cell. The apple is on a free cell unless there is none left
+  std::vector<bool> taken(valid ? size.Cells() : 0);
+  const auto* in = static_cast<const unsigned char*>(body);
+  std::int32_t prev{};
+  for (int i{}; valid && i < checkpoint.body_size; ++i) {
+    std::int32_t cell;
+    std::memcpy(&cell, in + i * sizeof(cell), sizeof(cell));
+    valid = cell >= 0 && cell < size.Cells() && !taken[cell] &&
+            (i == 0 || IsAdjacent(prev, cell, size.width));
+    if (valid) taken[cell] = true;
+    prev = cell;
+  }
+  return valid &&
+         (!taken[checkpoint.apple] || checkpoint.body_size == size.Cells());
+}
+
+void Snake::Restore(const Checkpoint& checkpoint, const void* body) {
+  std::scoped_lock<std::mutex> lock(mtx_);
+  const BoardSize size{checkpoint.width, checkpoint.length};
+  if (size == field_.GetSize()) {
+    field_.Clear();
+    snake_body_.Clear();
+  } else {
+    field_ = Field(size);
+    snake_body_ = SnakeBody(size.Cells());
+  }
+  const auto* in = static_cast<const unsigned char*>(body);
+  for (int i{}; i < checkpoint.body_size; ++i) {
+    std::int32_t cell;
+    std::memcpy(&cell, in + i * sizeof(cell), sizeof(cell));
+    AddSnakeSeg(field_.GetCell(cell));
+  }
+  std::memcpy(&gen_, checkpoint.gen, sizeof(gen_));
+  apple_ = field_.GetCell(checkpoint.apple);
+  got_apple_ = checkpoint.got_apple == 1;
+  direction_ = checkpoint.direction;
+}
+
 };  // namespace brick_game
@@ -0,0 +1,165 @@
+#include "snake_batch.h"
+
+#include <algorithm>
+
+#include "stats_keeper.h"
+
+namespace brick_game {
+
+namespace {
+
+constexpr int kLeft = static_cast<int>(MovementAction::Left);
+constexpr int kRight = static_cast<int>(MovementAction::Right);
+constexpr int kUp = static_cast<int>(MovementAction::Up);
+constexpr int kDown = static_cast<int>(MovementAction::Down);
+constexpr int kAction = static_cast<int>(MovementAction::Action);
+// Left and Right, Up and Down differ in the lowest bit only
+static_assert((kLeft ^ 1) == kRight && (kUp ^ 1) == kDown);
+
+// First pass of StepAll(): validates the turn of every game and finds its
+// next head, checked against the walls and the apple. Comparisons combine
+// with & and |, never && and ||, so the loop has no control flow and is
+// vectorized; the arrays are restrict so it needs no overlap checks either
+void PlanMoves(const int games, const BoardSize size,
+               const MovementAction* __restrict action,
+               const std::int32_t* __restrict head_y,
+               const std::int32_t* __restrict head_x,
+               const std::int32_t* __restrict apple,
+               const std::uint8_t* __restrict alive,
+               std::int8_t* __restrict directions,
+               std::int32_t* __restrict nexts, std::uint8_t* __restrict moves,
+               std::uint8_t* __restrict eats) {
+  const int width = size.width;
+  const unsigned columns = size.width, rows = size.length;
+  for (int g = 0; g < games; ++g) {
+    const int requested = static_cast<int>(action[g]);
+    const int direction = directions[g];
+    const int keep = requested == kAction;
+    const int valid = keep | (requested != (direction ^ 1));
+    const int turn = keep ? direction : requested;
+    const int y = head_y[g] + (turn == kDown) - (turn == kUp);
+    const int x = head_x[g] + (turn == kRight) - (turn == kLeft);
+    const int inside = (static_cast<unsigned>(y) < rows) &
+                       (static_cast<unsigned>(x) < columns);
+    const std::int32_t next = inside ? y * width + x : -1;
+    const int move = alive[g] & valid;
+    moves[g] = static_cast<std::uint8_t>(move);
+    nexts[g] = next;
+    eats[g] = next == apple[g];
+    directions[g] = static_cast<std::int8_t>(move ? turn : direction);
+  }
+}
+
+}  // namespace
+
+SnakeBatch::SnakeBatch(std::span<const std::uint32_t> seeds, BoardSize size)
+    : size_(size),
+      cells_(size.Cells()),
+      words_((size.Cells() + kWordBits - 1) / kWordBits) {
+  const std::size_t games = seeds.size();
+  head_y_.resize(games);
+  head_x_.resize(games);
+  direction_.resize(games);
+  apple_.resize(games);
+  score_.resize(games);
+  level_.resize(games);
+  length_.resize(games);
+  tail_.resize(games);
+  got_apple_.resize(games);
+  alive_.resize(games);
+  gen_.resize(games);
+  body_.resize(games * cells_);
+  occupancy_.resize(games * words_);
+  next_.resize(games);
+  moves_.resize(games);
+  eats_.resize(games);
+  for (std::size_t game{}; game < games; ++game)
+    Reset(static_cast<int>(game), seeds[game]);
+}
+
+// Same start as Snake::InitializeSnake() and Snake::SpawnApple()
+void SnakeBatch::Reset(int game, std::uint32_t seed) {
+  gen_[game] = RandomEngine{seed};
+  std::fill_n(Occupancy(game), words_, 0);
+  length_[game] = tail_[game] = 0;
+  score_[game] = 0;
+  level_[game] = 1;
+  got_apple_[game] = 0;
+  alive_[game] = 1;
+  direction_[game] = kUp;
+  const int start_y = size_.length / 2, start_x = size_.width / 2;
+  for (int y : {start_y + 2, start_y + 1, start_y, start_y - 1})
+    PushHead(game, y * size_.width + start_x);
+  head_y_[game] = start_y - 1;
+  head_x_[game] = start_x;
+  SpawnApple(game);
+}
+
+void SnakeBatch::StepAll(std::span<const MovementAction> actions) {
+  const int games = GetGames();
+  const int width = size_.width;
+  PlanMoves(games, size_, actions.data(), head_y_.data(), head_x_.data(),
+            apple_.data(), alive_.data(), direction_.data(), next_.data(),
+            moves_.data(), eats_.data());
+  // Games that move: the body collision, the tail and the rare apple
+  for (int g = 0; g < games; ++g) {
+    if (!moves_[g]) continue;
+    const std::int32_t next = next_[g];
+    std::uint64_t* occupancy = Occupancy(g);
+    if (next < 0 || occupancy[next / kWordBits] & CellBit(next)) {
+      alive_[g] = 0;
+      continue;
+    }
+    head_y_[g] = next / width;
+    head_x_[g] = next % width;
+    PushHead(g, next);
+    if (!got_apple_[g]) {
+      const std::int32_t tail = Body(g)[tail_[g]];
+      occupancy[tail / kWordBits] &= ~CellBit(tail);
+      tail_[g] = tail_[g] + 1 == cells_ ? 0 : tail_[g] + 1;
+      --length_[g];
+    } else {
+      got_apple_[g] = 0;
+    }
+    if (eats_[g]) {
+      got_apple_[g] = 1;
+      SpawnApple(g);
+      // What StatsKeeper does on Event::ScorePoint
+      score_[g] += kScoreStep;
+      if (score_[g] % kLevelTreshold == 0 && level_[g] < kMaxLevel)
+        ++level_[g];
+    }
+  }
+}
+
+Cell SnakeBatch::GetApple(int game) const {
+  return {apple_[game] / size_.width, apple_[game] % size_.width};
+}
+
+void SnakeBatch::GetCells(int game, std::uint8_t* cells) const {
+  const std::uint64_t* occupancy = Occupancy(game);
+  const std::uint8_t body = alive_[game] ? Green : Damaged;
+  const std::uint8_t empty = Empty;
+  for (int n{}; n < cells_; ++n)
+    cells[n] = occupancy[n / kWordBits] & CellBit(n) ? body : empty;
+  if (alive_[game]) cells[apple_[game]] = Red;
+}
+
+void SnakeBatch::PushHead(int game, std::int32_t cell) {
+  const int slot = (tail_[game] + length_[game]) % cells_;
+  Body(game)[slot] = cell;
+  ++length_[game];
+  Occupancy(game)[cell / kWordBits] |= CellBit(cell);
+}
+
+void SnakeBatch::SpawnApple(int game) {
+  const int free_cells = cells_ - length_[game];
+  int n{};
+  if (free_cells) {
+    std::uniform_int_distribution<int> dist(0, free_cells - 1);
+    n = dist(gen_[game]);
+  }
+  apple_[game] = NthFreeCell(Occupancy(game), cells_, n);
+}
+
+};  // namespace brick_game
@@ -1,21 +1,66 @@
 #include "snake_model.h"
 
-brick_game::SnakeModel::SnakeModel()
+#include <cstring>
+#include <new>
+
+#include "checkpoint.h"
+
+namespace brick_game {
+
+namespace {
+
+// Fixed part of a snake checkpoint, followed by the cells of the body
+template <typename Timer>
+struct ModelCheckpoint {
+  CheckpointHeader_t header;
+  Snake::Checkpoint snake;
+  typename StatsKeeper<SimpleFileStorage>::Checkpoint stats;
+  typename Timer::Checkpoint timer;
+  State state;
+  std::uint64_t ticks_before_reset;
+};
+
+constexpr std::size_t kBodyCellSize = sizeof(std::int32_t);
+
+bool IsValidState(State s) {
+  return s == State::Start || s == State::Pause || s == State::Gameover ||
+         s == State::Moving;
+}
+
+}  // namespace
+
+template <IsMoveTimer Timer>
+BasicSnakeModel<Timer>::BasicSnakeModel()
     : mediator_(std::make_shared<SnakeMediator>()),
       fsm_(std::make_shared<SnakeFSM>(mediator_)),
       snake_(std::make_shared<Snake>(mediator_)),
       stats_keeper_(
           std::make_shared<StatsKeeper<SimpleFileStorage>>(mediator_)),
-      move_timer_(std::make_shared<MoveTimer>(mediator_)) {
+      move_timer_(std::make_shared<Timer>(mediator_)),
+      frame_publisher_(std::make_shared<FramePublisher>(
+          mediator_, [this] { PublishFrame(); })),
+      frames_(fbCreate(FIELD_WIDTH, FIELD_LENGTH), &fbDestroy) {
+  if (!frames_) throw std::bad_alloc();
   Connect();
+  PublishFrame();
+}
+
+template <IsMoveTimer Timer>
+BasicSnakeModel<Timer>::BasicSnakeModel(std::uint32_t seed)
+    : BasicSnakeModel() {
+  Seed(seed);
 }
 
-void brick_game::SnakeModel::TakeMoveAction(MovementAction a) {
+template <IsMoveTimer Timer>
+void BasicSnakeModel<Timer>::TakeMoveAction(MovementAction a) {
   if (fsm_->IsState(State::Moving)) {
     snake_->Move(a);
+    PublishFrame();
   }
 }
-void brick_game::SnakeModel::TakeGameControlAction(ControlAction a) {
+
+template <IsMoveTimer Timer>
+void BasicSnakeModel<Timer>::TakeGameControlAction(ControlAction a) {
   if (fsm_->IsCorrectStateForExecution(a)) {
     switch (a) {
       case ControlAction::Start:
@@ -33,9 +78,12 @@ void brick_game::SnakeModel::TakeGameControlAction(ControlAction a) {
       default:
         break;
     }
+    PublishFrame();
   }
 }
-GameInfo_t brick_game::SnakeModel::GetCurrentStateCopy() {
+
+template <IsMoveTimer Timer>
+GameInfo_t BasicSnakeModel<Timer>::GetCurrentStateCopy() {
   GameInfo_t info{};
   snake_->PlaceGameInfo(info, fsm_->IsState(State::Gameover));
   stats_keeper_->PlaceStats(info, fsm_->IsState(State::Gameover));
@@ -43,10 +91,79 @@ GameInfo_t brick_game::SnakeModel::GetCurrentStateCopy() {
   return info;
 }
 
-void brick_game::SnakeModel::Connect() {
+template <IsMoveTimer Timer>
+bool BasicSnakeModel<Timer>::Seed(std::uint32_t seed) {
+  if (!fsm_->IsState(State::Start)) return false;
+  *snake_ = Snake(mediator_, RandomEngine{seed}, snake_->GetBoardSize());
+  PublishFrame();
+  return true;
+}
+
+template <IsMoveTimer Timer>
+bool BasicSnakeModel<Timer>::Resize(int width, int length) {
+  const BoardSize size{width, length};
+  if (!fsm_->IsState(State::Start) || !size.IsValid()) return false;
+  *snake_ = Snake(mediator_, snake_->GetRandomEngine(), size);
+  PublishFrame();
+  return true;
+}
+
+template <IsMoveTimer Timer>
+std::size_t BasicSnakeModel<Timer>::Save(void* buffer, std::size_t size)
+  requires CheckpointTimer<Timer>
+{
+  const std::size_t needed = sizeof(ModelCheckpoint<Timer>) +
+                             snake_->GetBodySize() * kBodyCellSize;
+  if (buffer && size >= needed) {
+    ModelCheckpoint<Timer> checkpoint{};
+    ckInitHeader(&checkpoint.header, CheckpointSnake, sizeof(checkpoint),
+                 needed);
+    auto* bytes = static_cast<unsigned char*>(buffer);
+    snake_->Save(checkpoint.snake, bytes + sizeof(checkpoint));
+    checkpoint.stats = stats_keeper_->Save();
+    checkpoint.timer = move_timer_->Save();
+    checkpoint.state = fsm_->GetState();
+    checkpoint.ticks_before_reset = ticks_before_reset_;
+    std::memcpy(buffer, &checkpoint, sizeof(checkpoint));
+  }
+  return needed;
+}
+
+template <IsMoveTimer Timer>
+bool BasicSnakeModel<Timer>::Restore(const void* buffer, std::size_t size)
+  requires CheckpointTimer<Timer>
+{
+  ModelCheckpoint<Timer> checkpoint;
+  if (!ckCheckHeader(buffer, size, CheckpointSnake, sizeof(checkpoint)))
+    return false;
+  std::memcpy(&checkpoint, buffer, sizeof(checkpoint));
+  const auto* body = static_cast<const unsigned char*>(buffer) +
+                     sizeof(checkpoint);
+  if (checkpoint.header.size !=
+          sizeof(checkpoint) + checkpoint.snake.body_size * kBodyCellSize ||
+      !IsValidState(checkpoint.state) ||
+      !Snake::IsValid(checkpoint.snake, body) ||
+      !StatsKeeper<SimpleFileStorage>::IsValid(checkpoint.stats) ||
+      !Timer::IsValid(checkpoint.timer))
+    return false;
+
+  // The timer comes last, entering the state may have paused it
+  fsm_->SetState(checkpoint.state);
+  snake_->Restore(checkpoint.snake, body);
+  stats_keeper_->Restore(checkpoint.stats);
+  move_timer_->Restore(checkpoint.timer);
+  ticks_before_reset_ = checkpoint.ticks_before_reset;
+  PublishFrame();
+  return true;
+}
+
+template <IsMoveTimer Timer>
+void BasicSnakeModel<Timer>::Connect() {
   fsm_->AddObserver(mediator_->GetObserverPtr());
   fsm_->SetState(State::Start);
   mediator_->AddSubscriber(snake_->weak_from_this(), Event::TimeToMove);
+  mediator_->AddSubscriber(frame_publisher_->weak_from_this(),
+                           Event::TimeToMove);
   mediator_->AddSubscriber(move_timer_->weak_from_this(), Event::NewLevel);
   mediator_->AddSubscriber(move_timer_->weak_from_this(), Event::PlayerMoved);
   mediator_->AddSubscriber(move_timer_->weak_from_this(), Event::Paused);
@@ -55,9 +172,34 @@ void brick_game::SnakeModel::Connect() {
   mediator_->AddSubscriber(fsm_->weak_from_this(), Event::GameOver);
 }
 
-void brick_game::SnakeModel::Reset() {
+template <IsMoveTimer Timer>
+void BasicSnakeModel<Timer>::Reset() {
   fsm_->SetState(State::Start);
-  *snake_ = Snake(mediator_);
+  *snake_ = Snake(mediator_, snake_->GetRandomEngine(),
+                  snake_->GetBoardSize());
   *stats_keeper_ = StatsKeeper<SimpleFileStorage>(mediator_);
-  *move_timer_ = MoveTimer(mediator_);
-}
\ No newline at end of file
+  ticks_before_reset_ += move_timer_->GetTicks();
+  *move_timer_ = Timer(mediator_);
+}
+
+// Frames have a single writer, the lock orders the input and timer threads.
+// Never called from inside Snake::Move, which holds the snake's own lock
+template <IsMoveTimer Timer>
+void BasicSnakeModel<Timer>::PublishFrame() {
+  std::scoped_lock<std::mutex> lock(publish_mtx_);
+  const bool gameover = fsm_->IsState(State::Gameover);
+  const BoardSize size = snake_->GetBoardSize();
+  GameInfo_t info{};
+  stats_keeper_->PlaceStats(info, gameover);
+  if (fsm_->IsState(State::Pause)) info.pause = 1;
+  fbResize(frames_.get(), size.width, size.length);
+  snake_->VisitCells(gameover, [this, &info](const std::uint8_t* cells) {
+    fbPublishCells(frames_.get(), cells, nullptr, &info);
+  });
+}
+
+template struct BasicSnakeModel<MoveTimer>;
+template struct BasicSnakeModel<ScheduledTimer>;
+template struct BasicSnakeModel<StepTimer>;
+
+}  // namespace brick_game
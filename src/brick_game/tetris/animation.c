@@ -0,0 +1,59 @@
+#include "animation.h"
+
+#include "game_instance.h"
+#include "tetromino_mover.h"
+
+#define NSEC_PER_SEC 1000000000L
+
+static Animation_t* getMutableAnimation() {
+  return &getCurrentGame()->data.animation;
+}
+
+static void scheduleStep(Animation_t* animation) {
+  timespec_get(&animation->due, TIME_UTC);
+  animation->due.tv_nsec += ANIMATION_SLEEP_TIME;
+  if (animation->due.tv_nsec >= NSEC_PER_SEC) {
+    animation->due.tv_nsec -= NSEC_PER_SEC;
+    ++animation->due.tv_sec;
+  }
+}
+
+void startAnimation(const BrickAnimation_t kind, const int steps) {
+  if (!isHeadless()) {
+    Animation_t* animation = getMutableAnimation();
+    *animation = (Animation_t){.kind = kind, .steps = steps};
+    scheduleStep(animation);
+  }
+}
+
+void stopAnimation() { *getMutableAnimation() = (Animation_t){0}; }
+
+bool isAnimating() { return getAnimation()->kind != NoAnimation; }
+
+bool isAnimationDue() {
+  bool due = false;
+  const Animation_t* animation = getAnimation();
+  if (animation->kind != NoAnimation) {
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    due = now.tv_sec > animation->due.tv_sec ||
+          (now.tv_sec == animation->due.tv_sec &&
+           now.tv_nsec >= animation->due.tv_nsec);
+  }
+  return due;
+}
+
+int nextAnimationStep() {
+  Animation_t* animation = getMutableAnimation();
+  scheduleStep(animation);
+  return ++animation->step;
+}
+
+const Animation_t* getAnimation() { return &getCurrentGame()->data.animation; }
+
+int getAnimationProgress() {
+  const Animation_t* animation = getAnimation();
+  return animation->kind != NoAnimation && animation->steps > 0
+             ? animation->step * 100 / animation->steps
+             : 0;
+}
@@ -0,0 +1,175 @@
+#include "bitboard.h"
+
+#include <string.h>
+#include <threads.h>
+
+#include "game_instance.h"
+#include "tetromino_inner.h"
+
+#define WORD_BITS 64
+
+/**
+ * @brief One shape in one rotation as row masks around its center
+ */
+typedef struct {
+  int top;                      ///< Row of mask[0] relative to the center
+  int left;                     ///< Column of bit 0 relative to the center
+  int span;                     ///< Columns covered
+  int rows;                     ///< Mask rows used
+  uint64_t mask[TOTAL_PIECES];  ///< Column bits of each row
+} ShapeMask_t;
+
+static ShapeMask_t shape_masks[TOTAL_TETROMINOS][TOTAL_ROTATIONS];
+static once_flag shape_masks_once = ONCE_FLAG_INIT;
+
+// Derived from the same piece coordinates and rotation math as the cell
+// engine, so both engines agree on every shape
+static void buildShapeMasks() {
+  for (int s = 0; s < TOTAL_TETROMINOS; ++s) {
+    for (int r = 0; r < TOTAL_ROTATIONS; ++r) {
+      const Tetromino_t tetromino = {.shape = s + FIELD_STATES, .rotation = r};
+      Coordinates_t pieces[TOTAL_PIECES];
+      int top = 0, bottom = 0, left = 0, right = 0;
+      for (int i = 0; i < TOTAL_PIECES; ++i) {
+        pieces[i] = getTetrPieceCoords(&tetromino, i);
+        if (!i || pieces[i].y < top) top = pieces[i].y;
+        if (!i || pieces[i].y > bottom) bottom = pieces[i].y;
+        if (!i || pieces[i].x < left) left = pieces[i].x;
+        if (!i || pieces[i].x > right) right = pieces[i].x;
+      }
+      ShapeMask_t* mask = &shape_masks[s][r];
+      *mask = (ShapeMask_t){.top = top,
+                            .left = left,
+                            .span = right - left + 1,
+                            .rows = bottom - top + 1};
+      for (int i = 0; i < TOTAL_PIECES; ++i)
+        mask->mask[pieces[i].y - top] |= (uint64_t)1 << (pieces[i].x - left);
+    }
+  }
+}
+
+static const ShapeMask_t* getShapeMask(const Tetromino_t* tetromino) {
+  call_once(&shape_masks_once, buildShapeMasks);
+  return &shape_masks[SHAPE_NUMBER(tetromino->shape)][tetromino->rotation];
+}
+
+static Bitboard_t* getBitboard() { return &getCurrentGame()->bitboard; }
+
+// Bitboard sized for the current field, reallocated if the size changed
+static Bitboard_t* getSizedBitboard() {
+  Bitboard_t* board = getBitboard();
+  if (board->width != getFieldWidth() || board->length != getFieldLength())
+    initBitboard();
+  return board;
+}
+
+static inline uint64_t* getRow(const Bitboard_t* board, const int row) {
+  return board->rows + (size_t)row * board->words;
+}
+
+int initBitboard() {
+  int exit_code = EXIT_SUCCESS;
+  Bitboard_t* board = getBitboard();
+  const int width = getFieldWidth(), length = getFieldLength();
+  const int words = (width + WORD_BITS - 1) / WORD_BITS;
+  if (board->width != width || board->length != length) {
+    free(board->rows);
+    board->rows = calloc((size_t)words * length, sizeof(uint64_t));
+    if (board->rows) {
+      board->words = words;
+      board->width = width;
+      board->length = length;
+    } else {
+      *board = (Bitboard_t){0};
+      exit_code = EXIT_FAILURE;
+    }
+  } else
+    memset(board->rows, 0, (size_t)words * length * sizeof(uint64_t));
+  return exit_code;
+}
+
+void freeBitboard() {
+  Bitboard_t* board = getBitboard();
+  free(board->rows);
+  *board = (Bitboard_t){0};
+}
+
+void rebuildBitboard(FieldCell_t** field) {
+  if (initBitboard() == EXIT_SUCCESS) {
+    const Bitboard_t* board = getBitboard();
+    for (int i = 0; i < board->length; ++i) {
+      uint64_t* row = getRow(board, i);
+      for (int j = 0; j < board->width; ++j)
+        if (field[i][j] != Empty)
+          row[j / WORD_BITS] |= (uint64_t)1 << (j % WORD_BITS);
+    }
+  }
+}
+
+// Bits of a shape row placed at column: in its own word and, if it crosses a
+// word boundary, in the next one. In-bounds pieces never cross the last word
+static inline void placeMaskRow(const uint64_t mask, const int column,
+                                uint64_t* low, uint64_t* high) {
+  const int shift = column % WORD_BITS;
+  *low = mask << shift;
+  *high = shift ? mask >> (WORD_BITS - shift) : 0;
+}
+
+bool collidesOnBitboard(const Tetromino_t* tetromino) {
+  const Bitboard_t* board = getSizedBitboard();
+  const ShapeMask_t* shape = getShapeMask(tetromino);
+  const int column = tetromino->centerCoords.x + shape->left;
+  const int top = tetromino->centerCoords.y + shape->top;
+  bool collides = column < 0 || column + shape->span > board->width ||
+                  top + shape->rows > board->length;
+  for (int i = 0; i < shape->rows && !collides && board->rows; ++i) {
+    if (top + i >= 0) {
+      const uint64_t* words = getRow(board, top + i) + column / WORD_BITS;
+      uint64_t low, high;
+      placeMaskRow(shape->mask[i], column, &low, &high);
+      collides = (words[0] & low) || (high && (words[1] & high));
+    }
+  }
+  return collides;
+}
+
+void settleOnBitboard(const Tetromino_t* tetromino) {
+  const Bitboard_t* board = getSizedBitboard();
+  const ShapeMask_t* shape = getShapeMask(tetromino);
+  const int column = tetromino->centerCoords.x + shape->left;
+  const int top = tetromino->centerCoords.y + shape->top;
+  for (int i = 0; i < shape->rows && board->rows; ++i) {
+    if (top + i >= 0 && top + i < board->length) {
+      uint64_t* words = getRow(board, top + i) + column / WORD_BITS;
+      uint64_t low, high;
+      placeMaskRow(shape->mask[i], column, &low, &high);
+      words[0] |= low;
+      if (high) words[1] |= high;
+    }
+  }
+}
+
+bool isBitboardRowFull(const int row) {
+  const Bitboard_t* board = getSizedBitboard();
+  bool full = board->rows != NULL;
+  const uint64_t* words = full ? getRow(board, row) : NULL;
+  for (int w = 0; w + 1 < board->words && full; ++w)
+    if (words[w] != ~(uint64_t)0) full = false;
+  if (full) {
+    const int last_bits = board->width - (board->words - 1) * WORD_BITS;
+    const uint64_t last = last_bits == WORD_BITS
+                              ? ~(uint64_t)0
+                              : ((uint64_t)1 << last_bits) - 1;
+    full = words[board->words - 1] == last;
+  }
+  return full;
+}
+
+void removeBitboardRows(const int row, const int combo) {
+  const Bitboard_t* board = getSizedBitboard();
+  if (board->rows) {
+    const size_t row_size = (size_t)board->words * sizeof(uint64_t);
+    memmove(getRow(board, combo), board->rows, row_size * (row - combo));
+    memset(board->rows, 0, row_size * combo);
+  }
+}
@@ -1,22 +1,21 @@
 
 #include "controller.h"
 
+#include "game_checkpoint.h"
 #include "game_data.h"
+#include "game_instance.h"
 #include "highscore_keeper.h"
 #include "movement_queue.h"
+#include "palette.h"
 #include "tetromino_mover.h"
 
 #define MOVEMENT_POS 3
 #define IS_MOVE_CMD(x) ((int)(x) >= MOVEMENT_POS)
 #define MOVEMENT_NUM(x) (((int)x) - MOVEMENT_POS)
-#define NO_MOVEMENT -1
-
-typedef struct {
-  MoveCommand_t movement;
-  Command_t command;
-} Actions_t;
 
 void initGame(void);
+void seedFromClock(void);
+void recordInput(const UserAction_t action, const bool hold);
 void pauseGame(void);
 void terminateGame(void);
 void switch_pause_state(void);
@@ -28,9 +27,9 @@ void execAction();
 void processMovement(MoveCommand_t move);
 
 GameInfo_t updateCurrentState() {
-  static GameInfo_t state = {0};
+  GameInfo_t state = getCurrentGame()->legacy.info;
   if (mtx_trylock(getMutex()) == thrd_success) {
-    state = *getGameInfo();
+    state = exportGameInfo();
     mtx_unlock(getMutex());
   }
   return state;
@@ -38,20 +37,178 @@ GameInfo_t updateCurrentState() {
 
 void userInput(const UserAction_t action, const bool hold) {
   if (action >= Start && action <= Action) {
+    recordInput(action, hold);
     Controller_t* controller = getController();
     controller->getAction(action, hold);
     controller->exec();
   }
 }
 
+void setGameSeed(const unsigned int seed) {
+  if (isGameState(StartState)) seedRandom(seed);
+}
+
+int setFieldSize(const int width, const int length) {
+  int exit_code = EXIT_FAILURE;
+  if (isGameState(StartState) && width >= FIELD_MIN_SIZE &&
+      width <= FIELD_MAX_SIZE && length >= FIELD_MIN_SIZE &&
+      length <= FIELD_MAX_SIZE) {
+    setBoardSize(width, length);
+    exit_code = EXIT_SUCCESS;
+  }
+  return exit_code;
+}
+
+void getFieldSize(int* width, int* length) {
+  if (width) *width = getFieldWidth();
+  if (length) *length = getFieldLength();
+}
+
 Controller_t* getController() {
   static Controller_t controller = {getAction, execAction};
   return &controller;
 }
 
-Actions_t* getControllerActions() {
-  static Actions_t actions = {.movement.move = NO_MOVEMENT, .command = NULL};
-  return &actions;
+Actions_t* getControllerActions() { return &getCurrentGame()->actions; }
+
+BrickGame_t* bg_create(const BrickGameConfig_t* config) {
+  BrickGame_t* game = calloc(1, sizeof(BrickGame_t));
+  if (game) {
+    initGameInstance(game);
+    BrickGame_t* previous = bindGame(game);
+    if (config && (config->width || config->length) &&
+        setFieldSize(config->width ? config->width : FIELD_WIDTH,
+                     config->length ? config->length : FIELD_LENGTH) !=
+            EXIT_SUCCESS) {
+      free(game);
+      game = NULL;
+    } else if (config) {
+      if (config->seeded) seedRandom(config->seed);
+      // Animations play in real time, stepped games have none
+      setHeadless(config->headless || config->stepped);
+      setScheduled(config->scheduled);
+      setStepped(config->stepped);
+    }
+    bindGame(previous);
+  }
+  return game;
+}
+
+void bg_destroy(BrickGame_t* game) {
+  if (game && game != getDefaultGame()) {
+    BrickGame_t* previous = bindGame(game);
+    if (!isGameState(StartState)) terminateGame();
+    replayFinish(game->recorder, atomic_load(&game->ticks));
+    freeGameData();
+    bindGame(previous);
+    free(game);
+  }
+}
+
+void bg_input(BrickGame_t* game, const UserAction_t action, bool hold) {
+  BrickGame_t* previous = bindGame(game);
+  userInput(action, hold);
+  bindGame(previous);
+}
+
+GameInfo_t bg_state(BrickGame_t* game) {
+  BrickGame_t* previous = bindGame(game);
+  GameInfo_t state = updateCurrentState();
+  bindGame(previous);
+  return state;
+}
+
+void bg_field_size(BrickGame_t* game, int* width, int* length) {
+  BrickGame_t* previous = bindGame(game);
+  getFieldSize(width, length);
+  bindGame(previous);
+}
+
+int bg_record(BrickGame_t* game, const char* path) {
+  int exit_code = EXIT_FAILURE;
+  BrickGame_t* previous = bindGame(game);
+  if (!path || isGameState(StartState)) {
+    replayFinish(game->recorder, atomic_load(&game->ticks));
+    game->recorder = NULL;
+    exit_code = EXIT_SUCCESS;
+  }
+  if (path && exit_code == EXIT_SUCCESS) {
+    seedFromClock();
+    ReplayHeader_t header = {.seed = getRandomState()};
+    getFieldSize(&header.width, &header.length);
+    game->recorder = replayCreate(path, &header, atomic_load(&game->ticks));
+    if (!game->recorder) exit_code = EXIT_FAILURE;
+  }
+  bindGame(previous);
+  return exit_code;
+}
+
+uint64_t bg_generation(BrickGame_t* game) {
+  return fbGeneration(atomic_load(&game->frames));
+}
+
+const BrickFrame_t* bg_frame(BrickGame_t* game) {
+  static const BrickFrame_t empty = {.dirty_count = -1};
+  FrameBuffer_t* frames = atomic_load(&game->frames);
+  return frames ? fbAcquire(frames) : &empty;
+}
+
+uint64_t bg_wait(BrickGame_t* game, uint64_t seen, int timeout_ms) {
+  return fbWait(atomic_load(&game->frames), seen, timeout_ms);
+}
+
+// Rows being cleared are marked Volatile and look damaged; each shape keeps
+// the colour it has always been drawn in
+const BrickPalette_t* bg_palette() {
+  static const BrickPalette_t palette = {
+      .entries = {
+          [Empty] = PALETTE_COLOR(160, 160, 164, TermDefault),
+          [Settled] = PALETTE_COLOR(255, 255, 255, TermWhite),
+          [Volatile] = {.red = 255,
+                        .alpha = 128,
+                        .term_color = TermWhite,
+                        .glyph = "$ "},
+          [I_shape] = PALETTE_COLOR(255, 0, 0, TermRed),
+          [O_shape] = PALETTE_COLOR(255, 0, 255, TermMagenta),
+          [T_shape] = PALETTE_COLOR(0, 255, 0, TermGreen),
+          [S_shape] = PALETTE_COLOR(0, 255, 255, TermBlue),
+          [Z_shape] = PALETTE_COLOR(255, 255, 0, TermYellow),
+          [J_shape] = PALETTE_COLOR(255, 165, 0, TermYellow),
+          [L_shape] = PALETTE_COLOR(0, 0, 255, TermBlue),
+      }};
+  return &palette;
+}
+
+BrickGame_t* bg_default() { return getDefaultGame(); }
+
+void bg_step(BrickGame_t* game, int ticks) {
+  BrickGame_t* previous = bindGame(game);
+  if (isStepped()) stepGameLogic(ticks);
+  bindGame(previous);
+}
+
+size_t bg_save(BrickGame_t* game, void* buffer, size_t size) {
+  BrickGame_t* previous = bindGame(game);
+  const size_t needed = isStepped() ? saveGame(buffer, size) : 0;
+  bindGame(previous);
+  return needed;
+}
+
+int bg_restore(BrickGame_t* game, const void* buffer, size_t size) {
+  BrickGame_t* previous = bindGame(game);
+  const uint64_t ticks = atomic_load(&game->ticks);
+  const int exit_code =
+      isStepped() ? restoreGame(buffer, size) : EXIT_FAILURE;
+  if (exit_code == EXIT_SUCCESS) {
+    replayFinish(game->recorder, ticks);
+    game->recorder = NULL;
+  }
+  bindGame(previous);
+  return exit_code;
+}
+
+int bg_scheduler_workers(int workers) {
+  return schedSetSharedWorkers(workers) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 void getAction(const int action, const int hold) {
@@ -89,21 +246,33 @@ void execAction() {
 
 void processMovement(MoveCommand_t move_cmd) {
   if (isGameState(RunState)) {
-    if (mtx_lock(getMutex()) == thrd_success) {
-      pushQueue(move_cmd);
-      mtx_unlock(getMutex());
-    }
+    pushQueue(move_cmd);
+    if (isStepped()) drainGameLogic();
   }
 }
 
+void recordInput(const UserAction_t action, const bool hold) {
+  BrickGame_t* game = getCurrentGame();
+  if (game->recorder)
+    replayRecord(game->recorder, atomic_load(&game->ticks), action, hold);
+}
+
+void seedFromClock() {
+  // Games started within the same second still get distinct sequences
+  if (!isRandomSeeded())
+    seedRandom((uint32_t)time(NULL) ^ (uint32_t)(uintptr_t)getCurrentGame());
+}
+
 void initGame() {
-  srand(time(NULL));
+  seedFromClock();
   initQueue();
   if (initGameData() == EXIT_SUCCESS) {
     setGameState(RunState);
+    publishFrame();
     if (initTetrominoMover() == EXIT_FAILURE) {
       cleanUpData();
       setGameState(StartState);
+      publishFrame();
     }
   }
 }
@@ -111,6 +280,7 @@ void initGame() {
 void pauseGame() {
   if (mtx_lock(getMutex()) == thrd_success) {
     switch_pause_state();
+    publishFrame();
     mtx_unlock(getMutex());
   }
 }
@@ -123,6 +293,7 @@ void switch_pause_state() {
     if (cnd_broadcast(getPauseCondition()) == thrd_success) {
       setGameState(RunState);
       getGameInfo()->pause = false;
+      if (isScheduled()) wakeGameLoop();
     }
   }
 }
@@ -132,7 +303,9 @@ void terminateGame() {
     if (isGameState(PauseState)) switch_pause_state();
     setGameState(EndState);
     mtx_unlock(getMutex());
+    wakeGameLoop();
     waitTetrominoMoverEnd();
     cleanUpData();
+    publishFrame();
   }
 }
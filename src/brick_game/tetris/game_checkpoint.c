@@ -0,0 +1,152 @@
+#include "game_checkpoint.h"
+
+#include <string.h>
+
+#include "checkpoint.h"
+#include "game_data.h"
+#include "game_instance.h"
+#include "movement_queue.h"
+#include "tetromino_inner.h"
+
+static bool areCellsValid(const FieldCell_t* cells, const size_t count) {
+  bool valid = true;
+  for (size_t i = 0; i < count && valid; ++i)
+    valid = cells[i] < CellStateCount;
+  return valid;
+}
+
+static bool isShape(const int shape) {
+  return shape >= I_shape && shape <= L_shape;
+}
+
+// Same bounds as canMove(): on the board or above its top, where pieces
+// spawn. Every shape has a cell at its center, so the center is checked
+// first and the offsets cannot overflow
+static bool isPieceOnBoard(const Tetromino_t* current, const int width,
+                           const int length) {
+  const Coordinates_t center = current->centerCoords;
+  bool inside = center.x >= 0 && center.x < width && center.y >= START_Y &&
+                center.y < length;
+  const Coordinates_t* offsets = inside ? getPieceOffsets(current) : NULL;
+  for (int i = 0; i < TOTAL_PIECES && inside; ++i) {
+    const int x = center.x + offsets[i].x, y = center.y + offsets[i].y;
+    inside = x >= 0 && x < width && y < length;
+  }
+  return inside;
+}
+
+// Everything is checked before anything is changed. A started game always
+// has a piece in play and a next shape, and being stepped it never animates
+static bool readCheckpoint(const void* buffer, const size_t size,
+                           TetrisCheckpoint_t* checkpoint) {
+  if (!ckCheckHeader(buffer, size, CheckpointTetris, sizeof(*checkpoint)))
+    return false;
+  memcpy(checkpoint, buffer, sizeof(*checkpoint));
+  const int width = checkpoint->width, length = checkpoint->length;
+  const Tetromino_t* current = &checkpoint->current;
+  return width >= FIELD_MIN_SIZE && width <= FIELD_MAX_SIZE &&
+         length >= FIELD_MIN_SIZE && length <= FIELD_MAX_SIZE &&
+         checkpoint->header.size ==
+             sizeof(*checkpoint) + (size_t)width * length &&
+         checkpoint->state >= StartState && checkpoint->state <= EndState &&
+         (current->shape == Empty || isShape(current->shape)) &&
+         (checkpoint->state == StartState ||
+          (isShape(current->shape) &&
+           isShape(checkpoint->next[CHECKPOINT_NEXT_CELLS - 1]))) &&
+         current->rotation >= 0 && current->rotation < TOTAL_ROTATIONS &&
+         (current->shape == Empty ||
+          isPieceOnBoard(current, width, length)) &&
+         checkpoint->animation.kind == NoAnimation &&
+         checkpoint->rng_seeded <= 1 &&
+         areCellsValid(checkpoint->next, CHECKPOINT_NEXT_CELLS) &&
+         areCellsValid((const FieldCell_t*)buffer + sizeof(*checkpoint),
+                       (size_t)width * length);
+}
+
+size_t saveGame(void* buffer, const size_t size) {
+  const int width = getFieldWidth(), length = getFieldLength();
+  const size_t needed = sizeof(TetrisCheckpoint_t) + (size_t)width * length;
+  if (buffer && size >= needed) {
+    // A game that is not started has no mutex and nothing to guard
+    const bool started = !isGameState(StartState);
+    if (started) mtx_lock(getMutex());
+    const GameRuntimeData_t* data = &getCurrentGame()->data;
+    TetrisCheckpoint_t checkpoint = {.width = width,
+                                     .length = length,
+                                     .state = data->state,
+                                     .score = data->info.score,
+                                     .high_score = data->info.high_score,
+                                     .level = data->info.level,
+                                     .speed = data->info.speed,
+                                     .pause = data->info.pause,
+                                     .current = data->current,
+                                     .animation = data->animation,
+                                     .rng_state = data->rng_state,
+                                     .rng_seeded = data->rng_seeded,
+                                     .ticks = atomic_load(
+                                         &getCurrentGame()->ticks)};
+    ckInitHeader(&checkpoint.header, CheckpointTetris, sizeof(checkpoint),
+                 needed);
+    if (data->info.next)
+      memcpy(checkpoint.next, data->info.next[0], sizeof(checkpoint.next));
+    FieldCell_t* cells = (FieldCell_t*)buffer + sizeof(checkpoint);
+    if (data->info.field)
+      memcpy(cells, data->info.field[0], (size_t)width * length);
+    else
+      memset(cells, Empty, (size_t)width * length);
+    memcpy(buffer, &checkpoint, sizeof(checkpoint));
+    if (started) mtx_unlock(getMutex());
+  }
+  return needed;
+}
+
+// A running game of the same size is overwritten in place; otherwise the
+// game is ended and started again at the size of the checkpoint
+int restoreGame(const void* buffer, const size_t size) {
+  TetrisCheckpoint_t checkpoint;
+  if (!readCheckpoint(buffer, size, &checkpoint)) return EXIT_FAILURE;
+  const int width = checkpoint.width, length = checkpoint.length;
+  if (!isGameState(StartState) &&
+      (checkpoint.state == StartState || width != getFieldWidth() ||
+       length != getFieldLength()))
+    cleanUpData();
+  setBoardSize(width, length);
+  initQueue();
+  int exit_code = EXIT_SUCCESS;
+  if (isGameState(StartState) && checkpoint.state != StartState)
+    exit_code = initGameData();
+
+  const bool started = checkpoint.state != StartState;
+  if (exit_code == EXIT_SUCCESS) {
+    GameRuntimeData_t* data = &getCurrentGame()->data;
+    const FieldCell_t* cells = (const FieldCell_t*)buffer + sizeof(checkpoint);
+    if (started) {
+      mtx_lock(getMutex());
+      data->state = checkpoint.state;
+      data->info.score = checkpoint.score;
+      data->info.high_score = checkpoint.high_score;
+      data->info.level = checkpoint.level;
+      data->info.speed = checkpoint.speed;
+      data->info.pause = checkpoint.pause;
+      data->current = checkpoint.current;
+      data->animation = checkpoint.animation;
+      memcpy(data->info.next[0], checkpoint.next, sizeof(checkpoint.next));
+      memcpy(data->info.field[0], cells, (size_t)width * length);
+#ifdef TETRIS_BITBOARD
+      // The bitboard only holds settled cells, so the piece is lifted off
+      if (data->current.shape != Empty)
+        removeTetromino(&data->current, data->info.field);
+      rebuildBitboard(data->info.field);
+      if (data->current.shape != Empty)
+        putTetromino(&data->current, data->info.field);
+#endif
+    }
+    data->rng_state = checkpoint.rng_state;
+    data->rng_seeded = checkpoint.rng_seeded == 1;
+    atomic_store(&getCurrentGame()->ticks, checkpoint.ticks);
+    publishFrame();
+    if (started) mtx_unlock(getMutex());
+  } else
+    publishFrame();
+  return exit_code;
+}
@@ -2,26 +2,18 @@
 
 #include <string.h>
 
+#include "game_instance.h"
 #include "highscore_keeper.h"
 #include "tetromino.h"
 
-typedef struct {
-  GameInfo_t info;
-  GameState_t state;
-  mtx_t mutex;
-  cnd_t pause_cond;
-  Threads_t threads;
-} GameRuntimeData_t;
+FieldCell_t** initField();
+FieldCell_t** initNextShape();
 
-int** initField();
-int** initNextShape();
+GameRuntimeData_t* getGameData() { return &getCurrentGame()->data; }
 
-GameRuntimeData_t* getGameData() {
-  static GameRuntimeData_t info;
-  return &info;
-}
+FieldStorage_t* getFieldStorage() { return &getCurrentGame()->field; }
 
-GameInfo_t* getGameInfo() { return &getGameData()->info; }
+PackedGameInfo_t* getGameInfo() { return &getGameData()->info; }
 
 Threads_t* getThreads() { return &getGameData()->threads; }
 
@@ -29,6 +21,19 @@ mtx_t* getMutex() { return &getGameData()->mutex; }
 
 cnd_t* getPauseCondition() { return &getGameData()->pause_cond; }
 
+cnd_t* getWorkCondition() { return &getGameData()->work_cond; }
+
+mtx_t* getWorkMutex() { return &getGameData()->work_mutex; }
+
+void wakeGameLoop() {
+  if (isScheduled())
+    schedWake(schedShared(), getThreads()->logic);
+  else if (mtx_lock(getWorkMutex()) == thrd_success) {
+    cnd_broadcast(getWorkCondition());
+    mtx_unlock(getWorkMutex());
+  }
+}
+
 GameState_t getGameState() { return getGameData()->state; }
 
 bool isGameState(const GameState_t state) {
@@ -37,6 +42,56 @@ bool isGameState(const GameState_t state) {
 
 void setGameState(GameState_t state) { getGameData()->state = state; }
 
+void setBoardSize(const int width, const int length) {
+  GameRuntimeData_t* data = getGameData();
+  data->width = width;
+  data->length = length;
+}
+
+int getFieldWidth() {
+  const int width = getGameData()->width;
+  return width ? width : FIELD_WIDTH;
+}
+
+int getFieldLength() {
+  const int length = getGameData()->length;
+  return length ? length : FIELD_LENGTH;
+}
+
+void seedRandom(const uint32_t seed) {
+  GameRuntimeData_t* data = getGameData();
+  data->rng_state = seed;
+  data->rng_seeded = true;
+}
+
+void setScheduled(const bool scheduled) {
+  getGameData()->scheduled = scheduled;
+}
+
+bool isScheduled() { return getGameData()->scheduled; }
+
+void setStepped(const bool stepped) { getGameData()->stepped = stepped; }
+
+bool isStepped() { return getGameData()->stepped; }
+
+Tetromino_t* getCurrentTetromino() { return &getGameData()->current; }
+
+void setHeadless(const bool headless) { getGameData()->headless = headless; }
+
+bool isHeadless() { return getGameData()->headless; }
+
+bool isRandomSeeded() { return getGameData()->rng_seeded; }
+
+uint32_t getRandomState() { return getGameData()->rng_state; }
+
+// splitmix32: a single word of state, good enough spread for picking shapes
+uint32_t nextRandom() {
+  uint32_t z = (getGameData()->rng_state += 0x9E3779B9u);
+  z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+  z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+  return z ^ (z >> 16);
+}
+
 int initGameData() {
   int exit_code = EXIT_SUCCESS;
   GameRuntimeData_t* data = getGameData();
@@ -45,39 +100,166 @@ int initGameData() {
   data->info.next = initNextShape();
   data->info.speed = 1;
   data->info.level = 1;
-  if (mtx_init(&data->mutex, mtx_plain) != thrd_success)
+  if (!data->info.field)
+    exit_code = EXIT_FAILURE;
+#ifdef TETRIS_BITBOARD
+  else if (initBitboard() != EXIT_SUCCESS)
+    exit_code = EXIT_FAILURE;
+#endif
+  else if (mtx_init(&data->mutex, mtx_plain) != thrd_success)
     exit_code = EXIT_FAILURE;
   else if (cnd_init(&data->pause_cond) != thrd_success) {
     mtx_destroy(&data->mutex);
     exit_code = EXIT_FAILURE;
+  } else if (mtx_init(&data->work_mutex, mtx_plain) != thrd_success) {
+    cnd_destroy(&data->pause_cond);
+    mtx_destroy(&data->mutex);
+    exit_code = EXIT_FAILURE;
+  } else if (cnd_init(&data->work_cond) != thrd_success) {
+    mtx_destroy(&data->work_mutex);
+    cnd_destroy(&data->pause_cond);
+    mtx_destroy(&data->mutex);
+    exit_code = EXIT_FAILURE;
   }
   return exit_code;
 }
 
-int** initField() {
-  static int field[FIELD_LENGTH * FIELD_WIDTH] = {0};
-  static int* field_ptrs[FIELD_LENGTH];
-  for (int i = 0; i < FIELD_LENGTH; ++i) {
-    field_ptrs[i] = field + (i * FIELD_WIDTH);
+FieldCell_t** initField() {
+  FieldStorage_t* storage = getFieldStorage();
+  const int width = getFieldWidth(), length = getFieldLength();
+  if (storage->width != width || storage->length != length) {
+    free(storage->cells);
+    free(storage->rows);
+    storage->cells = calloc((size_t)width * length, sizeof(FieldCell_t));
+    storage->rows = malloc(length * sizeof(FieldCell_t*));
+    if (!storage->cells || !storage->rows) {
+      free(storage->cells);
+      free(storage->rows);
+      *storage = (FieldStorage_t){0};
+      return NULL;
+    }
+    storage->width = width;
+    storage->length = length;
+    for (int i = 0; i < length; ++i) {
+      storage->rows[i] = storage->cells + (i * width);
+    }
   }
-  return field_ptrs;
+  return storage->rows;
 }
 
-int** initNextShape() {
-  static int next_arr[NEXTF_LENGTH * NEXTF_WIDTH + 1];
-  static int* next[NEXTF_LENGTH];
+FieldCell_t** initNextShape() {
+  NextStorage_t* storage = &getCurrentGame()->next;
   for (int i = 0; i < NEXTF_LENGTH; ++i) {
-    next[i] = next_arr + (i * NEXTF_WIDTH);
+    storage->rows[i] = storage->cells + (i * NEXTF_WIDTH);
   }
-  setRandomShape(next);
-  return next;
+  setRandomShape(storage->rows);
+  return storage->rows;
+}
+
+void publishFrame() {
+  BrickGame_t* game = getCurrentGame();
+  FrameBuffer_t* frames = atomic_load(&game->frames);
+  const int width = getFieldWidth(), length = getFieldLength();
+  if (!frames) {
+    frames = fbCreate(width, length);
+    atomic_store(&game->frames, frames);
+  } else
+    fbResize(frames, width, length);
+  if (frames) {
+    const PackedGameInfo_t* info = getGameInfo();
+    const GameInfo_t stats = {.score = info->score,
+                              .high_score = info->high_score,
+                              .level = info->level,
+                              .speed = info->speed,
+                              .pause = info->pause};
+    fbSetAnimation(frames, getAnimation()->kind, getAnimationProgress());
+    fbPublishCells(frames, info->field ? info->field[0] : NULL,
+                   info->next ? info->next[0] : NULL, &stats);
+  }
+}
+
+static bool reserveLegacyTables(LegacyView_t* legacy, const int width,
+                                const int length) {
+  if (legacy->width != width || legacy->length != length) {
+    free(legacy->cells);
+    free(legacy->rows);
+    legacy->cells = malloc((size_t)width * length * sizeof(int));
+    legacy->rows = malloc(length * sizeof(int*));
+    if (!legacy->cells || !legacy->rows) {
+      free(legacy->cells);
+      free(legacy->rows);
+      legacy->cells = NULL;
+      legacy->rows = NULL;
+      legacy->width = legacy->length = 0;
+    } else {
+      legacy->width = width;
+      legacy->length = length;
+      for (int i = 0; i < length; ++i)
+        legacy->rows[i] = legacy->cells + (i * width);
+    }
+  }
+  for (int i = 0; i < NEXTF_LENGTH; ++i)
+    legacy->next_rows[i] = legacy->next_cells + (i * NEXTF_WIDTH);
+  return legacy->rows != NULL;
+}
+
+GameInfo_t exportGameInfo() {
+  BrickGame_t* game = getCurrentGame();
+  LegacyView_t* legacy = &game->legacy;
+  const PackedGameInfo_t* info = getGameInfo();
+  const uint64_t generation = fbGeneration(atomic_load(&game->frames));
+  if (legacy->generation != generation || !generation) {
+    const int width = getFieldWidth(), length = getFieldLength();
+    legacy->info = (GameInfo_t){.score = info->score,
+                                .high_score = info->high_score,
+                                .level = info->level,
+                                .speed = info->speed,
+                                .pause = info->pause};
+    if (info->field && reserveLegacyTables(legacy, width, length)) {
+      const size_t count = (size_t)width * length;
+      for (size_t i = 0; i < count; ++i) legacy->cells[i] = info->field[0][i];
+      for (int i = 0; i < NEXTF_LENGTH * NEXTF_WIDTH; ++i)
+        legacy->next_cells[i] = info->next[0][i];
+      legacy->info.field = legacy->rows;
+      legacy->info.next = legacy->next_rows;
+    }
+    legacy->generation = generation;
+  }
+  return legacy->info;
+}
+
+void freeGameData() {
+  FieldStorage_t* storage = getFieldStorage();
+  free(storage->cells);
+  free(storage->rows);
+  *storage = (FieldStorage_t){0};
+  freeBitboard();
+  LegacyView_t* legacy = &getCurrentGame()->legacy;
+  free(legacy->cells);
+  free(legacy->rows);
+  *legacy = (LegacyView_t){0};
+  fbDestroy(atomic_exchange(&getCurrentGame()->frames, NULL));
 }
 
 void cleanUpData() {
   GameRuntimeData_t* data = getGameData();
+  cnd_destroy(&data->work_cond);
+  mtx_destroy(&data->work_mutex);
   cnd_destroy(&data->pause_cond);
   mtx_destroy(&data->mutex);
-  memset(data->info.field[0], 0, FIELD_LENGTH * FIELD_WIDTH * sizeof(int));
-  memset(data->info.next[0], 0, (NEXTF_LENGTH * NEXTF_WIDTH + 1) * sizeof(int));
+  const FieldStorage_t* storage = getFieldStorage();
+  if (storage->cells)
+    memset(storage->cells, 0,
+           (size_t)storage->width * storage->length * sizeof(FieldCell_t));
+  memset(data->info.next[0], 0,
+         (NEXTF_LENGTH * NEXTF_WIDTH + 1) * sizeof(FieldCell_t));
+  const GameRuntimeData_t kept = *data;
   memset(data, 0, sizeof(GameRuntimeData_t));
+  data->rng_state = kept.rng_state;
+  data->rng_seeded = kept.rng_seeded;
+  data->width = kept.width;
+  data->length = kept.length;
+  data->headless = kept.headless;
+  data->scheduled = kept.scheduled;
+  data->stepped = kept.stepped;
 }
\ No newline at end of file
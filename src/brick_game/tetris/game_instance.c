@@ -0,0 +1,23 @@
+#include "game_instance.h"
+
+static _Thread_local BrickGame_t* current_game = NULL;
+
+BrickGame_t* getDefaultGame() {
+  static BrickGame_t game = {.actions.movement.move = NO_MOVEMENT};
+  return &game;
+}
+
+BrickGame_t* getCurrentGame() {
+  return current_game ? current_game : getDefaultGame();
+}
+
+BrickGame_t* bindGame(BrickGame_t* game) {
+  BrickGame_t* previous = current_game;
+  current_game = game;
+  return previous;
+}
+
+void initGameInstance(BrickGame_t* game) {
+  game->actions.movement.move = NO_MOVEMENT;
+  game->actions.command = NULL;
+}
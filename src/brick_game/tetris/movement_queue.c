@@ -1,45 +1,94 @@
 
 #include "movement_queue.h"
 
+#include <stddef.h>
 #include <string.h>
 
-#define QUEUE_SIZE 5
+#include "game_instance.h"
 
-/**
- * @brief Internal queue structure (circular buffer).
- */
-typedef struct {
-  MoveCommand_t movements[QUEUE_SIZE];  ///< Array storing queued commands.
-  int first;                            ///< Index of the oldest command.
-  int last;  ///< Index where the next command will be inserted.
-} MovementQueue_t;
+_Static_assert(QUEUE_SIZE > 1 && (QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0,
+               "QUEUE_SIZE must be a power of two");
 
-MovementQueue_t* getQueue() {
-  static MovementQueue_t queue;
-  return &queue;
-}
+#define HELD_BIT(action) (1u << ((unsigned)(action).move % 32u))
+
+MovementQueue_t* getQueue() { return &getCurrentGame()->queue; }
 
 void initQueue() {
   MovementQueue_t* queue = getQueue();
   memset(queue, 0, sizeof(MovementQueue_t));
+  for (size_t i = 0; i < QUEUE_SIZE; ++i)
+    atomic_init(&queue->slots[i].sequence, i);
+}
+
+static inline QueueSlot_t* getSlot(MovementQueue_t* queue, const size_t pos) {
+  return &queue->slots[pos & (QUEUE_SIZE - 1)];
 }
 
 MoveCommand_t popQueue() {
   MovementQueue_t* queue = getQueue();
-  const MoveCommand_t action = queue->movements[queue->first];
-  queue->first = (queue->first + 1) % QUEUE_SIZE;
+  MoveCommand_t action = {0};
+  QueueSlot_t* slot = getSlot(queue, queue->head);
+  if (atomic_load_explicit(&slot->sequence, memory_order_acquire) ==
+      queue->head + 1) {
+    action = slot->command;
+    atomic_store_explicit(&slot->sequence, queue->head + QUEUE_SIZE,
+                          memory_order_release);
+    ++queue->head;
+    if (action.hold)
+      atomic_fetch_and(&queue->held, ~HELD_BIT(action));
+  }
   return action;
 }
 
-void pushQueue(const MoveCommand_t action) {
+// Claims a slot for a producer, false if the ring is full
+static bool claimSlot(MovementQueue_t* queue, size_t* pos) {
+  bool claimed = false, full = false;
+  *pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  while (!claimed && !full) {
+    const size_t sequence = atomic_load_explicit(
+        &getSlot(queue, *pos)->sequence, memory_order_acquire);
+    const ptrdiff_t turn = (ptrdiff_t)(sequence - *pos);
+    if (!turn)
+      claimed = atomic_compare_exchange_weak_explicit(
+          &queue->tail, pos, *pos + 1, memory_order_relaxed,
+          memory_order_relaxed);
+    else if (turn < 0)
+      full = true;
+    else
+      *pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  }
+  return claimed;
+}
+
+QueueResult_t pushQueue(const MoveCommand_t action) {
   MovementQueue_t* queue = getQueue();
-  queue->movements[queue->last] = action;
-  queue->last = (queue->last + 1) % QUEUE_SIZE;
-  if (queue->first == queue->last)
-    queue->first = (queue->first + 1) % QUEUE_SIZE;
+  QueueResult_t result = QueuePushed;
+  size_t pos = 0;
+  if (action.hold &&
+      (atomic_fetch_or(&queue->held, HELD_BIT(action)) & HELD_BIT(action))) {
+    result = QueueCoalesced;
+  } else if (!claimSlot(queue, &pos)) {
+    if (action.hold) atomic_fetch_and(&queue->held, ~HELD_BIT(action));
+    result = QueueDropped;
+  } else {
+    QueueSlot_t* slot = getSlot(queue, pos);
+    slot->command = action;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+    // Pairs with the fence in the game loop: either it sees the command or
+    // this sees it waiting
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&queue->waiting, memory_order_relaxed))
+      wakeGameLoop();
+  }
+  return result;
 }
 
 bool isEmptyQueue() {
-  const MovementQueue_t* queue = getQueue();
-  return queue->last == queue->first;
+  MovementQueue_t* queue = getQueue();
+  return atomic_load_explicit(&getSlot(queue, queue->head)->sequence,
+                              memory_order_acquire) != queue->head + 1;
+}
+
+void flushQueue() {
+  while (!isEmptyQueue()) popQueue();
 }
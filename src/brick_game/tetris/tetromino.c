@@ -1,6 +1,8 @@
 
 #include "tetromino.h"
 
+#include "animation.h"
+#include "bitboard.h"
 #include "tetromino_inner.h"
 
 Movement_t getMovement(const MoveCommand_t cmd) {
@@ -11,7 +13,7 @@ Movement_t getMovement(const MoveCommand_t cmd) {
   return movements[(int)cmd.hold][cmd.move];
 }
 
-int moveDown(GameInfo_t* info, Tetromino_t* current) {
+int moveDown(PackedGameInfo_t* info, Tetromino_t* current) {
   int result = EXIT_SUCCESS;
   Tetromino_t new = *current;
   ++new.centerCoords.y;
@@ -28,16 +30,33 @@ int moveDown(GameInfo_t* info, Tetromino_t* current) {
   return result;
 }
 
-int smashDown(GameInfo_t* info, Tetromino_t* tetromino) {
-  while (moveDown(info, tetromino) == EXIT_SUCCESS) {
-    SLEEP(ANIMATION_SLEEP_TIME);
+// Rows the piece can fall before it lands
+static int getDropDistance(PackedGameInfo_t* info, const Tetromino_t* current) {
+  int distance = 0;
+  Tetromino_t probe = *current;
+  removeTetromino(current, info->field);
+  for (++probe.centerCoords.y; canMove(&probe, info->field);
+       ++probe.centerCoords.y)
+    ++distance;
+  putTetromino(current, info->field);
+  return distance;
+}
+
+int smashDown(PackedGameInfo_t* info, Tetromino_t* tetromino) {
+  if (isHeadless()) {
+    while (moveDown(info, tetromino) == EXIT_SUCCESS) {
+    }
+    flushQueue();
+  } else {
+    // The game loop plays the rest of the fall, see stepAnimation()
+    const int distance = getDropDistance(info, tetromino);
+    moveDown(info, tetromino);
+    startAnimation(DropAnimation, distance + DROP_LANDING_STEPS);
   }
-  SLEEP(ANIMATION_SLEEP_TIME * 5);
-  flushQueue();
   return EXIT_SUCCESS;
 }
 
-int moveLeft(GameInfo_t* info, Tetromino_t* current) {
+int moveLeft(PackedGameInfo_t* info, Tetromino_t* current) {
   int result = EXIT_SUCCESS;
   Tetromino_t new = *current;
   --new.centerCoords.x;
@@ -50,7 +69,7 @@ int moveLeft(GameInfo_t* info, Tetromino_t* current) {
   return result;
 }
 
-int moveRight(GameInfo_t* info, Tetromino_t* current) {
+int moveRight(PackedGameInfo_t* info, Tetromino_t* current) {
   int result = EXIT_SUCCESS;
   Tetromino_t new = *current;
   ++new.centerCoords.x;
@@ -63,7 +82,7 @@ int moveRight(GameInfo_t* info, Tetromino_t* current) {
   return result;
 }
 
-int rotate(GameInfo_t* info, Tetromino_t* current) {
+int rotate(PackedGameInfo_t* info, Tetromino_t* current) {
   int result = EXIT_SUCCESS;
   Tetromino_t new = *current;
   if (current->shape != I_shape)
@@ -81,7 +100,7 @@ int rotate(GameInfo_t* info, Tetromino_t* current) {
   return result;
 }
 
-Tetromino_t getNextTetromino(int** next) {
+Tetromino_t getNextTetromino(FieldCell_t** next) {
   Tetromino_t new = {.shape = NEXT_SHAPE_NUM(next),
                      .rotation = Angle0,
                      .centerCoords = {.x = START_X, .y = START_Y}};
@@ -89,7 +108,7 @@ Tetromino_t getNextTetromino(int** next) {
   return new;
 }
 
-void setRandomShape(int** next) {
+void setRandomShape(FieldCell_t** next) {
   Tetromino_t new = {.centerCoords = {1, 1},
                      .shape = NEXT_SHAPE_NUM(next),
                      .rotation = Angle0};
@@ -99,36 +118,58 @@ void setRandomShape(int** next) {
   putTetromino(&new, next);
 }
 
-void removeTetromino(const Tetromino_t* current, int** field) {
+void removeTetromino(const Tetromino_t* current, FieldCell_t** field) {
   setFieldCellState(field, Empty, current);
 }
 
-void putTetromino(const Tetromino_t* new, int** field) {
-  for (int i = 0; i < TOTAL_PIECES; i++) {
-    setFieldCellState(field, new->shape, new);
-  }
+void putTetromino(const Tetromino_t* new, FieldCell_t** field) {
+  setFieldCellState(field, new->shape, new);
 }
 
-void settleTetromino(const Tetromino_t* current, int** field) {
+void settleTetromino(const Tetromino_t* current, FieldCell_t** field) {
   setFieldCellState(field, Settled, current);
+#ifdef TETRIS_BITBOARD
+  settleOnBitboard(current);
+#endif
 }
 
-void setFieldCellState(int** field, const FieldCellState_t state,
+void setFieldCellState(FieldCell_t** field, const FieldCellState_t state,
                        const Tetromino_t* tetromino) {
+  const Coordinates_t* offsets = getPieceOffsets(tetromino);
+  const Coordinates_t center = tetromino->centerCoords;
   for (int i = 0; i < TOTAL_PIECES; i++) {
-    Coordinates_t coords = getTetrPieceCoords(tetromino, i);
-    if (coords.y >= 0) field[coords.y][coords.x] = state;
+    if (center.y + offsets[i].y >= 0)
+      field[center.y + offsets[i].y][center.x + offsets[i].x] = state;
   }
 }
 
+const Coordinates_t* getPieceOffsets(const Tetromino_t* tetromino) {
+  static const Coordinates_t
+      offsets[TOTAL_TETROMINOS][TOTAL_ROTATIONS][TOTAL_PIECES] = {
+          ALL_ROTATIONS(I_SHAPE), NO_ROTATIONS(O_SHAPE),
+          ALL_ROTATIONS(T_SHAPE), ALL_ROTATIONS(S_SHAPE),
+          ALL_ROTATIONS(Z_SHAPE), ALL_ROTATIONS(J_SHAPE),
+          ALL_ROTATIONS(L_SHAPE)};
+  return offsets[SHAPE_NUMBER(tetromino->shape)][tetromino->rotation];
+}
+
+// Column shifts tried in order when the rotated shape does not fit, indexed
+// by the rotation being entered. The long I piece needs two columns
+const int* getWallKicks(const Tetromino_t* tetromino) {
+  static const int kicks[TOTAL_TETROMINOS][TOTAL_ROTATIONS][TOTAL_KICKS] = {
+      {{0, 1, -2}, {0, 2, -1}, {0, 1, -1}, {0, 1, -1}},
+      {{0, 1, -1}, {0, 1, -1}, {0, 1, -1}, {0, 1, -1}},
+      {{0, 1, -1}, {0, 1, -1}, {0, 1, -1}, {0, 1, -1}},
+      {{0, 1, -1}, {0, 1, -1}, {0, 1, -1}, {0, 1, -1}},
+      {{0, 1, -1}, {0, 1, -1}, {0, 1, -1}, {0, 1, -1}},
+      {{0, 1, -1}, {0, 1, -1}, {0, 1, -1}, {0, 1, -1}},
+      {{0, 1, -1}, {0, 1, -1}, {0, 1, -1}, {0, 1, -1}}};
+  return kicks[SHAPE_NUMBER(tetromino->shape)][tetromino->rotation];
+}
+
 Coordinates_t getTetrPieceCoords(const Tetromino_t* tetromino,
                                  const int piece) {
-  static int tetr_pieces_coords[TOTAL_TETROMINOS][TOTAL_PIECES][2] = {
-      I_SHAPE, O_SHAPE, T_SHAPE, S_SHAPE, Z_SHAPE, J_SHAPE, L_SHAPE};
-  Coordinates_t coords = {
-      .y = tetr_pieces_coords[SHAPE_NUMBER(tetromino->shape)][piece][0],
-      .x = tetr_pieces_coords[SHAPE_NUMBER(tetromino->shape)][piece][1]};
-  coords = applyRotation(tetromino, coords);
+  Coordinates_t coords = getPieceOffsets(tetromino)[piece];
   coords.x += tetromino->centerCoords.x;
   coords.y += tetromino->centerCoords.y;
   return coords;
@@ -153,12 +194,20 @@ Coordinates_t applyRotation(const Tetromino_t* tetromino,
   return piece_coords;
 }
 
-bool canMove(const Tetromino_t* new, int** field) {
+#ifdef TETRIS_BITBOARD
+bool canMove(const Tetromino_t* new, FieldCell_t** field) {
+  (void)field;
+  return !collidesOnBitboard(new);
+}
+#else
+bool canMove(const Tetromino_t* new, FieldCell_t** field) {
   bool result = true;
-  for (int i = 0; i < 4; i++) {
-    Coordinates_t currPiece = getTetrPieceCoords(new, i);
-    if (currPiece.x < 0 || currPiece.x >= FIELD_WIDTH ||
-        currPiece.y >= FIELD_LENGTH) {
+  const Coordinates_t* offsets = getPieceOffsets(new);
+  const int width = getFieldWidth(), length = getFieldLength();
+  for (int i = 0; i < TOTAL_PIECES && result; i++) {
+    const Coordinates_t currPiece = {.x = new->centerCoords.x + offsets[i].x,
+                                     .y = new->centerCoords.y + offsets[i].y};
+    if (currPiece.x < 0 || currPiece.x >= width || currPiece.y >= length) {
       result = false;
     } else if (currPiece.y >= 0 && field[currPiece.y][currPiece.x] != Empty) {
       result = false;
@@ -166,20 +215,15 @@ bool canMove(const Tetromino_t* new, int** field) {
   }
   return result;
 }
-
-bool canRotate(Tetromino_t* new, int** field) {
-  int result = true;
-  Coordinates_t saved = new->centerCoords;
-  if (!canMove(new, field)) {
-    ++new->centerCoords.x;
-    if (new->shape == I_shape&& new->rotation == Angle90) ++new->centerCoords.x;
-    if (!canMove(new, field)) {
-      new->centerCoords = saved;
-      --new->centerCoords.x;
-      if (new->shape == I_shape&& new->rotation == Angle0)
-        --new->centerCoords.x;
-      if (!canMove(new, field)) result = false;
-    }
+#endif
+
+bool canRotate(Tetromino_t* new, FieldCell_t** field) {
+  bool result = false;
+  const int center_x = new->centerCoords.x;
+  const int* kicks = getWallKicks(new);
+  for (int i = 0; i < TOTAL_KICKS && !result; ++i) {
+    new->centerCoords.x = center_x + kicks[i];
+    result = canMove(new, field);
   }
   return result;
 }
\ No newline at end of file
@@ -1,14 +1,56 @@
 #include "tetromino_mover.h"
 
+#include "animation.h"
+#include "bitboard.h"
+#include "game_instance.h"
+#include "tetromino_inner.h"
 #include "tetromino_mover_inner.h"
 
+static int64_t logicTask(void* arg);
+static int64_t gravityTask(void* arg);
+
+// The first tetromino is shown before any tick, so the preview is up at once
+static int dealFirstTetromino() {
+  int exit_code = EXIT_FAILURE;
+  if (mtx_lock(getMutex()) == thrd_success) {
+    *getCurrentTetromino() = getNextTetromino(getGameInfo()->next);
+    publishFrame();
+    mtx_unlock(getMutex());
+    exit_code = EXIT_SUCCESS;
+  }
+  return exit_code;
+}
+
+// Scheduled mode: two timers on the shared scheduler instead of two threads
+static int startTimers() {
+  int exit_code = EXIT_FAILURE;
+  Threads_t* threads = getThreads();
+  Scheduler_t* sched = schedShared();
+  if (sched && dealFirstTetromino() == EXIT_SUCCESS) {
+    // The first run only parks the timer, arming the wake up on input
+    threads->logic = schedAdd(sched, logicTask, getCurrentGame(), 0);
+    threads->gravity =
+        schedAdd(sched, gravityTask, getCurrentGame(),
+                 GET_SLEEP_DURATION(getGameInfo()->speed));
+    if (threads->logic && threads->gravity)
+      exit_code = EXIT_SUCCESS;
+    else
+      waitTetrominoMoverEnd();
+  }
+  return exit_code;
+}
+
 int initTetrominoMover() {
   int exit_code = EXIT_SUCCESS;
   Threads_t* threads = getThreads();
-  if (thrd_create(&threads->main, mainGameLoop, getGameInfo()) ==
-      thrd_success) {
-    if (thrd_create(&threads->scheduler, autoShiftScheduler, getGameInfo()) !=
-        thrd_success)
+  if (isStepped()) {
+    exit_code = dealFirstTetromino();
+  } else if (isScheduled()) {
+    exit_code = startTimers();
+  } else if (thrd_create(&threads->main, mainGameLoop, getCurrentGame()) ==
+             thrd_success) {
+    if (thrd_create(&threads->scheduler, autoShiftScheduler,
+                    getCurrentGame()) != thrd_success)
       exit_code = EXIT_FAILURE;
   } else
     exit_code = EXIT_FAILURE;
@@ -16,12 +58,20 @@ int initTetrominoMover() {
 }
 
 void waitTetrominoMoverEnd() {
-  const Threads_t* threads = getThreads();
-  thrd_join(threads->main, NULL);
-  thrd_join(threads->scheduler, NULL);
+  Threads_t* threads = getThreads();
+  if (isStepped()) {
+    // Nothing runs in the background
+  } else if (isScheduled()) {
+    schedCancel(schedShared(), threads->logic);
+    schedCancel(schedShared(), threads->gravity);
+    threads->logic = threads->gravity = 0;
+  } else {
+    thrd_join(threads->main, NULL);
+    thrd_join(threads->scheduler, NULL);
+  }
 }
 
-static inline void adjustSpeed(GameInfo_t* info) {
+static inline void adjustSpeed(PackedGameInfo_t* info) {
   info->speed =
       info->speed >= MAX_SPEED ? MAX_SPEED : info->score / LEVEL_THRESHOLD + 1;
   info->level = info->speed;
@@ -33,9 +83,43 @@ static inline void handlePause() {
   }
 }
 
-static inline bool isGameOver(const GameInfo_t* info) {
+// Marked rows are destroyed on the tick after they were marked, so a tick is
+// due even when no input is queued. Input waits for a running animation
+static inline bool hasWork(const PackedGameInfo_t* info) {
+  bool work = false;
+  if (isAnimating()) {
+    work = isAnimationDue();
+  } else {
+    work = !isEmptyQueue();
+    const int length = getFieldLength();
+    for (int i = 0; i < length && !work; ++i) {
+      if (info->field[i][0] == Volatile) work = true;
+    }
+  }
+  return work;
+}
+
+// Sleeps without the game mutex, so producers and readers never wait for it
+static inline void waitForWork(const PackedGameInfo_t* info) {
+  MovementQueue_t* queue = &getCurrentGame()->queue;
+  if (mtx_lock(getWorkMutex()) == thrd_success) {
+    atomic_store(&queue->waiting, true);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (isGameState(RunState) && !hasWork(info)) {
+      if (isAnimating())
+        cnd_timedwait(getWorkCondition(), getWorkMutex(), &getAnimation()->due);
+      else
+        cnd_wait(getWorkCondition(), getWorkMutex());
+    }
+    atomic_store(&queue->waiting, false);
+    mtx_unlock(getWorkMutex());
+  }
+}
+
+static inline bool isGameOver(const PackedGameInfo_t* info) {
   bool gameover = false;
-  for (int i = 0; i < FIELD_WIDTH && !gameover; ++i) {
+  const int width = getFieldWidth();
+  for (int i = 0; i < width && !gameover; ++i) {
     if (info->field[0][i] == Settled) gameover = true;
   }
   return gameover;
@@ -47,42 +131,84 @@ static inline int countReward(int combo) {
 }
 
 int mainGameLoop(void* arg) {
-  GameInfo_t* info = (GameInfo_t*)arg;
-  Tetromino_t tetromino = getNextTetromino(info->next);
+  bindGame((BrickGame_t*)arg);
+  PackedGameInfo_t* info = getGameInfo();
+  Tetromino_t* tetromino = getCurrentTetromino();
+  // The loop may sleep before its first tick
+  dealFirstTetromino();
 
   while (isGameState(RunState) || isGameState(PauseState)) {
+    waitForWork(info);
     if (mtx_lock(getMutex()) == thrd_success) {
-      tickGameLogic(info, &tetromino);
       handlePause();
+      if (isGameState(RunState) && tickGameLogic(info, tetromino))
+        publishFrame();
       mtx_unlock(getMutex());
     }
-    SLEEP(MAIN_SLEEP_TIME);
   }
   return EXIT_SUCCESS;
 }
 
-void tickGameLogic(GameInfo_t* info, Tetromino_t* tetromino) {
-  info->score += destroyMarkedRows(info, tetromino);
-  adjustSpeed(info);
-  if (!isEmptyQueue()) {
-    moveTetromino(info, tetromino);
-    markFilledRows(info->field);
-    if (isGameOver(info)) endGame(info);
+// Checks the field after the piece moved or landed
+static inline void finishMove(PackedGameInfo_t* info) {
+  markFilledRows(info->field);
+  if (isGameOver(info)) endGame(info);
+}
+
+bool tickGameLogic(PackedGameInfo_t* info, Tetromino_t* tetromino) {
+  bool changed = isAnimating() && stepAnimation(info, tetromino);
+  if (!isAnimating() && !isGameState(EndState)) {
+    const int reward = destroyMarkedRows(info, tetromino);
+    changed = changed || reward != 0;
+    info->score += reward;
+    adjustSpeed(info);
+    if (!isEmptyQueue()) {
+      moveTetromino(info, tetromino);
+      if (!isAnimating()) finishMove(info);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool stepAnimation(PackedGameInfo_t* info, Tetromino_t* tetromino) {
+  bool stepped = isAnimationDue();
+  if (stepped) {
+    const Animation_t* animation = getAnimation();
+    const int step = nextAnimationStep();
+    if (animation->kind == DropAnimation &&
+        step <= animation->steps - DROP_LANDING_STEPS)
+      moveDown(info, tetromino);
+    if (step >= animation->steps) {
+      const BrickAnimation_t kind = animation->kind;
+      stopAnimation();
+      if (kind == DropAnimation) {
+        // Input sent while the piece was falling is dropped, as before
+        flushQueue();
+        finishMove(info);
+      }
+    }
   }
+  return stepped;
 }
 
-void moveTetromino(GameInfo_t* info, Tetromino_t* tetromino) {
+void moveTetromino(PackedGameInfo_t* info, Tetromino_t* tetromino) {
   Movement_t movement = getMovement(popQueue());
   if (movement) movement(info, tetromino);
 }
 
 int autoShiftScheduler(void* arg) {
-  const GameInfo_t* info = (GameInfo_t*)arg;
+  bindGame((BrickGame_t*)arg);
+  const PackedGameInfo_t* info = getGameInfo();
   const MoveCommand_t down = MOVE_DOWN;
   while (isGameState(RunState) || isGameState(PauseState)) {
     SLEEP(GET_SLEEP_DURATION(info->speed));
-    if (mtx_lock(getMutex()) == thrd_success) {
+    // Like gravityTask(), a paused game gets no tick to catch up on
+    if (isGameState(RunState)) {
       pushQueue(down);
+      atomic_fetch_add(&getCurrentGame()->ticks, 1);
+    }
+    if (mtx_lock(getMutex()) == thrd_success) {
       handlePause();
       mtx_unlock(getMutex());
     }
@@ -90,33 +216,114 @@ int autoShiftScheduler(void* arg) {
   return EXIT_SUCCESS;
 }
 
-void markFilledRows(int** field) {
-  bool found_filled_rows = false;
-  for (int i = 0; i < FIELD_LENGTH; ++i) {
-    bool filled = true;
-    for (int j = 0; j < FIELD_WIDTH && filled; ++j) {
-      if (field[i][j] != Settled) filled = false;
+// Nanoseconds until the next animation step, 0 if it is due
+static int64_t getAnimationDelay() {
+  struct timespec now;
+  timespec_get(&now, TIME_UTC);
+  const struct timespec* due = &getAnimation()->due;
+  const int64_t delay = (int64_t)(due->tv_sec - now.tv_sec) * 1000000000 +
+                        (due->tv_nsec - now.tv_nsec);
+  return delay > 0 ? delay : 0;
+}
+
+// One iteration of mainGameLoop(), then the delay until the next one
+static int64_t logicTask(void* arg) {
+  BrickGame_t* previous = bindGame((BrickGame_t*)arg);
+  PackedGameInfo_t* info = getGameInfo();
+  MovementQueue_t* queue = &getCurrentGame()->queue;
+  int64_t next = SCHED_TASK_IDLE;
+  atomic_store(&queue->waiting, false);
+  if (mtx_lock(getMutex()) == thrd_success) {
+    if (isGameState(RunState) && hasWork(info) &&
+        tickGameLogic(info, getCurrentTetromino()))
+      publishFrame();
+    if (isGameState(RunState)) {
+      // Same handshake as waitForWork(): park only if no input slipped in
+      atomic_store(&queue->waiting, true);
+      atomic_thread_fence(memory_order_seq_cst);
+      if (hasWork(info))
+        next = 0;
+      else if (isAnimating())
+        next = getAnimationDelay();
     }
-    if (filled) {
+    mtx_unlock(getMutex());
+  }
+  bindGame(previous);
+  return next;
+}
+
+// One iteration of autoShiftScheduler(); pausing only skips the push
+static int64_t gravityTask(void* arg) {
+  BrickGame_t* previous = bindGame((BrickGame_t*)arg);
+  int64_t next = SCHED_TASK_IDLE;
+  if (isGameState(RunState) || isGameState(PauseState)) {
+    const MoveCommand_t down = MOVE_DOWN;
+    if (isGameState(RunState)) {
+      pushQueue(down);
+      atomic_fetch_add(&getCurrentGame()->ticks, 1);
+    }
+    next = GET_SLEEP_DURATION(getGameInfo()->speed);
+  }
+  bindGame(previous);
+  return next;
+}
+
+void drainGameLogic() {
+  PackedGameInfo_t* info = getGameInfo();
+  if (mtx_lock(getMutex()) == thrd_success) {
+    bool changed = false;
+    while (isGameState(RunState) && hasWork(info))
+      changed = tickGameLogic(info, getCurrentTetromino()) || changed;
+    if (changed) publishFrame();
+    mtx_unlock(getMutex());
+  }
+}
+
+void stepGameLogic(const int ticks) {
+  const MoveCommand_t down = MOVE_DOWN;
+  for (int i = 0; i < ticks && isGameState(RunState); ++i) {
+    pushQueue(down);
+    atomic_fetch_add(&getCurrentGame()->ticks, 1);
+    drainGameLogic();
+  }
+}
+
+static inline bool isRowFilled(FieldCell_t** field, const int row) {
+#ifdef TETRIS_BITBOARD
+  (void)field;
+  return isBitboardRowFull(row);
+#else
+  bool filled = true;
+  const int width = getFieldWidth();
+  for (int j = 0; j < width && filled; ++j) {
+    if (field[row][j] != Settled) filled = false;
+  }
+  return filled;
+#endif
+}
+
+void markFilledRows(FieldCell_t** field) {
+  bool found_filled_rows = false;
+  const int length = getFieldLength();
+  for (int i = 0; i < length; ++i) {
+    if (isRowFilled(field, i)) {
       markRow(field, i);
       found_filled_rows = true;
     }
   }
-  if (found_filled_rows) SLEEP(ANIMATION_SLEEP_TIME * 8);
+  if (found_filled_rows) startAnimation(ClearAnimation, CLEAR_STEPS);
 }
 
-void markRow(int** field, int row) {
-  static int marked_row[] = {
-      Volatile, Volatile, Volatile, Volatile, Volatile,
-      Volatile, Volatile, Volatile, Volatile, Volatile,
-  };
-  memcpy(field[row], marked_row, sizeof(marked_row));
+void markRow(FieldCell_t** field, int row) {
+  const int width = getFieldWidth();
+  for (int i = 0; i < width; ++i) field[row][i] = Volatile;
 }
 
-int destroyMarkedRows(GameInfo_t* info, const Tetromino_t* current) {
+int destroyMarkedRows(PackedGameInfo_t* info, const Tetromino_t* current) {
   int temp_combo = 0, combo = 0;
-  for (int i = 0; i <= FIELD_LENGTH; ++i) {
-    if (i != FIELD_LENGTH && info->field[i][0] == Volatile) {
+  const int length = getFieldLength();
+  for (int i = 0; i <= length; ++i) {
+    if (i != length && info->field[i][0] == Volatile) {
       ++temp_combo;
     } else if (temp_combo) {
       combo += temp_combo;
@@ -129,13 +336,17 @@ int destroyMarkedRows(GameInfo_t* info, const Tetromino_t* current) {
   return countReward(combo);
 }
 
-void destroyRows(int** field, const int row, const int combo) {
-  memmove(field[0] + (FIELD_WIDTH)*combo, field[0],
-          FIELD_WIDTH * (row - combo) * sizeof(int));
-  memset(field[0], Empty, FIELD_WIDTH * sizeof(int) * combo);
+void destroyRows(FieldCell_t** field, const int row, const int combo) {
+  const int width = getFieldWidth();
+  memmove(field[0] + width * combo, field[0],
+          width * (row - combo) * sizeof(FieldCell_t));
+  memset(field[0], Empty, width * sizeof(FieldCell_t) * combo);
+#ifdef TETRIS_BITBOARD
+  removeBitboardRows(row, combo);
+#endif
 }
 
-void endGame(GameInfo_t* info) {
+void endGame(PackedGameInfo_t* info) {
   setGameState(EndState);
   info->level = 0;
   info->speed = 0;
@@ -1,11 +1,14 @@
 #include "frontend.h"
 
-#include "../../brick_game/colors.h"
+#include <string.h>
+
+#include "../../brick_game/common/palette.h"
 #include "game_field.h"
 #include "input.h"
 #include "menus.h"
 
 #define BACKGROUND_COLOR COLOR_BLACK
+#define BLANK_GLYPH "  "
 #define DEFAULT_GAMEDATA                  \
   (GameData_t){.controls.prog_on = true,  \
                .current_scr = MainMenu,   \
@@ -22,7 +25,6 @@
 int initProgramm(GameData_t* data);
 void cleanup(GameData_t* data);
 void initNcurses();
-void initColors();
 int initWindows(GameWindows_t* windows);
 void destroyWindows(GameWindows_t* windows);
 
@@ -45,6 +47,7 @@ int initProgramm(GameData_t* data) {
   if (!mtx_init(&data->controls.mutex, mtx_plain)) data->mem |= MTX_ON;
   if (!cnd_init(&data->controls.cnd)) data->mem |= CND_ON;
   if (!initWindows(&data->windows)) data->mem |= WIN_ON;
+  applyPalette(&data->windows, paletteDefault());
   if (!initGameMenus(&data->game_menus)) data->mem |= MENU_ON;
   if (data->mem == INITIALIZED)
     result = OK;
@@ -63,6 +66,10 @@ int initDisplay(GameData_t* data) {
 
 int initWindows(GameWindows_t* windows) {
   int result = OK;
+  windows->field_width = FIELD_WIDTH;
+  windows->field_length = FIELD_LENGTH;
+  windows->drawn = (FieldCache_t){0};
+  windows->panels = (PanelCache_t){0};
   windows->field_win =
       newwin(FIELD_WIN_HEIGHT, FIELD_WIN_WIDTH, 0, SCREEN_LEFT_OFFSET);
   windows->stats_win = newwin(FIELD_WIN_HEIGHT, STATS_WIN_WIDTH, 0,
@@ -75,26 +82,58 @@ int initWindows(GameWindows_t* windows) {
   return result;
 }
 
+int layoutWindows(GameWindows_t* windows, int width, int length) {
+  int result = OK;
+  int height = FIELD_WIN_HEIGHT_OF(length);
+  int win_width = FIELD_WIN_WIDTH_OF(width);
+  if (height > LINES - CONTEXT_WIN_HEIGHT) height = LINES - CONTEXT_WIN_HEIGHT;
+  if (win_width > COLS - STATS_WIN_WIDTH) win_width = COLS - STATS_WIN_WIDTH;
+  if (height < FIELD_WIN_HEIGHT_OF(FIELD_MIN_SIZE))
+    height = FIELD_WIN_HEIGHT_OF(FIELD_MIN_SIZE);
+  if (win_width < FIELD_WIN_WIDTH_OF(FIELD_MIN_SIZE))
+    win_width = FIELD_WIN_WIDTH_OF(FIELD_MIN_SIZE);
+
+  clear();
+  refresh();
+  if (wresize(windows->field_win, height, win_width) == ERR ||
+      mvwin(windows->stats_win, 0, win_width + SCREEN_LEFT_OFFSET) == ERR ||
+      wresize(windows->stats_win, height, STATS_WIN_WIDTH) == ERR ||
+      mvwin(windows->context_win, height, SCREEN_LEFT_OFFSET) == ERR ||
+      wresize(windows->context_win, CONTEXT_WIN_HEIGHT,
+              win_width + STATS_WIN_WIDTH) == ERR)
+    result = EXIT_FAILURE;
+  windows->field_width = width;
+  windows->field_length = length;
+  windows->drawn.generation = 0;
+  windows->panels = (PanelCache_t){0};
+  wclear(windows->field_win);
+  wclear(windows->stats_win);
+  wclear(windows->context_win);
+  return result;
+}
+
 void initNcurses() {
   initscr();
   noecho();
-  initColors();
+  start_color();
   curs_set(0);
   keypad(stdscr, TRUE);
   timeout(TIMEOUT);
 }
 
-void initColors() {
-  start_color();
-  init_pair(Static, BACKGROUND_COLOR, COLOR_WHITE);
-  init_pair(Damaged, BACKGROUND_COLOR, COLOR_WHITE);
-  init_pair(Red, BACKGROUND_COLOR, COLOR_RED);
-  init_pair(Magenta, BACKGROUND_COLOR, COLOR_MAGENTA);
-  init_pair(Green, BACKGROUND_COLOR, COLOR_GREEN);
-  init_pair(Cyan, BACKGROUND_COLOR, COLOR_BLUE);
-  init_pair(Yellow, BACKGROUND_COLOR, COLOR_YELLOW);
-  init_pair(Orange, BACKGROUND_COLOR, COLOR_YELLOW);
-  init_pair(Blue, BACKGROUND_COLOR, COLOR_BLUE);
+// Pair n draws cell value n, so a cell costs one table lookup
+void applyPalette(GameWindows_t* windows, const BrickPalette_t* palette) {
+  for (int value = 0; value < PALETTE_SIZE; value++) {
+    const BrickPaletteEntry_t* entry = &palette->entries[value];
+    CellStyle_t* style = &windows->styles[value];
+    style->pair = 0;
+    memcpy(style->glyph, entry->glyph[0] ? entry->glyph : BLANK_GLYPH, 2);
+    style->glyph[2] = '\0';
+    if (value && value < COLOR_PAIRS && entry->term_color != TermDefault &&
+        (entry->alpha || entry->glyph[0]) &&
+        init_pair(value, BACKGROUND_COLOR, entry->term_color) == OK)
+      style->pair = value;
+  }
 }
 
 void error(Controls_t* ctrls) {
@@ -118,4 +157,6 @@ void destroyWindows(GameWindows_t* windows) {
   if (windows->field_win) delwin(windows->field_win);
   if (windows->stats_win) delwin(windows->stats_win);
   if (windows->context_win) delwin(windows->context_win);
+  free(windows->drawn.cells);
+  windows->drawn = (FieldCache_t){0};
 }
\ No newline at end of file
@@ -1,125 +1,304 @@
-#include "../../brick_game/colors.h"
+#include <string.h>
+#include <time.h>
+
 #include "frontend.h"
-#define REFRESH_RATE 60
+#define REFRESH_RATE 60     // ms between polls of games without frames
+#define WAIT_TIMEOUT 100    // ms a frame wait lasts before checking again
+#define MAX_FPS 60          // redraws per second the screen is capped to
+#define PROGRESS_TIME 3000  // ms the points message stays up
+
+enum { Running, Paused, GameOver, NewHighScore };
 
 int printGameScreen(void* arg);
-void printField(WINDOW* win, const GameInfo_t* info);
-void printNext(WINDOW* win, const GameInfo_t* info);
-void printStats(WINDOW* stats_win, const GameInfo_t* info);
-void printContext(WINDOW* context_win, const GameInfo_t* info);
-void printCondition(WINDOW* win, int line, const GameInfo_t* info);
-void printProgress(WINDOW* win, const int line, const GameInfo_t* info);
+uint64_t waitFrame(const Interface_t* interface, uint64_t seen);
+void paceFrame(long long* last_draw);
+long long nowMs(void);
+void printFrame(GameWindows_t* windows, const BrickFrame_t* frame);
+void printFrameField(GameWindows_t* windows, const BrickFrame_t* frame);
+void printField(GameWindows_t* windows, const GameInfo_t* info);
+void printCell(WINDOW* win, const CellStyle_t* styles, int y, int x, int cell);
+void printPanels(GameWindows_t* windows, const GameInfo_t* info);
+bool printNext(GameWindows_t* windows, const GameInfo_t* info);
+bool printStats(WINDOW* stats_win, const GameInfo_t* info,
+                PanelCache_t* panels);
+void trackProgress(PanelCache_t* panels, const GameInfo_t* info,
+                   long long now);
+void printContext(WINDOW* context_win, const GameInfo_t* info,
+                  PanelCache_t* panels);
+int getCondition(const GameInfo_t* info);
+void printCondition(WINDOW* win, int line, int condition);
+void printProgress(WINDOW* win, int line, int points, bool level_up);
 
+// Waiting and pacing happen without the lock, so input and menus never queue
+// behind a frame. Curses calls still take it: ncurses is not thread safe and
+// menus draw from the input thread
 int printGameScreen(void* arg) {
-  int exit_code = OK;
   GameData_t* data = (GameData_t*)arg;
-  GameInfo_t info;
+  Interface_t* interface = &data->interface;
+  uint64_t seen = 0;
+  long long last_draw = 0;
+  bool game_on = true;
 
-  do {
+  while (game_on) {
     mtx_lock(&data->controls.mutex);
-    if (data->current_scr != GameScreen) {
-      while (data->current_scr != GameScreen && data->controls.game_on)
-        cnd_wait(&data->controls.cnd, &data->controls.mutex);
-    } else {
-      info = data->interface.updateCurrentState();
-      printField(data->windows.field_win, &info);
-      printNext(data->windows.stats_win, &info);
-      printStats(data->windows.stats_win, &info);
-      printContext(data->windows.context_win, &info);
+    while (data->current_scr != GameScreen && data->controls.game_on)
+      cnd_wait(&data->controls.cnd, &data->controls.mutex);
+    game_on = data->controls.game_on;
+    const bool stale =
+        !data->windows.drawn.generation || !data->windows.panels.valid;
+    mtx_unlock(&data->controls.mutex);
+    if (game_on && interface->getFrame) {
+      if (!stale) waitFrame(interface, seen);
+      paceFrame(&last_draw);
+      const BrickFrame_t* frame = interface->getFrame(interface->game);
+      seen = frame->generation;
+      mtx_lock(&data->controls.mutex);
+      if (data->current_scr == GameScreen) printFrame(&data->windows, frame);
+      mtx_unlock(&data->controls.mutex);
+    } else if (game_on) {
       napms(REFRESH_RATE);
+      const GameInfo_t info = interface->updateCurrentState();
+      mtx_lock(&data->controls.mutex);
+      if (data->current_scr == GameScreen) {
+        printField(&data->windows, &info);
+        printPanels(&data->windows, &info);
+      }
+      mtx_unlock(&data->controls.mutex);
     }
-    mtx_unlock(&data->controls.mutex);
-  } while (data->controls.game_on);
+  }
 
-  return exit_code;
+  return OK;
 }
 
-void printField(WINDOW* win, const GameInfo_t* info) {
-  box(win, 0, 0);
-  if (info->field) {
-    for (int y = 0; y < FIELD_LENGTH; y++) {
-      int xx = 1;
-      for (int x = 0; x < FIELD_WIDTH; x++, xx += 2) {
-        int cell = info->field[y][x];
-        wattron(win, COLOR_PAIR(cell));
-        if (cell == Damaged) {
-          mvwaddstr(win, y + 1, xx, "$");
-        } else
-          mvwaddstr(win, y + 1, xx, "  ");
-        wattroff(win, COLOR_PAIR(cell));
+// Wakes on the next publication. The timeout lets the loop notice the game
+// ending and the points message running out while the game stands still
+uint64_t waitFrame(const Interface_t* interface, uint64_t seen) {
+  if (interface->waitFrame)
+    seen = interface->waitFrame(interface->game, seen, WAIT_TIMEOUT);
+  else
+    napms(REFRESH_RATE);
+  return seen;
+}
+
+void paceFrame(long long* last_draw) {
+  const long long wait = *last_draw + 1000 / MAX_FPS - nowMs();
+  if (wait > 0) napms((int)wait);
+  *last_draw = nowMs();
+}
+
+long long nowMs(void) {
+  struct timespec now;
+  timespec_get(&now, TIME_UTC);
+  return now.tv_sec * 1000LL + now.tv_nsec / 1000000;
+}
+
+// Stats and the next shape go through a GameInfo_t without a field. Nothing
+// is shown before the first publication, whose level would read as game over
+void printFrame(GameWindows_t* windows, const BrickFrame_t* frame) {
+  if (!frame->generation) return;
+  int next[NEXTF_LENGTH][NEXTF_WIDTH];
+  int* next_rows[NEXTF_LENGTH];
+  for (int y = 0; y < NEXTF_LENGTH; y++) {
+    for (int x = 0; x < NEXTF_WIDTH; x++) next[y][x] = frame->next[y][x];
+    next_rows[y] = next[y];
+  }
+  const GameInfo_t info = {.next = next_rows,
+                           .score = frame->score,
+                           .high_score = frame->high_score,
+                           .level = frame->level,
+                           .speed = frame->speed,
+                           .pause = frame->pause};
+  printFrameField(windows, frame);
+  printPanels(windows, &info);
+}
+
+// Redraws only the cells that differ from what the window shows: the frame's
+// dirty list when the previous frame was the one drawn, a comparison with the
+// drawn cells when frames were skipped, everything after a layout change
+void printFrameField(GameWindows_t* windows, const BrickFrame_t* frame) {
+  FieldCache_t* drawn = &windows->drawn;
+  WINDOW* win = windows->field_win;
+  const size_t size = (size_t)frame->width * frame->length;
+  if (frame->cells && frame->generation != drawn->generation &&
+      (frame->width != drawn->width || frame->length != drawn->length ||
+       !drawn->cells)) {
+    uint8_t* cells = realloc(drawn->cells, size);
+    if (cells) {
+      drawn->cells = cells;
+      drawn->width = frame->width;
+      drawn->length = frame->length;
+    }
+    drawn->generation = 0;
+  }
+  if (frame->cells && frame->generation != drawn->generation &&
+      drawn->width == frame->width && drawn->length == frame->length) {
+    const int width = frame->width;
+    if (!drawn->generation) {
+      touchwin(win);
+      box(win, 0, 0);
+      for (size_t n = 0; n < size; n++)
+        printCell(win, windows->styles, n / width, n % width, frame->cells[n]);
+    } else if (frame->generation == drawn->generation + 1 &&
+               frame->dirty_count >= 0) {
+      for (int i = 0; i < frame->dirty_count; i++) {
+        const int n = frame->dirty[i];
+        printCell(win, windows->styles, n / width, n % width, frame->cells[n]);
       }
+    } else {
+      for (size_t n = 0; n < size; n++)
+        if (drawn->cells[n] != frame->cells[n])
+          printCell(win, windows->styles, n / width, n % width,
+                    frame->cells[n]);
     }
+    memcpy(drawn->cells, frame->cells, size);
+    drawn->generation = frame->generation;
+    wrefresh(win);
   }
-  wrefresh(win);
 }
 
-void printNext(WINDOW* win, const GameInfo_t* info) {
-  wclear(win);
+void printField(GameWindows_t* windows, const GameInfo_t* info) {
+  WINDOW* win = windows->field_win;
   box(win, 0, 0);
-  mvwprintw(win, 1, 1, "NEXT:");
-  if (info->next) {
-    for (int y = 0; y < NEXTF_LENGTH; y++) {
-      int xx = 2;
-      for (int x = 0; x < NEXTF_WIDTH; x++, xx += 2) {
-        wattron(win, COLOR_PAIR(info->next[y][x]));
-        mvwaddstr(win, y + 3, xx, "  ");
-        wattroff(win, COLOR_PAIR(info->next[y][x]));
+  if (info->field) {
+    for (int y = 0; y < windows->field_length; y++)
+      for (int x = 0; x < windows->field_width; x++)
+        printCell(win, windows->styles, y, x, info->field[y][x]);
+  }
+  wrefresh(win);
+}
+
+// Boards bigger than the terminal only show their top left corner
+void printCell(WINDOW* win, const CellStyle_t* styles, int y, int x,
+               int cell) {
+  int max_y, max_x;
+  getmaxyx(win, max_y, max_x);
+  if (y < max_y - 2 && x < (max_x - 2) / 2) {
+    const CellStyle_t* style = &styles[(uint8_t)cell];
+    wattron(win, COLOR_PAIR(style->pair));
+    mvwaddstr(win, y + 1, x * 2 + 1, style->glyph);
+    wattroff(win, COLOR_PAIR(style->pair));
+  }
+}
+
+// Each panel is drawn when a value it shows changes, and whole after the
+// windows were cleared
+void printPanels(GameWindows_t* windows, const GameInfo_t* info) {
+  PanelCache_t* panels = &windows->panels;
+  WINDOW* stats_win = windows->stats_win;
+  trackProgress(panels, info, nowMs());
+  if (!panels->valid) {
+    werase(stats_win);
+    box(stats_win, 0, 0);
+    mvwprintw(stats_win, 1, 1, "NEXT:");
+  }
+  const bool next_changed = printNext(windows, info);
+  const bool stats_changed = printStats(stats_win, info, panels);
+  if (next_changed || stats_changed || !panels->valid) wrefresh(stats_win);
+  printContext(windows->context_win, info, panels);
+  panels->valid = true;
+}
+
+bool printNext(GameWindows_t* windows, const GameInfo_t* info) {
+  PanelCache_t* panels = &windows->panels;
+  WINDOW* win = windows->stats_win;
+  bool changed = false;
+  for (int y = 0; y < NEXTF_LENGTH; y++) {
+    for (int x = 0; x < NEXTF_WIDTH; x++) {
+      const int cell = info->next ? info->next[y][x] : 0;
+      if (!panels->valid || panels->next[y][x] != cell) {
+        const int pair = windows->styles[(uint8_t)cell].pair;
+        wattron(win, COLOR_PAIR(pair));
+        mvwaddstr(win, y + 3, x * 2 + 2, "  ");
+        wattroff(win, COLOR_PAIR(pair));
+        panels->next[y][x] = cell;
+        changed = true;
       }
     }
   }
+  return changed;
 }
 
-void printStats(WINDOW* stats_win, const GameInfo_t* info) {
+bool printStats(WINDOW* stats_win, const GameInfo_t* info,
+                PanelCache_t* panels) {
   static const char* stats[4] = {"HIGHSCORE:", "SCORE:", "LEVEL:", "SPEED:"};
   const int vals[4] = {info->high_score, info->score, info->level, info->speed};
+  bool changed = false;
 
   for (int i = 0, y = 8; i < 4; i++, y += 2) {
-    mvwprintw(stats_win, y, 1, "%s", stats[i]);
-    mvwprintw(stats_win, y + 1, 1, "%d", vals[i]);
+    if (!panels->valid) mvwprintw(stats_win, y, 1, "%s", stats[i]);
+    if (!panels->valid || panels->stats[i] != vals[i]) {
+      // Padded to the window so shorter numbers cover longer ones
+      mvwprintw(stats_win, y + 1, 1, "%-*d", STATS_WIN_WIDTH - 2, vals[i]);
+      panels->stats[i] = vals[i];
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+// Arms the points message for PROGRESS_TIME on every score gain
+void trackProgress(PanelCache_t* panels, const GameInfo_t* info,
+                   long long now) {
+  if (!panels->tracking) {
+    panels->prev_score = info->score;
+    panels->prev_level = info->level;
+    panels->tracking = true;
+  }
+  if (info->score > panels->prev_score) {
+    panels->points_earned = info->score - panels->prev_score;
+    panels->prev_score = info->score;
+    panels->progress_until = now + PROGRESS_TIME;
+  }
+  if (info->level > panels->prev_level) {
+    panels->level_up = true;
+    panels->prev_level = info->level;
+  }
+  if (now >= panels->progress_until) {
+    panels->points_earned = 0;
+    panels->level_up = false;
+  }
+}
+
+void printContext(WINDOW* context_win, const GameInfo_t* info,
+                  PanelCache_t* panels) {
+  const int condition = getCondition(info);
+  const int points = panels->points_earned;
+  const bool level_up = points && panels->level_up;
+  if (!panels->valid || condition != panels->condition ||
+      points != panels->points_shown || level_up != panels->level_shown) {
+    werase(context_win);
+    box(context_win, 0, 0);
+    printCondition(context_win, 1, condition);
+    printProgress(context_win, 2, points, level_up);
+    wrefresh(context_win);
+    panels->condition = condition;
+    panels->points_shown = points;
+    panels->level_shown = level_up;
   }
-  wrefresh(stats_win);
 }
 
-void printContext(WINDOW* context_win, const GameInfo_t* info) {
-  printCondition(context_win, 1, info);
-  printProgress(context_win, 2, info);
-  wrefresh(context_win);
+int getCondition(const GameInfo_t* info) {
+  int condition = Running;
+  if (info->pause)
+    condition = Paused;
+  else if (info->level == 0)
+    condition = info->score > info->high_score ? NewHighScore : GameOver;
+  return condition;
 }
 
-void printCondition(WINDOW* win, const int line, const GameInfo_t* info) {
-  if (info->pause) {
+void printCondition(WINDOW* win, const int line, const int condition) {
+  if (condition == Paused)
     mvwprintw(win, line, 2, "PAUSE");
-  } else if (info->level == 0) {
+  else if (condition == GameOver)
     mvwprintw(win, line, 2, "GAME OVER");
-    if (info->score > info->high_score)
-      mvwprintw(win, line, 2, "Congratulations! New highscore!");
-  } else {
-    wmove(win, line, 0);
-    wclrtoeol(win);
-    wclear(win);
-    box(win, 0, 0);
-  }
+  else if (condition == NewHighScore)
+    mvwprintw(win, line, 2, "Congratulations! New highscore!");
 }
 
-void printProgress(WINDOW* win, const int line, const GameInfo_t* info) {
-  static int prev_score = 0;
-  static int prev_level = 1;
-  static int counter = 0;
-  static int points_earned;
-  static bool level_up = false;
-  if (info->score > prev_score) {
-    counter = 50;
-    points_earned = info->score - prev_score;
-    prev_score = info->score;
-  }
-  if (info->level > prev_level) {
-    level_up = true;
-    prev_level = info->level;
-  }
-  if (counter > 0) {
-    mvwprintw(win, line, 5, "+%d points!", points_earned);
+void printProgress(WINDOW* win, const int line, const int points,
+                   const bool level_up) {
+  if (points) {
+    mvwprintw(win, line, 5, "+%d points!", points);
     if (level_up) mvwprintw(win, line + 1, 5, "NEW LEVEL!");
-    --counter;
-  } else
-    level_up = false;
-}
\ No newline at end of file
+  }
+}
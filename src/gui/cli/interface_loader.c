@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../brick_game/common/palette.h"
 #include "path_utils.h"
 
 #define LIB_NAME_MAX_SIZE 24
@@ -36,6 +37,29 @@ int loadGameInterface(const char *game_name, Interface_t *interface) {
       if (dlsym_error) {
         dlclose(interface->handle);
         result = EXIT_FAILURE;
+      } else {
+        // Optional: games without it use the classic board size
+        interface->getFieldSize =
+            (sizeFunc_t)dlsym(interface->handle, "getFieldSize");
+        // Optional: games without frames are drawn from updateCurrentState()
+        gameFunc_t getGame = (gameFunc_t)dlsym(interface->handle, "bg_default");
+        interface->getFrame =
+            (frameFunc_t)dlsym(interface->handle, "bg_frame");
+        interface->waitFrame =
+            (waitFunc_t)dlsym(interface->handle, "bg_wait");
+        interface->record =
+            (recordFunc_t)dlsym(interface->handle, "bg_record");
+        // Optional: games without it hold FieldCellColors_t values
+        paletteFunc_t getPalette =
+            (paletteFunc_t)dlsym(interface->handle, "bg_palette");
+        dlerror();
+        interface->palette = getPalette ? getPalette() : paletteDefault();
+        interface->game = getGame ? getGame() : NULL;
+        if (!interface->game) {
+          interface->getFrame = NULL;
+          interface->waitFrame = NULL;
+          interface->record = NULL;
+        }
       }
     }
   }
@@ -68,6 +92,12 @@ void unloadGameInterface(Interface_t *interface) {
   interface->handle = NULL;
   interface->updateCurrentState = NULL;
   interface->userInput = NULL;
+  interface->getFieldSize = NULL;
+  interface->getFrame = NULL;
+  interface->waitFrame = NULL;
+  interface->record = NULL;
+  interface->palette = NULL;
+  interface->game = NULL;
 }
 
 void strToLower(char *dst, const char *src) {
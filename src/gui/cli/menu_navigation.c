@@ -1,8 +1,11 @@
+#include <stdlib.h>
 #include <string.h>
 
 #include "interface_loader.h"
 #include "menus.h"
 
+#define RECORD_ENV "BRICKGAME_RECORD"
+
 typedef void (*MenuAction_t)(const UserAction_t, GameData_t *);
 
 typedef void (*OptionsHandler_t)(GameData_t *);
@@ -133,6 +136,15 @@ const char *getCurrentItemName(MENU *menu) {
 }
 
 void startGame(GameData_t *data) {
+  int width = FIELD_WIDTH, length = FIELD_LENGTH;
+  if (data->interface.getFieldSize)
+    data->interface.getFieldSize(&width, &length);
+  layoutWindows(&data->windows, width, length);
+  applyPalette(&data->windows, data->interface.palette);
+  // The log is replayed with brickgame_sim --replay
+  const char *record_path = getenv(RECORD_ENV);
+  if (record_path && data->interface.record)
+    data->interface.record(data->interface.game, record_path);
   data->controls.game_on = true;
   switchScreen(data, GameScreen);
   data->interface.userInput(Start, false);
@@ -146,6 +158,9 @@ void endGame(GameData_t *data) {
   data->interface.userInput(Terminate, false);
   cnd_signal(&data->controls.cnd);
   thrd_join(data->controls.game_thrd, NULL);
+  if (data->interface.record)
+    data->interface.record(data->interface.game, NULL);
   unloadGameInterface(&data->interface);
+  layoutWindows(&data->windows, FIELD_WIDTH, FIELD_LENGTH);
   switchScreen(data, MainMenu);
 }
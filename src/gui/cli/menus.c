@@ -200,6 +200,9 @@ void postMenu(GameData_t *data, const GameScreen_t new) {
   Menu_t *menu = &data->game_menus.menus[new];
   mtx_lock(&data->controls.mutex);
   clear();
+  // The menu covers the game, which is drawn whole when it returns
+  data->windows.drawn.generation = 0;
+  data->windows.panels.valid = false;
   box(menu->window, 0, 0);
   print_centered(menu->window, menu->title);
   post_menu(menu->menu);
@@ -1,116 +1,139 @@
 #include "brickview.h"
 
 #include <QBrush>
-#include <QGraphicsRectItem>
-#include <QPen>
+#include <QPaintEvent>
+#include <QPainter>
 
-#include "colors.h"
+#include "palette.h"
 
-BrickView::BrickView(QWidget* parent) : QGraphicsView(parent) {
-  scene_ = new QGraphicsScene(this);
-  setScene(scene_);
-  setRenderHint(QPainter::Antialiasing);
-  setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-  setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+namespace {
+
+constexpr int kMinCellSize = 4;
+
+}  // namespace
+
+BrickView::BrickView(QWidget* parent) : QFrame(parent) {
+  // The style sheet background is drawn under the board
+  setAttribute(Qt::WA_StyledBackground);
   setFocusPolicy(Qt::StrongFocus);
+  SetPalette(paletteDefault());
+}
+
+// Value 0 is the board itself, the rest are filled inside a darker edge.
+// Values the palette leaves zeroed stay transparent
+void BrickView::SetPalette(const BrickPalette_t* palette) {
+  for (int value = 0; value < PALETTE_SIZE; value++) {
+    const BrickPaletteEntry_t& entry = palette->entries[value];
+    const QColor color(entry.red, entry.green, entry.blue, entry.alpha);
+    CellStyle& style = styles_[value];
+    if (!entry.alpha)
+      style = {QBrush(Qt::transparent), QBrush(Qt::transparent), 0};
+    else if (!value)
+      style = {QBrush(color), QBrush(Qt::black), 1};
+    else
+      style = {QBrush(color), QBrush(color.darker()), 2};
+  }
+  Relayout();
 }
 
 void BrickView::InitField(int width, int height) {
   grid_width_ = width;
   grid_height_ = height;
+  cells_.assign(static_cast<std::size_t>(width) * height, 0);
+  Relayout();
+}
 
-  // Calculate cell size based on current widget dimensions
-  int availableWidth = this->width();
-  int availableHeight = this->height();
-
-  // Calculate maximum cell size that fits both dimensions
-  int cellSizeFromWidth = availableWidth / width;
-  int cellSizeFromHeight = availableHeight / height;
-
-  // Use the smaller cell size to ensure everything fits
-  cell_size_ = qMin(cellSizeFromWidth, cellSizeFromHeight);
+// Picks the largest cell size that fits the widget and repaints the board
+void BrickView::Relayout() {
+  if (!grid_width_ || !grid_height_) return;
+  const QRect area = contentsRect();
+  cell_size_ = qMax(kMinCellSize, qMin(area.width() / grid_width_,
+                                       area.height() / grid_height_));
+  const QSize board(grid_width_ * cell_size_, grid_height_ * cell_size_);
+  // Centred, boards bigger than the widget show their top left corner
+  origin_ = area.topLeft() +
+            QPoint(qMax(0, (area.width() - board.width()) / 2),
+                   qMax(0, (area.height() - board.height()) / 2));
+
+  const qreal ratio = devicePixelRatioF();
+  pixmap_ = QPixmap(board * ratio);
+  pixmap_.setDevicePixelRatio(ratio);
+  pixmap_.fill(Qt::transparent);
+  QPainter painter(&pixmap_);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  for (int n = 0; n < static_cast<int>(cells_.size()); n++)
+    PaintCell(painter, n);
+  changed_ = QRect();
+  update();
+}
 
-  // Ensure minimum cell size for visibility
-  if (cell_size_ < 4) {
-    cell_size_ = 4;  // Minimum reasonable size
+void BrickView::UpdateField(int** data) {
+  if (pixmap_.isNull()) return;
+  QPainter painter(&pixmap_);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  for (int y = 0; y < grid_height_; y++) {
+    for (int x = 0; x < grid_width_; x++)
+      SetCell(painter, y * grid_width_ + x, data[y][x]);
   }
+  painter.end();
+  ScheduleUpdate();
+}
 
-  scene_->clear();
-  cells_.clear();
-  cells_.resize(height);
-
-  // Create all cell items upfront
-  for (int y = 0; y < height; y++) {
-    cells_[y].resize(width);
-    for (int x = 0; x < width; x++) {
-      QGraphicsRectItem* cell = new QGraphicsRectItem(
-          x * cell_size_, y * cell_size_, cell_size_, cell_size_);
-
-      scene_->addItem(cell);
-      cells_[y][x] = {cell, 0};
-      DismissColor(cells_[y][x]);
-    }
+void BrickView::UpdateCells(const std::uint8_t* data, int width, int height,
+                            const std::int32_t* dirty, int dirty_count) {
+  if (width != grid_width_ || height != grid_height_ || pixmap_.isNull())
+    return;
+  QPainter painter(&pixmap_);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  if (dirty && dirty_count >= 0) {
+    for (int i = 0; i < dirty_count; i++)
+      SetCell(painter, dirty[i], data[dirty[i]]);
+  } else {
+    for (int n = 0; n < width * height; n++) SetCell(painter, n, data[n]);
   }
+  painter.end();
+  ScheduleUpdate();
+}
 
-  // Update scene and view size
-  setSceneRect(0, 0, width * cell_size_, height * cell_size_);
+void BrickView::SetCell(QPainter& painter, int n, int color) {
+  if (cells_[n] == color) return;
+  cells_[n] = static_cast<std::uint8_t>(color);
+  PaintCell(painter, n);
 }
 
-void BrickView::UpdateField(int** data) {
-  for (int y = 0; y < grid_height_; y++) {
-    for (int x = 0; x < grid_width_; x++) {
-      int color = data[y][x];
-      if (cells_[y][x].cashed_value == color) continue;
-      cells_[y][x].cashed_value = color;
-
-      if (color == Empty) {
-        DismissColor(cells_[y][x]);
-      } else {
-        QColor q_color;
-        switch (color) {
-          case Static:
-            q_color = QColor(255, 255, 255);
-            break;  // White
-          case Damaged:
-            q_color = QColor(255, 0, 0, 128);
-            break;  // Semi-transparent red
-
-          case Red:
-            q_color = QColor(255, 0, 0);
-            break;
-          case Magenta:
-            q_color = QColor(255, 0, 255);
-            break;
-          case Green:
-            q_color = QColor(0, 255, 0);
-            break;
-          case Cyan:
-            q_color = QColor(0, 255, 255);
-            break;
-          case Yellow:
-            q_color = QColor(255, 255, 0);
-            break;
-          case Orange:
-            q_color = QColor(255, 165, 0);
-            break;
-          case Blue:
-            q_color = QColor(0, 0, 255);
-            break;
-
-          default:
-            q_color = Qt::white;
-        }
-        AssignColor(cells_[y][x], q_color);
-      }
-    }
-  }
+// Source composition replaces the pixels, so translucent colours do not pile
+// up over what the cell showed before
+void BrickView::PaintCell(QPainter& painter, int n) {
+  const CellStyle& style = styles_[cells_[n]];
+  const QRect rect(n % grid_width_ * cell_size_, n / grid_width_ * cell_size_,
+                   cell_size_, cell_size_);
+  const int edge = qMin(style.edge_width, cell_size_ / 4);
+  painter.fillRect(rect, style.edge);
+  painter.fillRect(rect.adjusted(edge, edge, -edge, -edge), style.fill);
+  changed_ |= rect;
 }
 
-void BrickView::AssignColor(Cell& c, QColor color) {
-  c.item->setBrush(QBrush(color));
-  c.item->setPen(QPen(color.darker(), 2));
+// One update() per batch: Qt merges it with anything else pending
+void BrickView::ScheduleUpdate() {
+  if (changed_.isNull()) return;
+  update(changed_.translated(origin_));
+  changed_ = QRect();
 }
-void BrickView::DismissColor(Cell& c) {
-  c.item->setBrush(QBrush(Qt::gray));
-  c.item->setPen(QPen(Qt::black, 1));
+
+void BrickView::paintEvent(QPaintEvent* event) {
+  QFrame::paintEvent(event);
+  const QRect board(origin_, QSize(grid_width_ * cell_size_,
+                                   grid_height_ * cell_size_));
+  const QRect exposed = event->rect() & board;
+  if (pixmap_.isNull() || exposed.isEmpty()) return;
+  const qreal ratio = pixmap_.devicePixelRatio();
+  const QRectF source(QPointF(exposed.topLeft() - origin_) * ratio,
+                      QSizeF(exposed.size()) * ratio);
+  QPainter painter(this);
+  painter.drawPixmap(QRectF(exposed), pixmap_, source);
+}
+
+void BrickView::resizeEvent(QResizeEvent* event) {
+  QFrame::resizeEvent(event);
+  Relayout();
 }
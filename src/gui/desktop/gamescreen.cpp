@@ -5,6 +5,7 @@
 #include <QShowEvent>
 
 #include "confirmexit.h"
+#include "palette.h"
 #include "ui_gamescreen.h"
 
 constexpr int kUpdateInterval = 1000 / 60;
@@ -18,11 +19,24 @@ GameScreen::GameScreen(QWidget *parent)
 
   QTimer::singleShot(1, this, [this]() {
     // This runs AFTER the constructor returns and layout is complete
-    ui->FieldView->InitField(FIELD_WIDTH, FIELD_LENGTH);
-    ui->NextView->InitField(NEXTF_WIDTH, NEXTF_LENGTH);
+    InitViews();
   });
 }
 
+void GameScreen::InitViews() {
+  int width = FIELD_WIDTH, length = FIELD_LENGTH;
+  if (interface_.getFieldSize) interface_.getFieldSize(&width, &length);
+  if (interface_.palette) {
+    ui->FieldView->SetPalette(interface_.palette);
+    ui->NextView->SetPalette(interface_.palette);
+  }
+  ui->FieldView->InitField(width, length);
+  ui->NextView->InitField(NEXTF_WIDTH, NEXTF_LENGTH);
+  shown_generation_ = 0;
+  stats_shown_ = false;
+  idle_ = false;
+}
+
 GameScreen::~GameScreen() {
   if (refresh_timer_->isActive()) {
     refresh_timer_->stop();
@@ -34,6 +48,8 @@ GameScreen::~GameScreen() {
 void GameScreen::showEvent(QShowEvent *event) {
   QFrame::showEvent(event);
   setFocus();
+  // The loaded game may use a different board than the last one
+  InitViews();
   interface_.userInput(Start, false);
   refresh_timer_->start();
 }
@@ -84,24 +100,74 @@ void GameScreen::keyPressEvent(QKeyEvent *event) {
   }
 
   interface_.userInput(action, isAutoRepeat);
+  // The timer sleeps while the game is paused or over, input may wake it
+  if (!refresh_timer_->isActive() && isVisible()) refresh_timer_->start();
 }
 
+// A tick without a new frame costs one atomic load. Once the shown game is
+// paused or over and nothing changes, the timer stops until the next input
 void GameScreen::onGameTimer() {
-  GameInfo_t game_info = interface_.updateCurrentState();
+  if (interface_.getFrame && interface_.getGeneration && shown_generation_ &&
+      interface_.getGeneration(interface_.game) == shown_generation_) {
+    if (idle_) refresh_timer_->stop();
+  } else if (interface_.getFrame) {
+    ShowFrame(interface_.getFrame(interface_.game));
+  } else {
+    GameInfo_t game_info = interface_.updateCurrentState();
+    ui->FieldView->UpdateField(game_info.field);
+    ui->NextView->UpdateField(game_info.next);
+    ShowStats(game_info);
+  }
+}
 
-  ui->FieldView->UpdateField(game_info.field);
-  ui->NextView->UpdateField(game_info.next);
-  ui->ScoreLcdNumber->display(game_info.score);
-  ui->HighscoreLcdNumber->display(game_info.high_score);
-  ui->LevelLcdNumber->display(game_info.level);
-  ui->SpeedLcdNumber->display(game_info.speed);
-  ui->StatusLabel->setHidden(!game_info.pause);
+// Right after the shown frame only its dirty cells are repainted, after
+// skipped frames the views compare every cell with what they show
+void GameScreen::ShowFrame(const BrickFrame_t *frame) {
+  // Nothing published yet, the empty frame would read as a game over
+  if (!frame->generation || frame->generation == shown_generation_) return;
+  if (frame->cells) {
+    const bool follows = shown_generation_ &&
+                         frame->generation == shown_generation_ + 1 &&
+                         frame->dirty_count >= 0;
+    ui->FieldView->UpdateCells(frame->cells, frame->width, frame->length,
+                               follows ? frame->dirty : nullptr,
+                               follows ? frame->dirty_count : -1);
+    ui->NextView->UpdateCells(&frame->next[0][0], NEXTF_WIDTH, NEXTF_LENGTH);
+  }
+  shown_generation_ = frame->generation;
+  GameInfo_t game_info{};
+  game_info.score = frame->score;
+  game_info.high_score = frame->high_score;
+  game_info.level = frame->level;
+  game_info.speed = frame->speed;
+  game_info.pause = frame->pause;
+  ShowStats(game_info);
+}
 
-  if (!game_info.level) {
-    refresh_timer_->stop();
-    ui->StatusLabel->setText("Game Over");
-    ui->StatusLabel->show();
+// QLCDNumber repaints on every display() call, so only changes are shown
+void GameScreen::ShowStats(const GameInfo_t &game_info) {
+  const GameInfo_t &shown = shown_stats_;
+  if (!stats_shown_ || game_info.score != shown.score)
+    ui->ScoreLcdNumber->display(game_info.score);
+  if (!stats_shown_ || game_info.high_score != shown.high_score)
+    ui->HighscoreLcdNumber->display(game_info.high_score);
+  if (!stats_shown_ || game_info.level != shown.level)
+    ui->LevelLcdNumber->display(game_info.level);
+  if (!stats_shown_ || game_info.speed != shown.speed)
+    ui->SpeedLcdNumber->display(game_info.speed);
+  if (!stats_shown_ || game_info.pause != shown.pause ||
+      !game_info.level != !shown.level) {
+    ui->StatusLabel->setHidden(!game_info.pause);
+    if (!game_info.level) {
+      ui->StatusLabel->setText("Game Over");
+      ui->StatusLabel->show();
+    }
   }
+  shown_stats_ = game_info;
+  stats_shown_ = true;
+
+  idle_ = game_info.pause || !game_info.level;
+  if (idle_) refresh_timer_->stop();
 }
 
 int GameScreen::LoadGameInterface(QString lib_path) {
@@ -119,6 +185,20 @@ int GameScreen::LoadGameInterface(QString lib_path) {
   if (!interface_.userInput || !interface_.updateCurrentState) {
     return EXIT_FAILURE;
   }
+  interface_.getFieldSize =
+      (sizeFunc_t)interface_.handle->resolve("getFieldSize");
+  auto default_game = (gameFunc_t)interface_.handle->resolve("bg_default");
+  interface_.getFrame = (frameFunc_t)interface_.handle->resolve("bg_frame");
+  interface_.getGeneration =
+      (generationFunc_t)interface_.handle->resolve("bg_generation");
+  // Optional: games without it hold FieldCellColors_t values
+  auto get_palette = (paletteFunc_t)interface_.handle->resolve("bg_palette");
+  interface_.palette = get_palette ? get_palette() : paletteDefault();
+  interface_.game = default_game ? default_game() : nullptr;
+  if (!interface_.game) {
+    interface_.getFrame = nullptr;
+    interface_.getGeneration = nullptr;
+  }
 
   return EXIT_SUCCESS;
 }
@@ -133,4 +213,9 @@ void GameScreen::UnloadGameInterface() {
   }
   interface_.userInput = nullptr;
   interface_.updateCurrentState = nullptr;
+  interface_.getFieldSize = nullptr;
+  interface_.getFrame = nullptr;
+  interface_.getGeneration = nullptr;
+  interface_.palette = nullptr;
+  interface_.game = nullptr;
 }
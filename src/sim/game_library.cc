@@ -0,0 +1,45 @@
+#include "game_library.h"
+
+#include <dlfcn.h>
+
+#include <filesystem>
+#include <stdexcept>
+
+namespace brick_game {
+
+namespace {
+
+template <typename Function>
+void Bind(void* handle, const char* name, Function& function) {
+  function = reinterpret_cast<Function>(dlsym(handle, name));
+  if (!function) throw std::runtime_error(std::string("missing ") + name);
+}
+
+}  // namespace
+
+GameLibrary::GameLibrary(const std::string& path)
+    : handle_(dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL)) {
+  if (!handle_) throw std::runtime_error(dlerror());
+  try {
+    Bind(handle_, "bg_create", create);
+    Bind(handle_, "bg_destroy", destroy);
+    Bind(handle_, "bg_input", input);
+    Bind(handle_, "bg_frame", frame);
+    Bind(handle_, "bg_step", step);
+  } catch (const std::runtime_error&) {
+    dlclose(handle_);
+    throw;
+  }
+}
+
+GameLibrary::~GameLibrary() { dlclose(handle_); }
+
+std::string DefaultLibraryPath(const std::string& game) {
+  std::error_code error;
+  const auto exe = std::filesystem::read_symlink("/proc/self/exe", error);
+  const auto libs = error ? std::filesystem::path("../lib")
+                          : exe.parent_path() / ".." / "lib";
+  return (libs / ("lib" + game + ".so")).string();
+}
+
+};  // namespace brick_game
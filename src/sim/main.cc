@@ -0,0 +1,324 @@
+#include <getopt.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "archive.h"
+#include "game_library.h"
+#include "policy.h"
+#include "replay_player.h"
+#include "sim_stats.h"
+#include "work_stealing_pool.h"
+
+using namespace brick_game;
+
+namespace {
+
+struct Options {
+  std::string game_name = "snake";
+  SimGame game = SimGame::Snake;
+  std::string library;
+  std::string replay;
+  std::string archive;
+  int keyframe_interval = 0;
+  std::string seek;
+  std::size_t games = 1000;
+  std::uint32_t first_seed = 1;
+  PolicySpec policy;
+  unsigned threads = std::thread::hardware_concurrency();
+  std::uint64_t max_ticks = 100000;
+  int width = 0;
+  int length = 0;
+  bool per_game = false;
+};
+
+void PrintUsage(const char* name) {
+  std::cerr
+      << "usage: " << name << " [options]\n"
+      << "  -g, --game snake|tetris   game to play (snake)\n"
+      << "  -n, --games N             games to play, one per seed (1000)\n"
+      << "  -s, --seed S              first seed, games use S..S+N-1 (1)\n"
+      << "  -p, --policy P            random, greedy or script:FILE (random)\n"
+      << "  -t, --threads T           worker threads (one per core)\n"
+      << "  -m, --max-ticks M         ticks before a game is cut off (100000)\n"
+      << "  -W, --width W             board width\n"
+      << "  -L, --length L            board length\n"
+      << "  -l, --lib PATH            game library (../lib/lib<game>.so)\n"
+      << "  -r, --replay FILE         play a recorded session of the game\n"
+      << "  -a, --archive FILE        store every tick of the games in FILE,\n"
+      << "                            played one after another\n"
+      << "  -k, --keyframes K         ticks between archive keyframes (64)\n"
+      << "  -x, --seek G:T            print game G at tick T of the archive\n"
+      << "  -v, --per-game            print seed, score and length of games\n";
+}
+
+PolicySpec ParsePolicy(const std::string& text) {
+  PolicySpec spec;
+  const std::string script_prefix = "script:";
+  if (text == "random") {
+    spec.kind = PolicyKind::Random;
+  } else if (text == "greedy") {
+    spec.kind = PolicyKind::Greedy;
+  } else if (text.starts_with(script_prefix)) {
+    const std::string path = text.substr(script_prefix.size());
+    std::ifstream in(path);
+    if (!in) throw std::invalid_argument("cannot read " + path);
+    spec.kind = PolicyKind::Scripted;
+    spec.script = std::make_shared<const Script>(ParseScript(in));
+  } else {
+    throw std::invalid_argument("unknown policy " + text);
+  }
+  return spec;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  static const option kLongOptions[] = {
+      {"game", required_argument, nullptr, 'g'},
+      {"games", required_argument, nullptr, 'n'},
+      {"seed", required_argument, nullptr, 's'},
+      {"policy", required_argument, nullptr, 'p'},
+      {"threads", required_argument, nullptr, 't'},
+      {"max-ticks", required_argument, nullptr, 'm'},
+      {"width", required_argument, nullptr, 'W'},
+      {"length", required_argument, nullptr, 'L'},
+      {"lib", required_argument, nullptr, 'l'},
+      {"replay", required_argument, nullptr, 'r'},
+      {"archive", required_argument, nullptr, 'a'},
+      {"keyframes", required_argument, nullptr, 'k'},
+      {"seek", required_argument, nullptr, 'x'},
+      {"per-game", no_argument, nullptr, 'v'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+  Options options;
+  int option;
+  while ((option = getopt_long(argc, argv, "g:n:s:p:t:m:W:L:l:r:a:k:x:vh",
+                               kLongOptions, nullptr)) != -1) {
+    switch (option) {
+      case 'g':
+        options.game_name = optarg;
+        break;
+      case 'n':
+        options.games = std::stoul(optarg);
+        break;
+      case 's':
+        options.first_seed = std::stoul(optarg);
+        break;
+      case 'p':
+        options.policy = ParsePolicy(optarg);
+        break;
+      case 't':
+        options.threads = std::stoul(optarg);
+        break;
+      case 'm':
+        options.max_ticks = std::stoull(optarg);
+        break;
+      case 'W':
+        options.width = std::stoi(optarg);
+        break;
+      case 'L':
+        options.length = std::stoi(optarg);
+        break;
+      case 'l':
+        options.library = optarg;
+        break;
+      case 'r':
+        options.replay = optarg;
+        break;
+      case 'a':
+        options.archive = optarg;
+        break;
+      case 'k':
+        options.keyframe_interval = std::stoi(optarg);
+        break;
+      case 'x':
+        options.seek = optarg;
+        break;
+      case 'v':
+        options.per_game = true;
+        break;
+      default:
+        PrintUsage(argv[0]);
+        std::exit(option == 'h' ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+  }
+  if (options.game_name == "snake")
+    options.game = SimGame::Snake;
+  else if (options.game_name == "tetris")
+    options.game = SimGame::Tetris;
+  else
+    throw std::invalid_argument("unknown game " + options.game_name);
+  if (options.library.empty())
+    options.library = DefaultLibraryPath(options.game_name);
+  return options;
+}
+
+// Plays one stepped game to its end: the policy moves, then the timer ticks.
+// Every tick goes to the archive if there is one
+GameResult PlayGame(const GameLibrary& lib, const Options& options,
+                    std::uint32_t seed, ArchiveWriter_t* archive = nullptr) {
+  BrickGameConfig_t config{};
+  config.width = options.width;
+  config.length = options.length;
+  config.seed = seed;
+  config.seeded = true;
+  config.stepped = true;
+  BrickGame_t* game = lib.create(&config);
+  if (!game) throw std::runtime_error("cannot create a game");
+  auto policy = MakePolicy(options.policy, options.game, seed);
+  auto over = [&] { return lib.frame(game)->level == 0; };
+
+  auto store = [&] {
+    if (archive && archiveAddFrame(archive, lib.frame(game)) != EXIT_SUCCESS)
+      throw std::runtime_error("cannot write to " + options.archive);
+  };
+
+  GameResult result{.seed = seed};
+  lib.input(game, Start, false);
+  if (archive) {
+    const BrickFrame_t* frame = lib.frame(game);
+    if (archiveBeginGame(archive, frame->width, frame->length) != EXIT_SUCCESS)
+      throw std::runtime_error("cannot write to " + options.archive);
+  }
+  store();
+  while (!over() && result.ticks < options.max_ticks) {
+    policy->Play(lib, game);
+    if (!over()) {
+      lib.step(game, 1);
+      ++result.ticks;
+      store();
+    }
+  }
+  result.finished = over();
+  result.score = lib.frame(game)->score;
+  lib.destroy(game);
+  return result;
+}
+
+// Plays a game per seed on all workers and prints the summary
+void RunBatch(const GameLibrary& lib, const Options& options) {
+  std::vector<GameResult> results(options.games);
+  std::exception_ptr error;
+  std::mutex error_mtx;
+  unsigned workers = 1;
+  std::uint64_t steals = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  if (options.archive.empty()) {
+    WorkStealingPool pool(options.threads);
+    pool.Run(options.games, [&](unsigned, std::size_t i) {
+      try {
+        results[i] = PlayGame(lib, options, options.first_seed + i);
+      } catch (...) {
+        std::scoped_lock<std::mutex> lock(error_mtx);
+        if (!error) error = std::current_exception();
+      }
+    });
+    workers = pool.GetWorkers();
+    steals = pool.GetSteals();
+  } else {
+    // Game G of the archive is the game of seed S + G, so the games are
+    // played one after another on this thread
+    ArchiveWriter_t* archive =
+        archiveCreate(options.archive.c_str(), options.keyframe_interval);
+    if (!archive) throw std::runtime_error("cannot write " + options.archive);
+    try {
+      for (std::size_t i = 0; i < options.games; ++i)
+        results[i] = PlayGame(lib, options, options.first_seed + i, archive);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (archiveFinish(archive) != EXIT_SUCCESS && !error)
+      throw std::runtime_error("cannot write " + options.archive);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (error) std::rethrow_exception(error);
+
+  if (options.per_game) {
+    std::cout << "seed score ticks finished\n";
+    for (const auto& result : results)
+      std::cout << result.seed << ' ' << result.score << ' ' << result.ticks
+                << ' ' << result.finished << '\n';
+  }
+  std::cout << "game:         " << options.game_name << '\n';
+  std::cout << "threads:      " << workers << " (" << steals
+            << " games stolen)\n";
+  PrintSummary(std::cout, Summarize(std::move(results), elapsed.count()));
+}
+
+// Plays one recorded session as fast as the engine goes
+void RunReplay(const GameLibrary& lib, const Options& options) {
+  const auto start = std::chrono::steady_clock::now();
+  const ReplayResult result = PlayReplay(lib, options.replay);
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "game:         " << options.game_name << '\n';
+  std::cout << "inputs:       " << result.inputs << '\n';
+  std::cout << "ticks:        " << result.ticks << '\n';
+  std::cout << "score:        " << result.score << '\n';
+  std::cout << "finished:     " << (result.finished ? "yes" : "no") << '\n';
+  std::cout << "elapsed:      " << elapsed.count() << " ms\n";
+}
+
+// Rebuilds one tick of an archived game and prints it with the seek time
+void RunSeek(const Options& options) {
+  int game{};
+  unsigned long long tick{};
+  if (options.archive.empty() ||
+      std::sscanf(options.seek.c_str(), "%d:%llu", &game, &tick) != 2)
+    throw std::invalid_argument("--seek G:T needs --archive FILE");
+  std::unique_ptr<ArchiveReader_t, decltype(&archiveClose)> reader(
+      archiveOpen(options.archive.c_str()), archiveClose);
+  if (!reader) throw std::runtime_error("cannot read " + options.archive);
+  const auto start = std::chrono::steady_clock::now();
+  const BrickFrame_t* frame = archiveSeek(reader.get(), game, tick);
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (!frame)
+    throw std::invalid_argument("no tick " + std::to_string(tick) +
+                                " in game " + std::to_string(game) + " of " +
+                                std::to_string(archiveGames(reader.get())));
+  for (int y = 0; y < frame->length; ++y) {
+    for (int x = 0; x < frame->width; ++x)
+      std::cout << (frame->cells[y * frame->width + x] ? '#' : '.');
+    std::cout << '\n';
+  }
+  std::cout << "game:         " << game << " of "
+            << archiveGames(reader.get()) << '\n';
+  std::cout << "tick:         " << tick << " of "
+            << archiveTicks(reader.get(), game) << '\n';
+  std::cout << "score:        " << frame->score << '\n';
+  std::cout << "level:        " << frame->level << '\n';
+  std::cout << "elapsed:      " << elapsed.count() << " us\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int exit_code = EXIT_SUCCESS;
+  try {
+    const Options options = ParseOptions(argc, argv);
+    if (!options.seek.empty()) {
+      RunSeek(options);
+    } else {
+      const GameLibrary lib(options.library);
+      if (options.replay.empty())
+        RunBatch(lib, options);
+      else
+        RunReplay(lib, options);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << argv[0] << ": " << e.what() << '\n';
+    exit_code = EXIT_FAILURE;
+  }
+  return exit_code;
+}
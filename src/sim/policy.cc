@@ -0,0 +1,319 @@
+#include "policy.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "colors.h"
+
+namespace brick_game {
+
+namespace {
+
+// FieldCellState_t of the tetris engine: the falling piece is drawn with its
+// shape, everything else that is not empty has landed
+constexpr std::uint8_t kTetrisFirstShape = 3;
+
+struct RandomPolicy : public Policy {
+  explicit RandomPolicy(std::uint32_t seed) : gen_(seed) {}
+
+  // Any move or nothing, with the same odds
+  void Play(const GameLibrary& lib, BrickGame_t* game) override {
+    static constexpr UserAction_t kMoves[] = {Left, Right, Up, Down, Action};
+    std::uniform_int_distribution<int> dist(0, std::size(kMoves));
+    const int move = dist(gen_);
+    if (move < static_cast<int>(std::size(kMoves)))
+      lib.input(game, kMoves[move], false);
+  }
+
+ private:
+  std::mt19937 gen_;
+};
+
+struct ScriptedPolicy : public Policy {
+  explicit ScriptedPolicy(std::shared_ptr<const Script> script)
+      : script_(std::move(script)) {}
+
+  // Past its end the script only lets the game tick
+  void Play(const GameLibrary& lib, BrickGame_t* game) override {
+    if (turn_ < script_->size()) {
+      for (const auto& [action, hold] : (*script_)[turn_])
+        lib.input(game, action, hold);
+      ++turn_;
+    }
+  }
+
+ private:
+  std::shared_ptr<const Script> script_;
+  std::size_t turn_{};
+};
+
+// Heads for the apple along the shortest way that does not box the snake in.
+// The head is not marked on the field: it is the body cell that appeared
+// since the previous turn
+struct GreedySnake : public Policy {
+  void Play(const GameLibrary& lib, BrickGame_t* game) override {
+    const BrickFrame_t* frame = lib.frame(game);
+    const int cells = frame->width * frame->length;
+    FindHead(frame->cells, cells);
+    previous_.assign(frame->cells, frame->cells + cells);
+    if (head_ >= 0) {
+      if (auto move = ChooseMove(frame)) lib.input(game, *move, false);
+    }
+  }
+
+ private:
+  std::vector<std::uint8_t> previous_;
+  int head_ = -1;
+
+  void FindHead(const std::uint8_t* cells, int count) {
+    if (static_cast<int>(previous_.size()) == count) {
+      for (int n{}; n < count; ++n)
+        if (cells[n] == Green && previous_[n] != Green) head_ = n;
+    }
+  }
+
+  // Cells reachable from a cell without crossing the body
+  static int FreeArea(const BrickFrame_t* frame, int start) {
+    const int width = frame->width;
+    std::vector<bool> seen(width * frame->length);
+    std::vector<int> stack{start};
+    seen[start] = true;
+    int area{};
+    while (!stack.empty()) {
+      const int n = stack.back();
+      stack.pop_back();
+      ++area;
+      const int y = n / width, x = n % width;
+      const int next[] = {y > 0 ? n - width : -1,
+                          y + 1 < frame->length ? n + width : -1,
+                          x > 0 ? n - 1 : -1, x + 1 < width ? n + 1 : -1};
+      for (int m : next) {
+        if (m >= 0 && !seen[m] && frame->cells[m] != Green) {
+          seen[m] = true;
+          stack.push_back(m);
+        }
+      }
+    }
+    return area;
+  }
+
+  std::optional<UserAction_t> ChooseMove(const BrickFrame_t* frame) const {
+    static constexpr struct {
+      UserAction_t action;
+      int dy, dx;
+    } kMoves[] = {{Up, -1, 0}, {Down, 1, 0}, {Left, 0, -1}, {Right, 0, 1}};
+    const int width = frame->width, cells = width * frame->length;
+    const int apple = static_cast<int>(
+        std::find(frame->cells, frame->cells + cells, Red) - frame->cells);
+    const int body = static_cast<int>(
+        std::count(frame->cells, frame->cells + cells, Green));
+    std::optional<UserAction_t> best;
+    bool best_roomy = false;
+    int best_distance{}, best_area{};
+    for (const auto& move : kMoves) {
+      const int y = head_ / width + move.dy, x = head_ % width + move.dx;
+      const int n = y * width + x;
+      if (y < 0 || y >= frame->length || x < 0 || x >= width ||
+          frame->cells[n] == Green)
+        continue;
+      const int area = FreeArea(frame, n);
+      const bool roomy = area > body;
+      const int distance = apple < cells ? std::abs(y - apple / width) +
+                                               std::abs(x - apple % width)
+                                         : 0;
+      if (!best || roomy > best_roomy ||
+          (roomy == best_roomy &&
+           (distance < best_distance ||
+            (distance == best_distance && area > best_area)))) {
+        best = move.action;
+        best_roomy = roomy;
+        best_distance = distance;
+        best_area = area;
+      }
+    }
+    return best;
+  }
+};
+
+// Tries every rotation in every column and hard drops the piece where the
+// field scores best by height, holes, bumpiness and cleared lines
+struct GreedyTetris : public Policy {
+  void Play(const GameLibrary& lib, BrickGame_t* game) override {
+    // Upright pieces reach up to three rows above their top cell, so the
+    // piece comes down until every rotation is in view
+    for (std::size_t moves{}; moves < kPieceCells; ++moves) {
+      const auto piece = ReadPiece(lib.frame(game));
+      if (piece.size() == kPieceCells &&
+          piece.front().first >= static_cast<int>(kPieceCells) - 1)
+        break;
+      lib.input(game, Down, false);
+    }
+    if (ReadPiece(lib.frame(game)).size() != kPieceCells) return;
+    std::optional<Placement> best;
+    for (int turns{}; turns < kRotations; ++turns) {
+      const BrickFrame_t* frame = lib.frame(game);
+      const auto piece = ReadPiece(frame);
+      if (piece.size() == kPieceCells) {
+        const auto placement = BestColumn(frame, piece, turns);
+        if (placement && (!best || placement->score > best->score))
+          best = placement;
+      }
+      lib.input(game, Action, false);
+    }
+    if (best) {
+      for (int turns{}; turns < best->turns; ++turns)
+        lib.input(game, Action, false);
+      Shift(lib, game, best->column);
+      lib.input(game, Down, true);
+    }
+  }
+
+ private:
+  static constexpr std::size_t kPieceCells = 4;
+  static constexpr int kRotations = 4;
+
+  struct Placement {
+    int turns;
+    int column;
+    double score;
+  };
+
+  using Piece = std::vector<std::pair<int, int>>;
+
+  static Piece ReadPiece(const BrickFrame_t* frame) {
+    Piece piece;
+    for (int n{}; n < frame->width * frame->length; ++n)
+      if (frame->cells[n] >= kTetrisFirstShape)
+        piece.emplace_back(n / frame->width, n % frame->width);
+    return piece;
+  }
+
+  static int LeftColumn(const Piece& piece) {
+    int left = piece.front().second;
+    for (const auto& cell : piece) left = std::min(left, cell.second);
+    return left;
+  }
+
+  static void Shift(const GameLibrary& lib, BrickGame_t* game, int column) {
+    for (int moves{}; moves < lib.frame(game)->width; ++moves) {
+      const auto piece = ReadPiece(lib.frame(game));
+      if (piece.empty() || LeftColumn(piece) == column) break;
+      const int before = LeftColumn(piece);
+      lib.input(game, before < column ? Right : Left, false);
+      const auto moved = ReadPiece(lib.frame(game));
+      if (moved.empty() || LeftColumn(moved) == before) break;
+    }
+  }
+
+  static std::optional<Placement> BestColumn(const BrickFrame_t* frame,
+                                             const Piece& piece, int turns) {
+    const int width = frame->width, length = frame->length;
+    std::vector<std::uint8_t> board(frame->cells,
+                                    frame->cells + width * length);
+    for (auto& cell : board) cell = cell && cell < kTetrisFirstShape;
+    const int left = LeftColumn(piece);
+    int span{};
+    for (const auto& cell : piece) span = std::max(span, cell.second - left);
+    std::optional<Placement> best;
+    for (int column{}; column + span < width; ++column) {
+      const int shift = column - left;
+      auto fits = [&](int drop) {
+        for (const auto& [y, x] : piece)
+          if (y + drop >= length || board[(y + drop) * width + x + shift])
+            return false;
+        return true;
+      };
+      if (!fits(0)) continue;
+      int drop{};
+      while (fits(drop + 1)) ++drop;
+      auto placed = board;
+      for (const auto& [y, x] : piece)
+        placed[(y + drop) * width + x + shift] = 1;
+      const double score = Evaluate(placed, width, length);
+      if (!best || score > best->score) best = Placement{turns, column, score};
+    }
+    return best;
+  }
+
+  // Weights of the well known hand tuned Tetris evaluation
+  static double Evaluate(std::vector<std::uint8_t>& board, int width,
+                         int length) {
+    int lines{};
+    for (int y = length - 1; y >= 0; --y) {
+      const auto row = board.begin() + y * width;
+      if (std::all_of(row, row + width, [](std::uint8_t c) { return c; })) {
+        std::copy_backward(board.begin(), row, row + width);
+        std::fill(board.begin(), board.begin() + width, 0);
+        ++lines;
+        ++y;
+      }
+    }
+    int height_sum{}, holes{}, bumpiness{}, previous{};
+    for (int x{}; x < width; ++x) {
+      int top = length;
+      for (int y{}; y < length; ++y) {
+        if (board[y * width + x])
+          top = std::min(top, y);
+        else if (top < y)
+          ++holes;
+      }
+      const int height = length - top;
+      height_sum += height;
+      if (x) bumpiness += std::abs(height - previous);
+      previous = height;
+    }
+    return -0.510066 * height_sum + 0.760666 * lines - 0.35663 * holes -
+           0.184483 * bumpiness;
+  }
+};
+
+}  // namespace
+
+Script ParseScript(std::istream& in) {
+  static const std::map<std::string, ScriptedInput> kWords = {
+      {"left", {Left, false}},     {"right", {Right, false}},
+      {"up", {Up, false}},         {"down", {Down, false}},
+      {"action", {Action, false}}, {"drop", {Down, true}}};
+  Script script;
+  std::string line;
+  while (std::getline(in, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    auto& turn = script.emplace_back();
+    for (std::string word; words >> word;) {
+      const auto input = kWords.find(word);
+      if (input == kWords.end())
+        throw std::invalid_argument("unknown script input \"" + word + "\"");
+      turn.push_back(input->second);
+    }
+  }
+  return script;
+}
+
+std::unique_ptr<Policy> MakePolicy(const PolicySpec& spec, SimGame game,
+                                   std::uint32_t seed) {
+  std::unique_ptr<Policy> policy;
+  switch (spec.kind) {
+    case PolicyKind::Random:
+      policy = std::make_unique<RandomPolicy>(seed);
+      break;
+    case PolicyKind::Scripted:
+      if (!spec.script) throw std::invalid_argument("no script given");
+      policy = std::make_unique<ScriptedPolicy>(spec.script);
+      break;
+    case PolicyKind::Greedy:
+      if (game == SimGame::Snake)
+        policy = std::make_unique<GreedySnake>();
+      else
+        policy = std::make_unique<GreedyTetris>();
+      break;
+  }
+  return policy;
+}
+
+};  // namespace brick_game
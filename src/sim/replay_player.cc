@@ -0,0 +1,57 @@
+#include "replay_player.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "replay.h"
+
+namespace brick_game {
+
+namespace {
+
+// bg_step() takes an int, long gaps go in several calls
+void StepTo(const GameLibrary& lib, BrickGame_t* game, std::uint64_t& tick,
+            std::uint64_t target) {
+  while (tick < target) {
+    const auto ticks = std::min<std::uint64_t>(
+        target - tick, std::numeric_limits<int>::max());
+    lib.step(game, static_cast<int>(ticks));
+    tick += ticks;
+  }
+}
+
+}  // namespace
+
+ReplayResult PlayReplay(const GameLibrary& lib, const std::string& path) {
+  ReplayHeader_t header{};
+  std::unique_ptr<ReplayReader_t, decltype(&replayClose)> reader(
+      replayOpen(path.c_str(), &header), replayClose);
+  if (!reader) throw std::runtime_error("cannot read replay " + path);
+
+  BrickGameConfig_t config{};
+  config.width = header.width;
+  config.length = header.length;
+  config.seed = header.seed;
+  config.seeded = true;
+  config.stepped = true;
+  std::unique_ptr<BrickGame_t, decltype(lib.destroy)> game(lib.create(&config),
+                                                           lib.destroy);
+  if (!game) throw std::runtime_error("cannot create a game for " + path);
+
+  ReplayResult result;
+  ReplayEvent_t event;
+  while (replayNext(reader.get(), &event)) {
+    StepTo(lib, game.get(), result.ticks, event.tick);
+    lib.input(game.get(), event.action, event.hold);
+    ++result.inputs;
+  }
+  StepTo(lib, game.get(), result.ticks, replayEndTick(reader.get()));
+  const BrickFrame_t* frame = lib.frame(game.get());
+  result.score = frame->score;
+  result.finished = frame->level == 0;
+  return result;
+}
+
+};  // namespace brick_game
@@ -0,0 +1,68 @@
+#include "sim_stats.h"
+
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <string>
+
+namespace brick_game {
+
+SimSummary Summarize(std::vector<GameResult> results, double seconds) {
+  SimSummary summary;
+  summary.games = results.size();
+  summary.seconds = seconds;
+  if (results.empty()) return summary;
+
+  std::int64_t score_sum{};
+  summary.min_score = summary.max_score = results.front().score;
+  for (const auto& result : results) {
+    score_sum += result.score;
+    summary.min_score = std::min(summary.min_score, result.score);
+    summary.max_score = std::max(summary.max_score, result.score);
+    summary.total_ticks += result.ticks;
+    if (result.finished) ++summary.finished;
+    const std::size_t bucket =
+        result.ticks ? std::bit_width(result.ticks) - 1 : 0;
+    if (summary.length_histogram.size() <= bucket)
+      summary.length_histogram.resize(bucket + 1);
+    ++summary.length_histogram[bucket];
+  }
+  summary.mean_score = static_cast<double>(score_sum) / results.size();
+
+  std::sort(results.begin(), results.end(),
+            [](const auto& a, const auto& b) { return a.ticks < b.ticks; });
+  const int percents[] = {10, 50, 90, 99, 100};
+  for (int p{}; p < 5; ++p) {
+    const std::size_t rank = (results.size() - 1) * percents[p] / 100;
+    summary.length_percentiles[p] = results[rank].ticks;
+  }
+  return summary;
+}
+
+void PrintSummary(std::ostream& out, const SimSummary& summary) {
+  const double seconds = summary.seconds > 0 ? summary.seconds : 1e-9;
+  out << std::fixed << std::setprecision(2);
+  out << "games:        " << summary.games << " (" << summary.finished
+      << " finished)\n";
+  out << "time:         " << summary.seconds << " s\n";
+  out << "games/sec:    " << summary.games / seconds << '\n';
+  out << "ticks/sec:    " << summary.total_ticks / seconds << '\n';
+  out << "score:        mean " << summary.mean_score << ", min "
+      << summary.min_score << ", max " << summary.max_score << '\n';
+  const auto& p = summary.length_percentiles;
+  out << "length ticks: p10 " << p[0] << ", p50 " << p[1] << ", p90 " << p[2]
+      << ", p99 " << p[3] << ", max " << p[4] << '\n';
+  const std::size_t widest = summary.length_histogram.empty()
+                                 ? 0
+                                 : *std::max_element(
+                                       summary.length_histogram.begin(),
+                                       summary.length_histogram.end());
+  for (std::size_t b{}; b < summary.length_histogram.size(); ++b) {
+    const std::size_t count = summary.length_histogram[b];
+    const std::size_t bar = widest ? count * 40 / widest : 0;
+    out << "  < " << std::setw(8) << (std::uint64_t{2} << b) << ' '
+        << std::setw(8) << count << ' ' << std::string(bar, '#') << '\n';
+  }
+}
+
+};  // namespace brick_game
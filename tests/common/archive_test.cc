@@ -0,0 +1,162 @@
+#include "archive.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 6;
+constexpr int kLength = 5;
+constexpr int kInterval = 4;
+constexpr int kTicks = 20;
+constexpr std::uint8_t kColor = 0x40;
+
+// Where archive.c puts the version and the index offset in its header
+constexpr std::size_t kVersionOffset = 4;
+constexpr std::size_t kIndexOffset = 16;
+
+// Field of a made-up game: each tick lights one more cell, in its own color
+std::vector<std::uint8_t> Cells(int game, int tick) {
+  const int count = (kWidth + game) * kLength;
+  std::vector<std::uint8_t> cells(count);
+  for (int t = 1; t <= tick; ++t) cells[(t * 7 + game) % count] = kColor + t;
+  return cells;
+}
+
+std::vector<char> ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in),
+          std::istreambuf_iterator<char>()};
+}
+
+void WriteFile(const std::string& path, const std::vector<char>& bytes) {
+  std::ofstream(path, std::ios::binary).write(bytes.data(), bytes.size());
+}
+
+class ArchiveTest : public ::testing::Test {
+ protected:
+  // Two games of kTicks ticks, the second one a column wider
+  void SetUp() override {
+    ArchiveWriter_t* writer = archiveCreate(path_.c_str(), kInterval);
+    ASSERT_NE(writer, nullptr);
+    for (int g = 0; g < 2; ++g) {
+      ASSERT_EQ(archiveBeginGame(writer, kWidth + g, kLength), EXIT_SUCCESS);
+      for (int t = 0; t < kTicks; ++t) {
+        const std::vector<std::uint8_t> cells = Cells(g, t);
+        BrickFrame_t frame{};
+        frame.width = kWidth + g;
+        frame.length = kLength;
+        frame.cells = cells.data();
+        frame.dirty_count = -1;
+        frame.score = t;
+        ASSERT_EQ(archiveAddFrame(writer, &frame), EXIT_SUCCESS);
+      }
+    }
+    ASSERT_EQ(archiveFinish(writer), EXIT_SUCCESS);
+    bytes_ = ReadFile(path_);
+  }
+
+  void TearDown() override {
+    std::remove(path_.c_str());
+    std::remove(damaged_.c_str());
+  }
+
+  // Opens a copy of the archive with its bytes changed
+  ArchiveReader_t* OpenDamaged(const std::vector<char>& bytes) {
+    WriteFile(damaged_, bytes);
+    return archiveOpen(damaged_.c_str());
+  }
+
+  const std::string path_ = testing::TempDir() + "archive_test.bga";
+  const std::string damaged_ = testing::TempDir() + "archive_damaged.bga";
+  std::vector<char> bytes_;
+};
+
+TEST_F(ArchiveTest, SeeksToAnyTick) {
+  ArchiveReader_t* reader = archiveOpen(path_.c_str());
+  ASSERT_NE(reader, nullptr);
+  ASSERT_EQ(archiveGames(reader), 2);
+  // Backwards, so every seek starts from a keyframe of its own
+  for (int g = 1; g >= 0; --g) {
+    ASSERT_EQ(archiveTicks(reader, g), static_cast<std::uint64_t>(kTicks));
+    for (int t = kTicks - 1; t >= 0; --t) {
+      const BrickFrame_t* frame = archiveSeek(reader, g, t);
+      ASSERT_NE(frame, nullptr);
+      EXPECT_EQ(frame->width, kWidth + g);
+      EXPECT_EQ(frame->score, t);
+      const std::vector<std::uint8_t> cells = Cells(g, t);
+      EXPECT_TRUE(std::equal(cells.begin(), cells.end(), frame->cells))
+          << "game " << g << " tick " << t;
+    }
+  }
+  EXPECT_EQ(archiveSeek(reader, 0, kTicks), nullptr);
+  EXPECT_EQ(archiveSeek(reader, 2, 0), nullptr);
+  EXPECT_EQ(archiveTicks(reader, 2), 0u);
+  archiveClose(reader);
+}
+
+TEST_F(ArchiveTest, RejectsDamagedFile) {
+  // Shorter than a header, then cut inside the index at the end
+  for (std::size_t size : {std::size_t{kIndexOffset}, bytes_.size() - 1}) {
+    std::vector<char> bytes(bytes_.begin(), bytes_.begin() + size);
+    EXPECT_EQ(OpenDamaged(bytes), nullptr) << size << " bytes";
+  }
+  std::vector<char> bytes = bytes_;
+  bytes[0] ^= 1;
+  EXPECT_EQ(OpenDamaged(bytes), nullptr);
+
+  bytes = bytes_;
+  const std::uint32_t version = ARCHIVE_VERSION + 1;
+  std::memcpy(bytes.data() + kVersionOffset, &version, sizeof(version));
+  EXPECT_EQ(OpenDamaged(bytes), nullptr);
+
+  bytes = bytes_;
+  const std::uint64_t index = bytes.size();
+  std::memcpy(bytes.data() + kIndexOffset, &index, sizeof(index));
+  EXPECT_EQ(OpenDamaged(bytes), nullptr);
+}
+
+TEST_F(ArchiveTest, RejectsDeltaOffTheBoard) {
+  // The only change of tick 1 of game 0, the first keyframe being blank
+  const std::uint32_t change = 7u << 8 | (kColor + 1);
+  char pattern[sizeof(change)];
+  std::memcpy(pattern, &change, sizeof(change));
+  std::vector<char> bytes = bytes_;
+  const auto found = std::search(bytes.begin(), bytes.end(), pattern,
+                                 pattern + sizeof(pattern));
+  ASSERT_NE(found, bytes.end());
+  const std::uint32_t off_board = (kWidth * kLength) << 8 | (kColor + 1);
+  std::memcpy(&*found, &off_board, sizeof(off_board));
+
+  ArchiveReader_t* reader = OpenDamaged(bytes);
+  ASSERT_NE(reader, nullptr);
+  EXPECT_NE(archiveSeek(reader, 0, 0), nullptr);
+  EXPECT_EQ(archiveSeek(reader, 0, 1), nullptr);
+  EXPECT_NE(archiveSeek(reader, 1, 1), nullptr);
+  archiveClose(reader);
+}
+
+TEST_F(ArchiveTest, RejectsGameSizeOutOfRange) {
+  ArchiveWriter_t* writer = archiveCreate(damaged_.c_str(), 0);
+  ASSERT_NE(writer, nullptr);
+  for (int size : {0, FIELD_MAX_SIZE + 1}) {
+    EXPECT_EQ(archiveBeginGame(writer, size, kLength), EXIT_FAILURE);
+    EXPECT_EQ(archiveBeginGame(writer, kWidth, size), EXIT_FAILURE);
+  }
+  EXPECT_EQ(archiveBeginGame(writer, 1, FIELD_MAX_SIZE), EXIT_SUCCESS);
+  EXPECT_EQ(archiveFinish(writer), EXIT_SUCCESS);
+
+  ArchiveReader_t* reader = archiveOpen(damaged_.c_str());
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(archiveGames(reader), 1);
+  archiveClose(reader);
+}
+
+}  // namespace
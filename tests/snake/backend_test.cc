@@ -0,0 +1,346 @@
+#include "backend.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "colors.h"
+#include "replay.h"
+
+namespace {
+
+bool SameField(const GameInfo_t& a, const GameInfo_t& b, int width,
+               int length) {
+  for (int y = 0; y < length; ++y)
+    for (int x = 0; x < width; ++x)
+      if (a.field[y][x] != b.field[y][x]) return false;
+  return true;
+}
+
+// Plays a log through a new stepped game, the way brickgame_sim does
+BrickGame_t* Replay(const std::string& path, std::uint64_t* inputs) {
+  ReplayHeader_t header{};
+  ReplayReader_t* reader = replayOpen(path.c_str(), &header);
+  if (!reader) return nullptr;
+  BrickGameConfig_t config{};
+  config.width = header.width;
+  config.length = header.length;
+  config.seed = header.seed;
+  config.seeded = true;
+  config.stepped = true;
+  BrickGame_t* game = bg_create(&config);
+  std::uint64_t tick{};
+  ReplayEvent_t event;
+  while (game && replayNext(reader, &event)) {
+    bg_step(game, static_cast<int>(event.tick - tick));
+    tick = event.tick;
+    bg_input(game, event.action, event.hold);
+    ++*inputs;
+  }
+  if (game) bg_step(game, static_cast<int>(replayEndTick(reader) - tick));
+  replayClose(reader);
+  return game;
+}
+
+}  // namespace
+
+TEST(BackendHandleTest, GamesAreIndependent) {
+  BrickGameConfig_t config{};
+  config.width = 12;
+  config.length = 24;
+  BrickGame_t* first = bg_create(&config);
+  BrickGame_t* second = bg_create(nullptr);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first, bg_default());
+
+  int width{}, length{};
+  bg_field_size(first, &width, &length);
+  EXPECT_EQ(width, 12);
+  EXPECT_EQ(length, 24);
+  bg_field_size(second, &width, &length);
+  EXPECT_EQ(width, FIELD_WIDTH);
+  EXPECT_EQ(length, FIELD_LENGTH);
+
+  bg_input(first, Start, false);
+  bg_input(first, Pause, false);
+  EXPECT_EQ(bg_state(first).pause, 1);
+  EXPECT_EQ(bg_state(second).pause, 0);
+  EXPECT_EQ(updateCurrentState().pause, 0);
+
+  bg_destroy(first);
+  bg_destroy(second);
+}
+
+TEST(BackendHandleTest, SameSeedSameBoard) {
+  BrickGameConfig_t config{};
+  config.seed = 2024;
+  config.seeded = true;
+  BrickGame_t* first = bg_create(&config);
+  BrickGame_t* second = bg_create(&config);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_TRUE(SameField(bg_state(first), bg_state(second), FIELD_WIDTH,
+                        FIELD_LENGTH));
+  bg_destroy(first);
+  bg_destroy(second);
+}
+
+TEST(BackendHandleTest, RejectsBadSize) {
+  BrickGameConfig_t config{};
+  config.width = FIELD_MAX_SIZE + 1;
+  EXPECT_EQ(bg_create(&config), nullptr);
+  bg_destroy(nullptr);
+  bg_destroy(bg_default());
+  EXPECT_NE(bg_default(), nullptr);
+}
+
+TEST(BackendHandleTest, FramesAreVersioned) {
+  BrickGameConfig_t config{};
+  config.width = 12;
+  config.length = 24;
+  BrickGame_t* game = bg_create(&config);
+  ASSERT_NE(game, nullptr);
+  const BrickFrame_t* frame = bg_frame(game);
+  EXPECT_EQ(frame->generation, bg_generation(game));
+  EXPECT_EQ(frame->width, 12);
+  EXPECT_EQ(frame->length, 24);
+  const GameInfo_t info = bg_state(game);
+  for (int y = 0; y < 24; ++y)
+    for (int x = 0; x < 12; ++x)
+      ASSERT_EQ(frame->cells[y * 12 + x], info.field[y][x]);
+
+  const uint64_t seen = frame->generation;
+  bg_input(game, Start, false);
+  bg_input(game, Pause, false);
+  EXPECT_GT(bg_generation(game), seen);
+  EXPECT_EQ(frame->generation, seen);
+  frame = bg_frame(game);
+  EXPECT_EQ(frame->pause, 1);
+  EXPECT_GT(frame->generation, seen);
+  EXPECT_LE(frame->generation, bg_generation(game));
+  bg_destroy(game);
+}
+
+TEST(BackendHandleTest, DestroysRunningGame) {
+  BrickGame_t* game = bg_create(nullptr);
+  ASSERT_NE(game, nullptr);
+  bg_input(game, Start, false);
+  EXPECT_NE(bg_state(game).level, 0);
+  bg_destroy(game);
+}
+
+TEST(BackendHandleTest, ScheduledGamesMoveOnTheirOwn) {
+  BrickGameConfig_t config{};
+  config.scheduled = true;
+  BrickGame_t* games[3];
+  uint64_t started[3];
+  for (int g = 0; g < 3; ++g) {
+    games[g] = bg_create(&config);
+    ASSERT_NE(games[g], nullptr);
+    bg_input(games[g], Start, false);
+    started[g] = bg_generation(games[g]);
+  }
+  // Every game advances on the shared workers within a few periods
+  for (int g = 0; g < 3; ++g) {
+    for (int i = 0; i < 200 && bg_generation(games[g]) == started[g]; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_GT(bg_generation(games[g]), started[g]);
+  }
+  bg_input(games[0], Pause, false);
+  EXPECT_EQ(bg_state(games[0]).pause, 1);
+  EXPECT_EQ(bg_state(games[1]).pause, 0);
+  for (auto* game : games) bg_destroy(game);
+}
+
+TEST(BackendHandleTest, SteppedGameMovesOnlyWhenTold) {
+  BrickGameConfig_t config{};
+  config.stepped = true;
+  BrickGame_t* game = bg_create(&config);
+  ASSERT_NE(game, nullptr);
+  bg_input(game, Start, false);
+  const uint64_t started = bg_generation(game);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(bg_generation(game), started);
+
+  bg_step(game, 1);
+  EXPECT_GT(bg_generation(game), started);
+  // The snake starts heading up and soon hits the wall
+  bg_step(game, FIELD_LENGTH);
+  EXPECT_EQ(bg_frame(game)->level, 0);
+  bg_destroy(game);
+}
+
+TEST(BackendHandleTest, FramesListChangedCells) {
+  BrickGameConfig_t config{};
+  config.stepped = true;
+  config.seeded = true;
+  config.seed = 3;
+  BrickGame_t* game = bg_create(&config);
+  ASSERT_NE(game, nullptr);
+  bg_input(game, Start, false);
+  const BrickFrame_t* frame = bg_frame(game);
+  std::vector<uint8_t> seen(frame->cells,
+                            frame->cells + frame->width * frame->length);
+  uint64_t generation = frame->generation;
+  int patched{};
+  while (frame->level) {
+    bg_step(game, 1);
+    frame = bg_frame(game);
+    if (frame->generation == generation + 1 && frame->dirty_count >= 0) {
+      // A move changes the head, the tail and maybe the apple
+      EXPECT_TRUE(!frame->level || frame->dirty_count <= 3);
+      for (int i = 0; i < frame->dirty_count; ++i)
+        seen[frame->dirty[i]] = frame->cells[frame->dirty[i]];
+      ++patched;
+    } else {
+      seen.assign(frame->cells, frame->cells + seen.size());
+    }
+    generation = frame->generation;
+    ASSERT_TRUE(std::equal(seen.begin(), seen.end(), frame->cells));
+  }
+  EXPECT_GT(patched, 0);
+  bg_destroy(game);
+}
+
+TEST(BackendHandleTest, WaitWakesOnNewFrame) {
+  BrickGameConfig_t config{};
+  config.stepped = true;
+  BrickGame_t* game = bg_create(&config);
+  ASSERT_NE(game, nullptr);
+  bg_input(game, Start, false);
+  const uint64_t seen = bg_generation(game);
+  // Nothing changes, the wait runs out
+  EXPECT_EQ(bg_wait(game, seen, 20), seen);
+  // An older generation returns at once
+  EXPECT_EQ(bg_wait(game, seen - 1, 5000), seen);
+
+  std::thread stepper([game] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    bg_step(game, 1);
+  });
+  EXPECT_GT(bg_wait(game, seen, 5000), seen);
+  stepper.join();
+  bg_destroy(game);
+}
+
+TEST(BackendHandleTest, PaletteCoversSnakeCells) {
+  const BrickPalette_t* palette = bg_palette();
+  ASSERT_NE(palette, nullptr);
+  EXPECT_EQ(palette, bg_palette());
+  // The snake, its food and the crashed body all have to show
+  for (int value : {Empty, Red, Green, Damaged})
+    EXPECT_NE(palette->entries[value].alpha, 0) << value;
+  EXPECT_STREQ(palette->entries[Damaged].glyph, "$ ");
+}
+
+TEST(BackendHandleTest, RecordedGamePlaysAgain) {
+  const std::string path = testing::TempDir() + "snake_test.replay";
+  BrickGameConfig_t config{};
+  config.stepped = true;
+  config.width = 12;
+  BrickGame_t* game = bg_create(&config);
+  ASSERT_NE(game, nullptr);
+  ASSERT_EQ(bg_record(game, path.c_str()), EXIT_SUCCESS);
+  bg_input(game, Start, false);
+  EXPECT_EQ(bg_record(game, path.c_str()), EXIT_FAILURE);
+  // Runs in small squares, held keys speed it up on some sides
+  const UserAction_t turns[] = {Left, Down, Right, Up};
+  std::uint64_t recorded{1};
+  for (int i = 0; i < 200 && bg_frame(game)->level; ++i) {
+    bg_input(game, turns[i % 4], i % 3 == 0);
+    ++recorded;
+    bg_step(game, 2 + i % 3);
+  }
+  // Time after the last input is played too
+  bg_step(game, 5);
+  ASSERT_EQ(bg_record(game, nullptr), EXIT_SUCCESS);
+  const BrickFrame_t* frame = bg_frame(game);
+  const std::vector<uint8_t> cells(frame->cells,
+                                   frame->cells + frame->width * frame->length);
+  const int score = frame->score;
+
+  std::uint64_t inputs{};
+  BrickGame_t* replay = Replay(path, &inputs);
+  ASSERT_NE(replay, nullptr);
+  EXPECT_EQ(inputs, recorded);
+  const BrickFrame_t* replayed = bg_frame(replay);
+  EXPECT_EQ(replayed->width, 12);
+  EXPECT_EQ(replayed->score, score);
+  EXPECT_EQ(replayed->level, frame->level);
+  EXPECT_TRUE(std::equal(cells.begin(), cells.end(), replayed->cells));
+  // A header and about a byte per input
+  EXPECT_LT(std::filesystem::file_size(path), 16 + 2 * inputs);
+  bg_destroy(replay);
+  bg_destroy(game);
+  std::remove(path.c_str());
+}
+
+TEST(BackendHandleTest, CheckpointForksAGame) {
+  BrickGameConfig_t config{};
+  config.stepped = true;
+  config.seeded = true;
+  config.seed = 7;
+  config.width = 12;
+  BrickGame_t* game = bg_create(&config);
+  ASSERT_NE(game, nullptr);
+  bg_input(game, Start, false);
+  const UserAction_t turns[] = {Left, Down, Right, Up};
+  for (int i = 0; i < 20; ++i) {
+    bg_input(game, turns[i % 4], false);
+    bg_step(game, 2);
+  }
+  ASSERT_NE(bg_frame(game)->level, 0);
+
+  std::vector<unsigned char> checkpoint(bg_save(game, nullptr, 0));
+  ASSERT_FALSE(checkpoint.empty());
+  EXPECT_EQ(bg_save(game, checkpoint.data(), checkpoint.size() - 1),
+            checkpoint.size());
+  ASSERT_EQ(bg_save(game, checkpoint.data(), checkpoint.size()),
+            checkpoint.size());
+
+  // A fork of another size takes over the board and the apples to come
+  config.seed = 8;
+  config.width = 0;
+  BrickGame_t* fork = bg_create(&config);
+  ASSERT_NE(fork, nullptr);
+  EXPECT_EQ(bg_restore(fork, checkpoint.data(), checkpoint.size() - 1),
+            EXIT_FAILURE);
+  checkpoint[0] ^= 1;
+  EXPECT_EQ(bg_restore(fork, checkpoint.data(), checkpoint.size()),
+            EXIT_FAILURE);
+  checkpoint[0] ^= 1;
+  ASSERT_EQ(bg_restore(fork, checkpoint.data(), checkpoint.size()),
+            EXIT_SUCCESS);
+
+  for (int i = 0; i < 100 && bg_frame(game)->level; ++i) {
+    for (BrickGame_t* g : {game, fork}) {
+      bg_input(g, turns[i % 4], i % 5 == 0);
+      bg_step(g, 1 + i % 3);
+    }
+    const BrickFrame_t* a = bg_frame(game);
+    const BrickFrame_t* b = bg_frame(fork);
+    ASSERT_EQ(b->width, 12);
+    ASSERT_EQ(b->score, a->score);
+    ASSERT_EQ(b->level, a->level);
+    ASSERT_TRUE(std::equal(a->cells, a->cells + a->width * a->length,
+                           b->cells))
+        << "step " << i;
+  }
+  bg_destroy(fork);
+  bg_destroy(game);
+
+  // Only stepped games have checkpoints
+  BrickGame_t* realtime = bg_create(nullptr);
+  ASSERT_NE(realtime, nullptr);
+  EXPECT_EQ(bg_save(realtime, nullptr, 0), 0u);
+  EXPECT_EQ(bg_restore(realtime, checkpoint.data(), checkpoint.size()),
+            EXIT_FAILURE);
+  bg_destroy(realtime);
+}
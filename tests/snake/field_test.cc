@@ -156,3 +156,100 @@ TEST_F(FieldTest, GetNthFreeCell_RandomAccess) {
     });
   }
 }
+
+TEST_F(FieldTest, GetNthFreeCell_MatchesScanAcrossWords) {
+  // Fill an irregular pattern spanning every 64-bit word of the field
+  for (int i = 0; i < field.TotalCells(); ++i) {
+    if (i % 3 == 0 || i % 7 == 0)
+      field.FillCell({i / FIELD_WIDTH, i % FIELD_WIDTH});
+  }
+  int n = 0;
+  for (int i = 0; i < field.TotalCells(); ++i) {
+    const brick_game::Cell expected{i / FIELD_WIDTH, i % FIELD_WIDTH};
+    if (field.CheckCell(expected)) continue;
+    EXPECT_EQ(field.GetNthFreeCell(n), expected) << "n = " << n;
+    ++n;
+  }
+  EXPECT_EQ(field.GetNthFreeCell(n), brick_game::Cell(0, 0));
+}
+
+TEST_F(FieldTest, GetNthFreeCell_LastCell) {
+  const int last = field.TotalCells() - 1;
+  for (int i = 0; i < last; ++i)
+    field.FillCell({i / FIELD_WIDTH, i % FIELD_WIDTH});
+  EXPECT_EQ(field.GetNthFreeCell(0),
+            brick_game::Cell(last / FIELD_WIDTH, last % FIELD_WIDTH));
+  EXPECT_EQ(field.GetNthFreeCell(1), brick_game::Cell(0, 0));
+  field.EmptyCell({0, 5});
+  EXPECT_EQ(field.GetNthFreeCell(0), brick_game::Cell(0, 5));
+}
+
+TEST(FieldSizeTest, NonClassicBoard) {
+  brick_game::Field field({7, 13});
+  EXPECT_EQ(field.TotalCells(), 7 * 13);
+  EXPECT_EQ(field.GetNthFreeCell(8), brick_game::Cell(1, 1));
+  field.FillCell({12, 6});
+  EXPECT_TRUE(field.CheckCell({12, 6}));
+  EXPECT_EQ(field.GetNthFreeCell(7 * 13 - 2), brick_game::Cell(12, 5));
+  EXPECT_EQ(field.GetNthFreeCell(7 * 13 - 1), brick_game::Cell(0, 0));
+
+  GameInfo_t info{};
+  field.PlaceFieldAndNext(info, false);
+  EXPECT_EQ(info.field[12][6], Green);
+  EXPECT_EQ(info.field[12][5], Empty);
+}
+
+TEST(FieldSizeTest, PackedCellsBackLegacyTables) {
+  brick_game::Field field({6, 8});
+  field.FillCell({2, 3});
+  const std::uint8_t* cells = field.GetCells(false);
+  field.PlaceApple({5, 1});
+  EXPECT_EQ(cells[2 * 6 + 3], Green);
+  EXPECT_EQ(cells[5 * 6 + 1], Red);
+  EXPECT_EQ(cells[0], Empty);
+
+  GameInfo_t info{};
+  field.PlaceFieldAndNext(info, false);
+  for (int y = 0; y < 8; ++y)
+    for (int x = 0; x < 6; ++x) EXPECT_EQ(info.field[y][x], cells[y * 6 + x]);
+  EXPECT_EQ(info.next[0][0], Empty);
+
+  field.PlaceFieldAndNext(info, true);
+  EXPECT_EQ(info.field[2][3], Damaged);
+  EXPECT_EQ(info.field[5][1], Empty);
+}
+
+TEST(FieldSizeTest, LargestBoard) {
+  brick_game::Field field({FIELD_MAX_SIZE, FIELD_MAX_SIZE});
+  const int last = field.TotalCells() - 1;
+  EXPECT_EQ(field.GetNthFreeCell(last),
+            brick_game::Cell(FIELD_MAX_SIZE - 1, FIELD_MAX_SIZE - 1));
+}
+
+TEST(FieldSizeTest, ViewFollowsEveryChange) {
+  brick_game::Field field({6, 8});
+  field.FillCell({1, 1});
+  field.FillCell({1, 2});
+  const std::uint8_t* cells = field.GetCells(false);
+  // A move: head in, tail out, apple moved on
+  field.FillCell({1, 3});
+  field.EmptyCell({1, 1});
+  cells = field.GetCells(false);
+  field.PlaceApple({4, 4});
+  EXPECT_EQ(cells[1 * 6 + 1], Empty);
+  EXPECT_EQ(cells[1 * 6 + 2], Green);
+  EXPECT_EQ(cells[1 * 6 + 3], Green);
+  EXPECT_EQ(cells[4 * 6 + 4], Red);
+  // The snake eats the apple
+  field.FillCell({4, 4});
+  cells = field.GetCells(false);
+  EXPECT_EQ(cells[4 * 6 + 4], Green);
+
+  // More changes at once than a move makes
+  for (int x = 0; x < 6; ++x)
+    for (int y = 5; y < 8; ++y) field.FillCell({y, x});
+  cells = field.GetCells(false);
+  EXPECT_EQ(std::count(cells, cells + 48, Green), 3 + 18);
+  cells = field.GetCells(true);
+  EXPECT_EQ(std::count(cells, cells + 48, Damaged), 3 + 18);
+}
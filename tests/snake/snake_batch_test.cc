@@ -0,0 +1,166 @@
+#include "snake_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace brick_game;
+
+namespace {
+
+// Counts what the snake tells the rest of the game
+class CountingMediator : public Mediator {
+ public:
+  int points{};
+  bool over{};
+
+  void Notify(Event e) override {
+    if (e == Event::ScorePoint) ++points;
+    if (e == Event::GameOver) over = true;
+    Mediator::Notify(e);
+  }
+};
+
+struct Reference {
+  std::shared_ptr<CountingMediator> mediator;
+  Snake snake;
+
+  Reference(std::uint32_t seed, BoardSize size)
+      : mediator(std::make_shared<CountingMediator>()),
+        snake(mediator, RandomEngine{seed}, size) {}
+};
+
+std::vector<std::uint8_t> ReferenceCells(Reference& game, int cells) {
+  std::vector<std::uint8_t> copy(cells);
+  game.snake.VisitCells(game.mediator->over, [&](const std::uint8_t* c) {
+    std::copy_n(c, cells, copy.begin());
+  });
+  return copy;
+}
+
+std::vector<std::uint8_t> BatchCells(const SnakeBatch& batch, int game) {
+  std::vector<std::uint8_t> cells(batch.GetBoardSize().Cells());
+  batch.GetCells(game, cells.data());
+  return cells;
+}
+
+}  // namespace
+
+TEST(SnakeBatchTest, StartsLikeSnake) {
+  const std::vector<std::uint32_t> seeds = {1, 2, 3};
+  SnakeBatch batch(seeds);
+  ASSERT_EQ(batch.GetGames(), 3);
+  for (int g{}; g < batch.GetGames(); ++g) {
+    Reference reference(seeds[g], {});
+    EXPECT_TRUE(batch.IsAlive(g));
+    EXPECT_EQ(batch.GetScore(g), 0);
+    EXPECT_EQ(batch.GetLevel(g), 1);
+    EXPECT_EQ(batch.GetLength(g), 4);
+    EXPECT_EQ(BatchCells(batch, g),
+              ReferenceCells(reference, BoardSize{}.Cells()));
+  }
+}
+
+TEST(SnakeBatchTest, IgnoresReversal) {
+  const std::vector<std::uint32_t> seeds = {7};
+  SnakeBatch batch(seeds);
+  const Cell head = batch.GetHead(0);
+  const std::vector<MovementAction> down = {MovementAction::Down};
+  batch.StepAll(down);
+  EXPECT_TRUE(batch.IsAlive(0));
+  EXPECT_EQ(batch.GetHead(0).first, head.first);
+  const std::vector<MovementAction> keep = {MovementAction::Action};
+  batch.StepAll(keep);
+  EXPECT_EQ(batch.GetHead(0).first, head.first - 1);
+  EXPECT_EQ(batch.GetHead(0).second, head.second);
+}
+
+TEST(SnakeBatchTest, DiesOnTheWall) {
+  const std::vector<std::uint32_t> seeds = {7};
+  SnakeBatch batch(seeds);
+  const std::vector<MovementAction> up = {MovementAction::Up};
+  for (int n{}; n < BoardSize{}.length && batch.IsAlive(0); ++n)
+    batch.StepAll(up);
+  EXPECT_FALSE(batch.IsAlive(0));
+  EXPECT_EQ(batch.GetLevel(0), 0);
+  // An over game no longer moves
+  const Cell head = batch.GetHead(0);
+  batch.StepAll(up);
+  EXPECT_EQ(batch.GetHead(0).first, head.first);
+  const auto cells = BatchCells(batch, 0);
+  EXPECT_EQ(std::count(cells.begin(), cells.end(), Damaged),
+            batch.GetLength(0));
+  EXPECT_EQ(std::count(cells.begin(), cells.end(), Red), 0);
+}
+
+// Every game of the batch plays exactly like its own Snake
+TEST(SnakeBatchTest, PlaysLikeSnake) {
+  const BoardSize size{6, 8};
+  constexpr int kGames = 48;
+  constexpr int kSteps = 600;
+  std::vector<std::uint32_t> seeds(kGames);
+  for (int g{}; g < kGames; ++g) seeds[g] = 100 + g;
+  SnakeBatch batch(seeds, size);
+  std::vector<std::unique_ptr<Reference>> references;
+  for (auto seed : seeds)
+    references.push_back(std::make_unique<Reference>(seed, size));
+
+  // Mostly straight on, so games live long enough to eat
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int> dist(0, 9);
+  std::vector<MovementAction> actions(kGames);
+  int max_score{};
+  for (int step{}; step < kSteps; ++step) {
+    for (auto& action : actions) {
+      const int n = dist(gen);
+      action = static_cast<MovementAction>(n < 5 ? n : 4);
+    }
+    batch.StepAll(actions);
+    for (int g{}; g < kGames; ++g) {
+      Reference& reference = *references[g];
+      if (!reference.mediator->over) reference.snake.Move(actions[g], false);
+      ASSERT_EQ(batch.IsAlive(g), !reference.mediator->over)
+          << "game " << g << " step " << step;
+      ASSERT_EQ(batch.GetScore(g), reference.mediator->points);
+      ASSERT_EQ(BatchCells(batch, g),
+                ReferenceCells(reference, size.Cells()))
+          << "game " << g << " step " << step;
+    }
+    for (int g{}; g < kGames; ++g) {
+      max_score = std::max(max_score, batch.GetScore(g));
+      // Start over games again, the way the simulator does
+      if (!batch.IsAlive(g)) {
+        seeds[g] += kGames;
+        batch.Reset(g, seeds[g]);
+        references[g] = std::make_unique<Reference>(seeds[g], size);
+      }
+    }
+  }
+  EXPECT_GT(max_score, 0);
+}
+
+TEST(SnakeBatchTest, LevelFollowsScore) {
+  // A narrow board puts the apple in reach quickly
+  const BoardSize size{5, 10};
+  std::vector<std::uint32_t> seeds(64);
+  for (std::size_t g{}; g < seeds.size(); ++g) seeds[g] = g;
+  SnakeBatch batch(seeds, size);
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> dist(0, 4);
+  std::vector<MovementAction> actions(seeds.size());
+  for (int step{}; step < 2000; ++step) {
+    for (auto& action : actions)
+      action = static_cast<MovementAction>(dist(gen));
+    batch.StepAll(actions);
+    for (int g{}; g < batch.GetGames(); ++g) {
+      if (batch.IsAlive(g))
+        ASSERT_EQ(batch.GetLevel(g),
+                  std::min(1 + batch.GetScore(g) / 5, 10));
+      else
+        batch.Reset(g, seeds[g] += 64);
+    }
+  }
+}
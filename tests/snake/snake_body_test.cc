@@ -0,0 +1,53 @@
+#include "snake_body.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+
+using brick_game::SnakeBody;
+
+TEST(SnakeBodyTest, KeepsOrderFromTailToHead) {
+  SnakeBody body(8);
+  for (int cell : {5, 6, 7}) body.Push(cell);
+  EXPECT_EQ(body.Size(), 3);
+  EXPECT_EQ(body.Front(), 5);
+  EXPECT_EQ(body.Back(), 7);
+  body.Pop();
+  EXPECT_EQ(body.Size(), 2);
+  EXPECT_EQ(body.Front(), 6);
+}
+
+TEST(SnakeBodyTest, WrapsAroundTheRing) {
+  SnakeBody body(4);
+  std::deque<int> expected;
+  // Slides a three cell snake along many times the ring size
+  for (int cell{}; cell < 3; ++cell) {
+    body.Push(cell);
+    expected.push_back(cell);
+  }
+  for (int cell = 3; cell < 40; ++cell) {
+    body.Push(cell);
+    expected.push_back(cell);
+    body.Pop();
+    expected.pop_front();
+    ASSERT_EQ(body.Front(), expected.front());
+    ASSERT_EQ(body.Back(), expected.back());
+  }
+}
+
+TEST(SnakeBodyTest, FillsTheWholeBoard) {
+  SnakeBody body(200);
+  for (int cell{}; cell < body.Capacity(); ++cell) body.Push(cell);
+  EXPECT_EQ(body.Size(), 200);
+  EXPECT_EQ(body.Front(), 0);
+  EXPECT_EQ(body.Back(), 199);
+}
+
+TEST(SnakeBodyTest, BigBoardsKeepWideCellNumbers) {
+  // 1024 x 1024, the largest board, has cell numbers past 16 bits
+  SnakeBody body(1024 * 1024);
+  body.Push(1024 * 1024 - 1);
+  body.Push(70000);
+  EXPECT_EQ(body.Front(), 1024 * 1024 - 1);
+  EXPECT_EQ(body.Back(), 70000);
+}
@@ -301,3 +301,126 @@ TEST_F(BackendTest, MemoryManagement) {
     // For now, we're just testing we don't crash
   }
 }
+
+// Headless model driven by explicit steps
+class HeadlessSnakeModelTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = std::make_unique<HeadlessSnakeModel>();
+    model_->TakeGameControlAction(ControlAction::Start);
+  }
+
+  std::unique_ptr<HeadlessSnakeModel> model_;
+};
+
+TEST_F(HeadlessSnakeModelTest, DoesNotMoveWithoutSteps) {
+  // The head is the topmost segment and the snake heads up
+  auto head_row = [this] {
+    GameInfo_t state = model_->GetCurrentStateCopy();
+    int row = -1;
+    for (int y = 0; y < FIELD_LENGTH && row < 0; ++y)
+      if (state.field[y][FIELD_WIDTH / 2] == Green) row = y;
+    return row;
+  };
+  const int start_row = head_row();
+  ASSERT_GT(start_row, 0);
+  // No timer runs behind a headless model, only Step() makes a tick
+  EXPECT_EQ(model_->GetTicks(), 0u);
+  EXPECT_EQ(head_row(), start_row);
+  model_->Step(1);
+  EXPECT_EQ(model_->GetTicks(), 1u);
+  EXPECT_EQ(head_row(), start_row - 1);
+  EXPECT_NE(model_->GetCurrentStateCopy().level, 0);
+}
+
+TEST_F(HeadlessSnakeModelTest, StepsRunIntoWall) {
+  // The snake starts with its head at the middle row heading up
+  model_->Step(FIELD_LENGTH / 2 - 1);
+  EXPECT_NE(model_->GetCurrentStateCopy().level, 0);
+  model_->Step();
+  EXPECT_EQ(model_->GetCurrentStateCopy().level, 0);
+}
+
+TEST_F(HeadlessSnakeModelTest, PausedModelIgnoresSteps) {
+  model_->TakeGameControlAction(ControlAction::Pause);
+  model_->Step(FIELD_LENGTH * 2);
+  model_->TakeGameControlAction(ControlAction::Pause);
+  GameInfo_t state = model_->GetCurrentStateCopy();
+  EXPECT_EQ(state.pause, 0);
+  EXPECT_NE(state.level, 0);
+}
+
+TEST_F(HeadlessSnakeModelTest, PlayerMoveReplacesNextTick) {
+  model_->Step(FIELD_LENGTH / 2 - 2);
+  model_->TakeMoveAction(MovementAction::Up);
+  // The player's move consumed a period, so the next tick is skipped
+  model_->Step();
+  EXPECT_NE(model_->GetCurrentStateCopy().level, 0);
+  model_->Step();
+  EXPECT_EQ(model_->GetCurrentStateCopy().level, 0);
+}
+
+namespace {
+bool SameField(const GameInfo_t& a, const GameInfo_t& b) {
+  for (int y = 0; y < FIELD_LENGTH; ++y)
+    for (int x = 0; x < FIELD_WIDTH; ++x)
+      if (a.field[y][x] != b.field[y][x]) return false;
+  return true;
+}
+}  // namespace
+
+TEST(SeededSnakeModelTest, SameSeedSpawnsSameApples) {
+  HeadlessSnakeModel first(1234u), second(1234u);
+  EXPECT_TRUE(SameField(first.GetCurrentStateCopy(),
+                        second.GetCurrentStateCopy()));
+  for (auto* model : {&first, &second}) {
+    model->TakeGameControlAction(ControlAction::Start);
+    model->Step(3);
+    model->TakeMoveAction(MovementAction::Left);
+    model->Step(2);
+  }
+  EXPECT_TRUE(SameField(first.GetCurrentStateCopy(),
+                        second.GetCurrentStateCopy()));
+}
+
+TEST(SeededSnakeModelTest, SeedOnlyBeforeStart) {
+  HeadlessSnakeModel model;
+  EXPECT_TRUE(model.Seed(1u));
+  model.TakeGameControlAction(ControlAction::Start);
+  EXPECT_FALSE(model.Seed(2u));
+}
+
+TEST(SeededSnakeModelTest, RestartContinuesStream) {
+  HeadlessSnakeModel first(99u), second(99u);
+  for (auto* model : {&first, &second}) {
+    model->TakeGameControlAction(ControlAction::Start);
+    model->TakeGameControlAction(ControlAction::Terminate);
+  }
+  EXPECT_TRUE(SameField(first.GetCurrentStateCopy(),
+                        second.GetCurrentStateCopy()));
+  HeadlessSnakeModel fresh(99u);
+  EXPECT_FALSE(SameField(first.GetCurrentStateCopy(),
+                         fresh.GetCurrentStateCopy()));
+}
+
+TEST(ResizableSnakeModelTest, RunsIntoWallOfLargerBoard) {
+  HeadlessSnakeModel model;
+  ASSERT_TRUE(model.Resize(FIELD_MIN_SIZE, 30));
+  EXPECT_EQ(model.GetBoardSize(), (brick_game::BoardSize{FIELD_MIN_SIZE, 30}));
+  model.TakeGameControlAction(ControlAction::Start);
+  model.Step(30 / 2 - 1);
+  EXPECT_NE(model.GetCurrentStateCopy().level, 0);
+  model.Step();
+  EXPECT_EQ(model.GetCurrentStateCopy().level, 0);
+}
+
+TEST(ResizableSnakeModelTest, RejectsInvalidSizes) {
+  HeadlessSnakeModel model;
+  EXPECT_FALSE(model.Resize(FIELD_MIN_SIZE - 1, FIELD_LENGTH));
+  EXPECT_FALSE(model.Resize(FIELD_WIDTH, FIELD_MAX_SIZE + 1));
+  EXPECT_TRUE(model.Resize(12, 40));
+  model.TakeGameControlAction(ControlAction::Start);
+  EXPECT_FALSE(model.Resize(FIELD_WIDTH, FIELD_LENGTH));
+  model.TakeGameControlAction(ControlAction::Terminate);
+  EXPECT_EQ(model.GetBoardSize(), (brick_game::BoardSize{12, 40}));
+}
@@ -276,3 +276,37 @@ TEST_F(SnakeTest, AllMovementActions) {
     EXPECT_NO_THROW({ snake_->Move(action); });
   }
 }
+
+TEST_F(SnakeTest, CheckpointRejectsBadDirectionAndFlag) {
+  std::vector<std::int32_t> body(snake_->GetBodySize());
+  Snake::Checkpoint checkpoint{};
+  snake_->Save(checkpoint, body.data());
+  EXPECT_TRUE(Snake::IsValid(checkpoint, body.data()));
+
+  Snake::Checkpoint bad = checkpoint;
+  bad.direction = static_cast<MovementAction>(-1);
+  EXPECT_FALSE(Snake::IsValid(bad, body.data()));
+  bad.direction = MovementAction::Action;
+  EXPECT_FALSE(Snake::IsValid(bad, body.data()));
+  bad = checkpoint;
+  bad.got_apple = 2;
+  EXPECT_FALSE(Snake::IsValid(bad, body.data()));
+}
+
+TEST_F(SnakeTest, CheckpointRejectsBrokenBody) {
+  std::vector<std::int32_t> body(snake_->GetBodySize());
+  Snake::Checkpoint checkpoint{};
+  snake_->Save(checkpoint, body.data());
+  ASSERT_GE(body.size(), 3u);
+
+  // A repeated cell would be cleared while another segment still holds it
+  std::vector<std::int32_t> bad = body;
+  bad[2] = bad[0];
+  EXPECT_FALSE(Snake::IsValid(checkpoint, bad.data()));
+  bad = body;
+  bad[2] = bad[1] + 2;
+  EXPECT_FALSE(Snake::IsValid(checkpoint, bad.data()));
+  Snake::Checkpoint on_body = checkpoint;
+  on_body.apple = body[1];
+  EXPECT_FALSE(Snake::IsValid(on_body, body.data()));
+}
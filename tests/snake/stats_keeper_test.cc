@@ -286,3 +286,19 @@ TEST_F(StatsKeeperTest, MoveSemantics) {
   EXPECT_EQ(moved_stats.GetScore(), 50);
   EXPECT_EQ(moved_stats.GetHighscore(), 200);
 }
+
+TEST_F(StatsKeeperTest, CheckpointRejectsBadStats) {
+  using Stats = StatsKeeper<MockDataStorage<>>;
+  Stats stats(test_mediator_);
+  const Stats::Checkpoint checkpoint = stats.Save();
+  EXPECT_TRUE(Stats::IsValid(checkpoint));
+  // Level 0 reads as game over in every frame
+  for (int level : {0, kMaxLevel + 1}) {
+    Stats::Checkpoint bad = checkpoint;
+    bad.level = level;
+    EXPECT_FALSE(Stats::IsValid(bad));
+  }
+  Stats::Checkpoint bad = checkpoint;
+  bad.score = -1;
+  EXPECT_FALSE(Stats::IsValid(bad));
+}
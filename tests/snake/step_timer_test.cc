@@ -0,0 +1,99 @@
+#include "step_timer.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace brick_game;
+
+class CountingMediator : public Mediator {
+ public:
+  std::vector<Event> notifications;
+
+  void Notify(Event e) override {
+    notifications.push_back(e);
+    Mediator::Notify(e);
+  }
+
+  int Count(Event event) {
+    int count = 0;
+    for (auto e : notifications) {
+      if (e == event) count++;
+    }
+    return count;
+  }
+};
+
+class StepTimerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mediator_ = std::make_shared<CountingMediator>();
+    timer_ = std::make_unique<StepTimer>(mediator_);
+  }
+
+  std::shared_ptr<CountingMediator> mediator_;
+  std::unique_ptr<StepTimer> timer_;
+};
+
+TEST_F(StepTimerTest, NothingHappensWithoutStep) {
+  EXPECT_TRUE(mediator_->notifications.empty());
+  EXPECT_EQ(timer_->GetTicks(), 0u);
+}
+
+TEST_F(StepTimerTest, EveryStepSendsTimeToMove) {
+  timer_->Step(5);
+  EXPECT_EQ(mediator_->Count(Event::TimeToMove), 5);
+  EXPECT_EQ(timer_->GetTicks(), 5u);
+}
+
+TEST_F(StepTimerTest, NonPositiveStepIsNoop) {
+  timer_->Step(0);
+  timer_->Step(-3);
+  EXPECT_TRUE(mediator_->notifications.empty());
+}
+
+TEST_F(StepTimerTest, PlayerMovedSkipsExactlyOneTick) {
+  timer_->ProcessEvent(Event::PlayerMoved);
+  timer_->Step(3);
+  EXPECT_EQ(mediator_->Count(Event::TimeToMove), 2);
+  EXPECT_EQ(timer_->GetTicks(), 3u);
+}
+
+TEST_F(StepTimerTest, PausedTimerDoesNotTick) {
+  timer_->ProcessEvent(Event::Paused);
+  timer_->Step(10);
+  EXPECT_TRUE(mediator_->notifications.empty());
+  EXPECT_EQ(timer_->GetTicks(), 0u);
+
+  timer_->ProcessEvent(Event::Unpaused);
+  timer_->Step(2);
+  EXPECT_EQ(mediator_->Count(Event::TimeToMove), 2);
+}
+
+TEST_F(StepTimerTest, NewLevelShortensVirtualDelay) {
+  EXPECT_EQ(timer_->GetDelay(), kStartDelay);
+  timer_->ProcessEvent(Event::NewLevel);
+  EXPECT_EQ(timer_->GetDelay(),
+            msec(static_cast<int>(kStartDelay.count() * kDelayDecay)));
+}
+
+TEST_F(StepTimerTest, MoveAssignmentKeepsState) {
+  timer_->Step(4);
+  StepTimer other(mediator_);
+  other = std::move(*timer_);
+  EXPECT_EQ(other.GetTicks(), 4u);
+}
+
+TEST_F(StepTimerTest, CheckpointRejectsBadDelayAndFlags) {
+  const StepTimer::Checkpoint checkpoint = timer_->Save();
+  EXPECT_TRUE(StepTimer::IsValid(checkpoint));
+  StepTimer::Checkpoint bad = checkpoint;
+  bad.delay = 0;
+  EXPECT_FALSE(StepTimer::IsValid(bad));
+  bad = checkpoint;
+  bad.paused = 2;
+  EXPECT_FALSE(StepTimer::IsValid(bad));
+  bad = checkpoint;
+  bad.skip_movement = 2;
+  EXPECT_FALSE(StepTimer::IsValid(bad));
+}
@@ -0,0 +1,109 @@
+#include "bitboard.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include "tetromino_inner.h"
+
+#define WIDE_WIDTH 70
+
+static FieldCell_t wide_arr[FIELD_LENGTH * WIDE_WIDTH];
+static FieldCell_t* wide_field[FIELD_LENGTH];
+
+static void setup(void) {
+  memset(wide_arr, 0, sizeof(wide_arr));
+  for (int i = 0; i < FIELD_LENGTH; ++i)
+    wide_field[i] = wide_arr + i * WIDE_WIDTH;
+}
+
+static void teardown(void) { setBoardSize(FIELD_WIDTH, FIELD_LENGTH); }
+
+// Collision as the cell engine computes it
+static bool collidesOnCells(const Tetromino_t* tetromino, const int width) {
+  bool collides = false;
+  for (int i = 0; i < TOTAL_PIECES; ++i) {
+    const Coordinates_t piece = getTetrPieceCoords(tetromino, i);
+    if (piece.x < 0 || piece.x >= width || piece.y >= FIELD_LENGTH)
+      collides = true;
+    else if (piece.y >= 0 && wide_field[piece.y][piece.x] != Empty)
+      collides = true;
+  }
+  return collides;
+}
+
+static void checkAllPlacements(const int width) {
+  for (int shape = I_shape; shape <= L_shape; ++shape) {
+    for (int rotation = Angle0; rotation <= Angle270; ++rotation) {
+      for (int y = -3; y < FIELD_LENGTH + 2; ++y) {
+        for (int x = -3; x < width + 3; ++x) {
+          const Tetromino_t tetromino = {
+              .centerCoords = {.x = x, .y = y},
+              .shape = shape,
+              .rotation = rotation};
+          ck_assert_int_eq(collidesOnBitboard(&tetromino),
+                           collidesOnCells(&tetromino, width));
+        }
+      }
+    }
+  }
+}
+
+START_TEST(test_bitboard_matches_cells) {
+  const int widths[] = {FIELD_WIDTH, WIDE_WIDTH};
+  for (int w = 0; w < 2; ++w) {
+    setup();
+    srand(w + 1);
+    for (int i = 0; i < FIELD_LENGTH; ++i)
+      for (int j = 0; j < widths[w]; ++j)
+        if (i > FIELD_LENGTH / 2 && rand() % 3 == 0) wide_field[i][j] = Settled;
+    for (int i = 0; i < FIELD_LENGTH; ++i)
+      for (int j = widths[w]; j < WIDE_WIDTH; ++j) wide_field[i][j] = Empty;
+    setBoardSize(widths[w], FIELD_LENGTH);
+    rebuildBitboard(wide_field);
+    checkAllPlacements(widths[w]);
+  }
+}
+END_TEST
+
+START_TEST(test_bitboard_full_rows_across_words) {
+  setBoardSize(WIDE_WIDTH, FIELD_LENGTH);
+  for (int j = 0; j < WIDE_WIDTH; ++j) wide_field[FIELD_LENGTH - 1][j] = Settled;
+  for (int j = 0; j < WIDE_WIDTH - 1; ++j) wide_field[FIELD_LENGTH - 2][j] = Settled;
+  rebuildBitboard(wide_field);
+  ck_assert(isBitboardRowFull(FIELD_LENGTH - 1));
+  ck_assert(!isBitboardRowFull(FIELD_LENGTH - 2));
+
+  removeBitboardRows(FIELD_LENGTH, 1);
+  ck_assert(!isBitboardRowFull(FIELD_LENGTH - 1));
+  ck_assert(!isBitboardRowFull(0));
+
+  // A piece settled across the word boundary completes the row
+  const Tetromino_t tetromino = {.centerCoords = {.x = WIDE_WIDTH - 1,
+                                                  .y = FIELD_LENGTH - 2},
+                                 .shape = T_shape,
+                                 .rotation = Angle0};
+  ck_assert(collidesOnBitboard(&tetromino));
+  const Tetromino_t vertical = {.centerCoords = {.x = WIDE_WIDTH - 1,
+                                                 .y = FIELD_LENGTH - 3},
+                                .shape = I_shape,
+                                .rotation = Angle90};
+  ck_assert(!collidesOnBitboard(&vertical));
+}
+END_TEST
+
+Suite* bitboard_suite(void) {
+  Suite* s;
+  TCase* tc_core;
+
+  s = suite_create(NAME("Bitboard"));
+  tc_core = tcase_create("Core");
+
+  tcase_add_checked_fixture(tc_core, setup, teardown);
+  tcase_add_test(tc_core, test_bitboard_matches_cells);
+  tcase_add_test(tc_core, test_bitboard_full_rows_across_words);
+
+  suite_add_tcase(s, tc_core);
+  return s;
+}
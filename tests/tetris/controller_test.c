@@ -1,9 +1,14 @@
 #include "controller.h"
 
 #include <check.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <threads.h>
 
+#include "game_checkpoint.h"
 #include "game_data.h"
+#include "replay.h"
 #include "test.h"
 
 // Test cases
@@ -49,19 +54,453 @@ END_TEST
 START_TEST(test_controller_game_over) {
   userInput(Start, false);
   ck_assert(isGameState(RunState));
-  for (int i = 0; i < 12; ++i) {
+  // Input does not wait for a drop in progress, so keep dropping until the
+  // field is stacked up
+  for (int i = 0; i < 1000 && !isGameState(EndState); ++i) {
     userInput(Down, true);
     thrd_sleep(&(const struct timespec){.tv_nsec = 10000000}, NULL);
   }
   ck_assert(isGameState(EndState));
   userInput(Start, false);
   ck_assert(isGameState(EndState));
+  // The last frame follows the state change shortly
   GameInfo_t info = updateCurrentState();
+  for (int i = 0; i < 100 && info.level; ++i) {
+    thrd_sleep(&(const struct timespec){.tv_nsec = 1000000}, NULL);
+    info = updateCurrentState();
+  }
   ck_assert_int_eq(info.level, 0);
   userInput(Terminate, false);
 }
 END_TEST
 
+START_TEST(test_controller_field_size) {
+  int width = 0, length = 0;
+  getFieldSize(&width, &length);
+  ck_assert_int_eq(width, FIELD_WIDTH);
+  ck_assert_int_eq(length, FIELD_LENGTH);
+  ck_assert_int_eq(setFieldSize(FIELD_MIN_SIZE - 1, 30), EXIT_FAILURE);
+  ck_assert_int_eq(setFieldSize(16, FIELD_MAX_SIZE + 1), EXIT_FAILURE);
+  ck_assert_int_eq(setFieldSize(16, 30), EXIT_SUCCESS);
+
+  userInput(Start, false);
+  ck_assert(isGameState(RunState));
+  ck_assert_int_eq(setFieldSize(FIELD_WIDTH, FIELD_LENGTH), EXIT_FAILURE);
+  ck_assert_int_eq(getGameInfo()->field[29][15], Empty);
+  getFieldSize(&width, &length);
+  ck_assert_int_eq(width, 16);
+  ck_assert_int_eq(length, 30);
+  userInput(Terminate, false);
+
+  ck_assert_int_eq(setFieldSize(FIELD_WIDTH, FIELD_LENGTH), EXIT_SUCCESS);
+}
+END_TEST
+
+START_TEST(test_bg_games_are_independent) {
+  const BrickGameConfig_t config = {
+      .width = 12, .length = 24, .seed = 5, .seeded = true};
+  BrickGame_t* first = bg_create(&config);
+  BrickGame_t* second = bg_create(NULL);
+  ck_assert_ptr_nonnull(first);
+  ck_assert_ptr_nonnull(second);
+  ck_assert_ptr_ne(first, bg_default());
+
+  bg_input(first, Start, false);
+  ck_assert_int_eq(bg_state(first).level, 1);
+  ck_assert_int_eq(bg_state(second).level, 0);
+  ck_assert(isGameState(StartState));
+
+  int width = 0, length = 0;
+  bg_field_size(first, &width, &length);
+  ck_assert_int_eq(width, 12);
+  ck_assert_int_eq(length, 24);
+  bg_field_size(second, &width, &length);
+  ck_assert_int_eq(width, FIELD_WIDTH);
+  ck_assert_int_eq(length, FIELD_LENGTH);
+
+  bg_input(first, Pause, false);
+  ck_assert_int_eq(bg_state(first).pause, 1);
+  ck_assert_int_eq(bg_state(second).pause, 0);
+
+  bg_destroy(first);
+  bg_destroy(second);
+}
+END_TEST
+
+START_TEST(test_bg_create_rejects_bad_size) {
+  const BrickGameConfig_t config = {.width = FIELD_MIN_SIZE - 1};
+  ck_assert_ptr_null(bg_create(&config));
+  bg_destroy(NULL);
+  bg_destroy(bg_default());
+  ck_assert_ptr_nonnull(bg_default());
+}
+END_TEST
+
+START_TEST(test_bg_frames) {
+  const BrickGameConfig_t config = {.width = 12, .length = 24};
+  BrickGame_t* game = bg_create(&config);
+  ck_assert_ptr_nonnull(game);
+  ck_assert_uint_eq(bg_generation(game), 0);
+  ck_assert_ptr_null(bg_frame(game)->cells);
+
+  bg_input(game, Start, false);
+  const BrickFrame_t* frame = bg_frame(game);
+  ck_assert_uint_ge(frame->generation, 1);
+  ck_assert_uint_le(frame->generation, bg_generation(game));
+  ck_assert_int_eq(frame->width, 12);
+  ck_assert_int_eq(frame->length, 24);
+  ck_assert_int_eq(frame->level, 1);
+  ck_assert_ptr_nonnull(frame->cells);
+
+  const uint64_t seen = frame->generation;
+  bg_input(game, Pause, false);
+  bg_input(game, Pause, false);
+  bg_input(game, Pause, false);
+  ck_assert_uint_gt(bg_generation(game), seen);
+  ck_assert_uint_eq(frame->generation, seen);
+  frame = bg_frame(game);
+  ck_assert_uint_gt(frame->generation, seen);
+  ck_assert_int_eq(frame->pause, 1);
+
+  bg_destroy(game);
+}
+END_TEST
+
+START_TEST(test_input_wakes_game_loop) {
+  BrickGame_t* game = bg_create(NULL);
+  ck_assert_ptr_nonnull(game);
+  bg_input(game, Start, false);
+  // The game loop publishes the first preview once it is up
+  for (int i = 0; i < 100 && bg_generation(game) < 2; ++i)
+    thrd_sleep(&(struct timespec){.tv_nsec = 1000 * 1000}, NULL);
+  const uint64_t started = bg_generation(game);
+  // Well below the auto-shift interval: a sleeping loop publishes nothing
+  thrd_sleep(&(struct timespec){.tv_nsec = 100 * 1000 * 1000}, NULL);
+  ck_assert_uint_eq(bg_generation(game), started);
+
+  bg_input(game, Left, false);
+  for (int i = 0; i < 100 && bg_generation(game) == started; ++i)
+    thrd_sleep(&(struct timespec){.tv_nsec = 1000 * 1000}, NULL);
+  ck_assert_uint_gt(bg_generation(game), started);
+
+  bg_destroy(game);
+}
+END_TEST
+
+START_TEST(test_scheduled_games_share_workers) {
+  const BrickGameConfig_t config = {.scheduled = true};
+  BrickGame_t* games[4];
+  uint64_t started[4];
+  for (int g = 0; g < 4; ++g) {
+    games[g] = bg_create(&config);
+    ck_assert_ptr_nonnull(games[g]);
+    bg_input(games[g], Start, false);
+    started[g] = bg_generation(games[g]);
+  }
+  for (int g = 0; g < 4; ++g) {
+    bg_input(games[g], Left, false);
+    for (int i = 0; i < 100 && bg_generation(games[g]) == started[g]; ++i)
+      thrd_sleep(&(struct timespec){.tv_nsec = 1000 * 1000}, NULL);
+    ck_assert_uint_gt(bg_generation(games[g]), started[g]);
+  }
+
+  bg_input(games[0], Pause, false);
+  ck_assert_int_eq(bg_state(games[0]).pause, 1);
+  ck_assert_int_eq(bg_state(games[1]).pause, 0);
+  bg_input(games[0], Pause, false);
+  ck_assert_int_eq(bg_state(games[0]).pause, 0);
+  const uint64_t resumed = bg_generation(games[0]);
+  bg_input(games[0], Right, false);
+  for (int i = 0; i < 100 && bg_generation(games[0]) == resumed; ++i)
+    thrd_sleep(&(struct timespec){.tv_nsec = 1000 * 1000}, NULL);
+  ck_assert_uint_gt(bg_generation(games[0]), resumed);
+
+  for (int g = 0; g < 4; ++g) bg_destroy(games[g]);
+}
+END_TEST
+
+START_TEST(test_stepped_game_moves_only_when_told) {
+  const BrickGameConfig_t config = {.seed = 3, .seeded = true, .stepped = true};
+  BrickGame_t* game = bg_create(&config);
+  BrickGame_t* twin = bg_create(&config);
+  ck_assert_ptr_nonnull(game);
+  ck_assert_ptr_nonnull(twin);
+  bg_input(game, Start, false);
+  bg_input(twin, Start, false);
+  const uint64_t started = bg_generation(game);
+  thrd_sleep(&(struct timespec){.tv_nsec = 50 * 1000 * 1000}, NULL);
+  ck_assert_uint_eq(bg_generation(game), started);
+
+  // Input is applied before bg_input() returns
+  bg_input(game, Left, false);
+  ck_assert_uint_gt(bg_generation(game), started);
+  bg_input(twin, Left, false);
+
+  // Untouched pieces pile up in the middle until the game is over
+  for (int i = 0; i < 10000 && bg_frame(game)->level; ++i) {
+    bg_step(game, 1);
+    bg_step(twin, 1);
+  }
+  ck_assert_int_eq(bg_frame(game)->level, 0);
+  ck_assert_int_eq(bg_frame(twin)->level, 0);
+  ck_assert_mem_eq(bg_frame(game)->cells, bg_frame(twin)->cells,
+                   FIELD_WIDTH * FIELD_LENGTH);
+
+  bg_destroy(game);
+  bg_destroy(twin);
+}
+END_TEST
+
+// Plays a hard drop and reports the animations seen in frames
+static int watchHardDrop(BrickGame_t* game) {
+  int seen = 0;
+  bg_input(game, Start, false);
+  bg_input(game, Down, true);
+  for (int i = 0; i < 100; ++i) {
+    const BrickFrame_t* frame = bg_frame(game);
+    ck_assert_int_ge(frame->progress, 0);
+    ck_assert_int_le(frame->progress, 100);
+    seen |= 1 << frame->animation;
+    thrd_sleep(&(struct timespec){.tv_nsec = 5 * 1000 * 1000}, NULL);
+  }
+  bg_destroy(game);
+  return seen;
+}
+
+START_TEST(test_palette_covers_every_cell_state) {
+  const BrickPalette_t* palette = bg_palette();
+  ck_assert_ptr_nonnull(palette);
+  for (int state = Empty; state < CellStateCount; state++)
+    ck_assert_uint_ne(palette->entries[state].alpha, 0);
+  // Past the states nothing is drawn
+  ck_assert_uint_eq(palette->entries[CellStateCount].alpha, 0);
+  ck_assert_int_eq(strcmp(palette->entries[Volatile].glyph, "$ "), 0);
+}
+END_TEST
+
+static int stepLater(void* game) {
+  thrd_sleep(&(struct timespec){.tv_nsec = 30 * 1000 * 1000}, NULL);
+  bg_step(game, 1);
+  return 0;
+}
+
+START_TEST(test_wait_wakes_on_new_frame) {
+  const BrickGameConfig_t config = {.stepped = true};
+  BrickGame_t* game = bg_create(&config);
+  ck_assert_ptr_nonnull(game);
+  bg_input(game, Start, false);
+  const uint64_t seen = bg_generation(game);
+  // Nothing changes, the wait runs out
+  ck_assert_uint_eq(bg_wait(game, seen, 20), seen);
+  // An older generation returns at once
+  ck_assert_uint_eq(bg_wait(game, seen - 1, 5000), seen);
+
+  thrd_t stepper;
+  ck_assert_int_eq(thrd_create(&stepper, stepLater, game), thrd_success);
+  ck_assert_uint_gt(bg_wait(game, seen, 5000), seen);
+  thrd_join(stepper, NULL);
+  bg_destroy(game);
+}
+END_TEST
+
+// Plays a log through a new stepped game, the way brickgame_sim does
+static BrickGame_t* replayGame(const char* path, int* inputs) {
+  ReplayHeader_t header;
+  ReplayReader_t* reader = replayOpen(path, &header);
+  ck_assert_ptr_nonnull(reader);
+  const BrickGameConfig_t config = {.width = header.width,
+                                    .length = header.length,
+                                    .seed = header.seed,
+                                    .seeded = true,
+                                    .stepped = true};
+  BrickGame_t* game = bg_create(&config);
+  ck_assert_ptr_nonnull(game);
+  uint64_t tick = 0;
+  ReplayEvent_t event;
+  while (replayNext(reader, &event)) {
+    bg_step(game, (int)(event.tick - tick));
+    tick = event.tick;
+    bg_input(game, event.action, event.hold);
+    ++*inputs;
+  }
+  bg_step(game, (int)(replayEndTick(reader) - tick));
+  replayClose(reader);
+  return game;
+}
+
+START_TEST(test_recorded_game_plays_again) {
+  const char* path = "tetris_test.replay";
+  const BrickGameConfig_t config = {.width = 8, .stepped = true};
+  BrickGame_t* game = bg_create(&config);
+  ck_assert_ptr_nonnull(game);
+  ck_assert_int_eq(bg_record(game, path), EXIT_SUCCESS);
+  bg_input(game, Start, false);
+  ck_assert_int_eq(bg_record(game, path), EXIT_FAILURE);
+  // Shifts, turns and drops in a fixed pattern until the board fills up
+  const UserAction_t moves[] = {Left, Action, Right, Right, Down, Action};
+  int recorded = 1;
+  for (int i = 0; i < 600 && bg_frame(game)->level; ++i) {
+    bg_input(game, moves[i % 6], i % 6 == 4 && i % 4 == 0);
+    ++recorded;
+    bg_step(game, 1 + i % 3);
+  }
+  bg_step(game, 5);
+  ck_assert_int_eq(bg_record(game, NULL), EXIT_SUCCESS);
+  const BrickFrame_t* frame = bg_frame(game);
+
+  int inputs = 0;
+  BrickGame_t* replay = replayGame(path, &inputs);
+  ck_assert_int_eq(inputs, recorded);
+  const BrickFrame_t* replayed = bg_frame(replay);
+  ck_assert_int_eq(replayed->width, 8);
+  ck_assert_int_eq(replayed->score, frame->score);
+  ck_assert_int_eq(replayed->level, frame->level);
+  ck_assert_mem_eq(replayed->cells, frame->cells, 8 * FIELD_LENGTH);
+  // A header and about a byte per input
+  FILE* file = fopen(path, "rb");
+  ck_assert_ptr_nonnull(file);
+  fseek(file, 0, SEEK_END);
+  ck_assert_int_lt(ftell(file), 16 + 2 * inputs);
+  fclose(file);
+  bg_destroy(replay);
+  bg_destroy(game);
+  remove(path);
+}
+END_TEST
+
+START_TEST(test_hard_drop_animates_unless_headless) {
+  ck_assert(watchHardDrop(bg_create(NULL)) & (1 << DropAnimation));
+  const BrickGameConfig_t headless = {.headless = true};
+  ck_assert_int_eq(watchHardDrop(bg_create(&headless)), 1 << NoAnimation);
+}
+END_TEST
+
+START_TEST(test_legacy_tables_follow_packed_field) {
+  BrickGame_t* game = bg_create(NULL);
+  ck_assert_ptr_nonnull(game);
+  ck_assert_ptr_null(bg_state(game).field);
+
+  bg_input(game, Start, false);
+  bg_input(game, Down, false);
+  bg_input(game, Pause, false);
+  // The game loop may finish one more tick after the pause
+  uint64_t generation = 0;
+  while (generation != bg_generation(game)) {
+    generation = bg_generation(game);
+    thrd_sleep(&(struct timespec){.tv_nsec = 50 * 1000 * 1000}, NULL);
+  }
+  const GameInfo_t state = bg_state(game);
+  const BrickFrame_t* frame = bg_frame(game);
+  ck_assert_ptr_nonnull(state.field);
+  for (int i = 0; i < FIELD_LENGTH; ++i)
+    for (int j = 0; j < FIELD_WIDTH; ++j)
+      ck_assert_int_eq(state.field[i][j], frame->cells[i * FIELD_WIDTH + j]);
+  for (int i = 0; i < NEXTF_LENGTH; ++i)
+    for (int j = 0; j < NEXTF_WIDTH; ++j)
+      ck_assert_int_eq(state.next[i][j], frame->next[i][j]);
+  ck_assert_int_eq(state.pause, 1);
+
+  bg_destroy(game);
+}
+END_TEST
+
+// Plays the same moves on two games, which must stay alike
+static void playAlong(BrickGame_t* game, BrickGame_t* fork, const int moves) {
+  const UserAction_t actions[] = {Left, Action, Right, Right, Down, Action};
+  for (int i = 0; i < moves && bg_frame(game)->level; ++i) {
+    bg_input(game, actions[i % 6], false);
+    bg_input(fork, actions[i % 6], false);
+    bg_step(game, 1 + i % 3);
+    bg_step(fork, 1 + i % 3);
+    const BrickFrame_t* a = bg_frame(game);
+    const BrickFrame_t* b = bg_frame(fork);
+    ck_assert_int_eq(b->width, a->width);
+    ck_assert_int_eq(b->score, a->score);
+    ck_assert_int_eq(b->level, a->level);
+    ck_assert_mem_eq(b->cells, a->cells, a->width * a->length);
+    ck_assert_mem_eq(b->next, a->next, sizeof(a->next));
+  }
+}
+
+START_TEST(test_checkpoint_forks_a_game) {
+  const BrickGameConfig_t config = {
+      .width = 8, .seed = 3, .seeded = true, .stepped = true};
+  BrickGame_t* game = bg_create(&config);
+  ck_assert_ptr_nonnull(game);
+  bg_input(game, Start, false);
+  for (int i = 0; i < 40; ++i) {
+    bg_input(game, i % 2 ? Left : Action, false);
+    bg_step(game, 2);
+  }
+  ck_assert_int_ne(bg_frame(game)->level, 0);
+
+  const size_t size = bg_save(game, NULL, 0);
+  ck_assert_uint_gt(size, 8 * FIELD_LENGTH);
+  unsigned char* checkpoint = malloc(size);
+  ck_assert_ptr_nonnull(checkpoint);
+  ck_assert_uint_eq(bg_save(game, checkpoint, size), size);
+
+  // A running fork of another size is started again at the saved one
+  const BrickGameConfig_t other = {.seed = 4, .seeded = true, .stepped = true};
+  BrickGame_t* fork = bg_create(&other);
+  ck_assert_ptr_nonnull(fork);
+  bg_input(fork, Start, false);
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size - 1), EXIT_FAILURE);
+  checkpoint[0] ^= 1;
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_FAILURE);
+  checkpoint[0] ^= 1;
+  // A piece off the board would be drawn out of bounds
+  TetrisCheckpoint_t* fixed = (TetrisCheckpoint_t*)checkpoint;
+  const Coordinates_t center = fixed->current.centerCoords;
+  const Coordinates_t off_board[] = {
+      {.x = -1, .y = 5}, {.x = 8, .y = 5}, {.x = 3, .y = FIELD_LENGTH}};
+  for (int i = 0; i < 3; ++i) {
+    fixed->current.centerCoords = off_board[i];
+    ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_FAILURE);
+  }
+  fixed->current.centerCoords = center;
+  // So would a running game without a piece or with no next shape
+  const int shape = fixed->current.shape;
+  fixed->current.shape = Empty;
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_FAILURE);
+  fixed->current.shape = shape;
+  const FieldCell_t next = fixed->next[CHECKPOINT_NEXT_CELLS - 1];
+  fixed->next[CHECKPOINT_NEXT_CELLS - 1] = Settled;
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_FAILURE);
+  fixed->next[CHECKPOINT_NEXT_CELLS - 1] = next;
+  // A stepped game never animates and its flags are 0 or 1
+  fixed->animation.kind = DropAnimation;
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_FAILURE);
+  fixed->animation.kind = NoAnimation;
+  const uint8_t seeded = fixed->rng_seeded;
+  fixed->rng_seeded = 2;
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_FAILURE);
+  fixed->rng_seeded = seeded;
+  ck_assert_int_eq(bg_frame(fork)->width, FIELD_WIDTH);
+  ck_assert_int_eq(bg_restore(fork, checkpoint, size), EXIT_SUCCESS);
+  playAlong(game, fork, 50);
+
+  // The game itself goes back in place and plays the same moves again
+  ck_assert_int_eq(bg_restore(game, checkpoint, size), EXIT_SUCCESS);
+  BrickGame_t* again = bg_create(&config);
+  ck_assert_ptr_nonnull(again);
+  ck_assert_int_eq(bg_restore(again, checkpoint, size), EXIT_SUCCESS);
+  playAlong(again, game, 600);
+  ck_assert_int_eq(bg_frame(game)->level, 0);
+
+  // Only stepped games have checkpoints
+  BrickGame_t* realtime = bg_create(NULL);
+  ck_assert_ptr_nonnull(realtime);
+  ck_assert_uint_eq(bg_save(realtime, NULL, 0), 0);
+  ck_assert_int_eq(bg_restore(realtime, checkpoint, size), EXIT_FAILURE);
+  bg_destroy(realtime);
+  bg_destroy(again);
+  bg_destroy(fork);
+  bg_destroy(game);
+  free(checkpoint);
+}
+END_TEST
+
 // Test suite
 Suite* controller_suite(void) {
   Suite* s;
@@ -74,6 +513,19 @@ Suite* controller_suite(void) {
   tcase_add_test(tc_core, test_controller_game_on_off);
   tcase_add_test(tc_core, test_controller_game_pause);
   tcase_add_test(tc_core, test_controller_game_over);
+  tcase_add_test(tc_core, test_controller_field_size);
+  tcase_add_test(tc_core, test_bg_games_are_independent);
+  tcase_add_test(tc_core, test_bg_create_rejects_bad_size);
+  tcase_add_test(tc_core, test_bg_frames);
+  tcase_add_test(tc_core, test_input_wakes_game_loop);
+  tcase_add_test(tc_core, test_scheduled_games_share_workers);
+  tcase_add_test(tc_core, test_stepped_game_moves_only_when_told);
+  tcase_add_test(tc_core, test_wait_wakes_on_new_frame);
+  tcase_add_test(tc_core, test_palette_covers_every_cell_state);
+  tcase_add_test(tc_core, test_recorded_game_plays_again);
+  tcase_add_test(tc_core, test_hard_drop_animates_unless_headless);
+  tcase_add_test(tc_core, test_legacy_tables_follow_packed_field);
+  tcase_add_test(tc_core, test_checkpoint_forks_a_game);
 
   suite_add_tcase(s, tc_core);
 
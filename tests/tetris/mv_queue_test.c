@@ -1,6 +1,8 @@
 #include <check.h>
 #include <stdlib.h>
+#include <threads.h>
 
+#include "game_instance.h"
 #include "movement_queue.h"
 #include "test.h"
 
@@ -70,6 +72,73 @@ START_TEST(test_flushQueue_equivalent_to_init) {
 }
 END_TEST
 
+START_TEST(test_full_queue_drops_newest) {
+  const MoveCommand_t left = {.move = 0, .hold = false};
+  const MoveCommand_t right = {.move = 1, .hold = false};
+  for (int i = 0; i < QUEUE_SIZE; ++i)
+    ck_assert_int_eq(pushQueue(left), QueuePushed);
+  ck_assert_int_eq(pushQueue(right), QueueDropped);
+  for (int i = 0; i < QUEUE_SIZE; ++i) ck_assert_int_eq(popQueue().move, 0);
+  ck_assert(isEmptyQueue());
+  ck_assert_int_eq(pushQueue(right), QueuePushed);
+  ck_assert_int_eq(popQueue().move, 1);
+}
+END_TEST
+
+START_TEST(test_held_moves_coalesce) {
+  const MoveCommand_t held_down = {.move = 3, .hold = true};
+  const MoveCommand_t down = {.move = 3, .hold = false};
+  ck_assert_int_eq(pushQueue(held_down), QueuePushed);
+  ck_assert_int_eq(pushQueue(held_down), QueueCoalesced);
+  ck_assert_int_eq(pushQueue(down), QueuePushed);
+  ck_assert_int_eq(pushQueue(test_commands[1]), QueuePushed);
+  ck_assert(popQueue().hold);
+  ck_assert_int_eq(pushQueue(held_down), QueuePushed);
+  ck_assert(!popQueue().hold);
+  ck_assert_int_eq(popQueue().move, 1);
+  ck_assert_int_eq(popQueue().move, 3);
+  ck_assert(isEmptyQueue());
+}
+END_TEST
+
+#define PRODUCERS 4
+#define PUSHES 20000
+
+static int producer(void* arg) {
+  static atomic_int next_id;
+  bindGame((BrickGame_t*)arg);
+  const int id = atomic_fetch_add(&next_id, 1) % PRODUCERS;
+  for (int pushed = 0; pushed < PUSHES;) {
+    if (pushQueue((MoveCommand_t){.move = id * PUSHES + pushed}) ==
+        QueuePushed)
+      ++pushed;
+    else
+      thrd_yield();
+  }
+  return EXIT_SUCCESS;
+}
+
+START_TEST(test_concurrent_producers_lose_nothing) {
+  thrd_t threads[PRODUCERS];
+  int expected[PRODUCERS] = {0};
+  for (int i = 0; i < PRODUCERS; ++i)
+    ck_assert_int_eq(
+        thrd_create(&threads[i], producer, getCurrentGame()), thrd_success);
+  for (int popped = 0; popped < PRODUCERS * PUSHES;) {
+    if (!isEmptyQueue()) {
+      // Commands of one producer come out in the order it pushed them
+      const int move = popQueue().move;
+      ck_assert_int_eq(move % PUSHES, expected[move / PUSHES]++);
+      ++popped;
+    } else
+      thrd_yield();
+  }
+  for (int i = 0; i < PRODUCERS; ++i) thrd_join(threads[i], NULL);
+  ck_assert(isEmptyQueue());
+  for (int i = 0; i < PRODUCERS; ++i) ck_assert_int_eq(expected[i], PUSHES);
+}
+END_TEST
+
 // Test suite
 Suite* queue_suite(void) {
   Suite* s;
@@ -86,6 +155,9 @@ Suite* queue_suite(void) {
   tcase_add_test(tc_core, test_popQueue_empty_queue_behavior);
   tcase_add_test(tc_core, test_isEmptyQueue_accurate);
   tcase_add_test(tc_core, test_flushQueue_equivalent_to_init);
+  tcase_add_test(tc_core, test_full_queue_drops_newest);
+  tcase_add_test(tc_core, test_held_moves_coalesce);
+  tcase_add_test(tc_core, test_concurrent_producers_lose_nothing);
 
   suite_add_tcase(s, tc_core);
 
@@ -0,0 +1,123 @@
+#include "scheduler.h"
+
+#include <check.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#include "test.h"
+
+#define MS 1000000LL
+
+static Scheduler_t* sched = NULL;
+
+static void setup(void) { sched = schedCreate(2); }
+
+static void teardown(void) {
+  schedDestroy(sched);
+  sched = NULL;
+}
+
+static void sleepMs(const long ms) {
+  thrd_sleep(&(struct timespec){.tv_nsec = ms * MS}, NULL);
+}
+
+typedef struct {
+  atomic_int runs;
+  atomic_int order;  ///< Shared run counter, for ordering checks
+  int seen;          ///< Value of order when this timer ran
+  int64_t repeat;    ///< Result of every run
+  SchedTimerId_t id; ///< Own handle, for self cancellation
+} Probe_t;
+
+static int64_t probeTask(void* arg) {
+  Probe_t* probe = arg;
+  atomic_fetch_add(&probe->runs, 1);
+  return probe->repeat;
+}
+
+static atomic_int order_counter;
+
+static int64_t orderTask(void* arg) {
+  Probe_t* probe = arg;
+  probe->seen = atomic_fetch_add(&order_counter, 1);
+  atomic_fetch_add(&probe->runs, 1);
+  return SCHED_TASK_DONE;
+}
+
+static int64_t selfCancelTask(void* arg) {
+  Probe_t* probe = arg;
+  atomic_fetch_add(&probe->runs, 1);
+  schedCancel(sched, probe->id);
+  return 0;
+}
+
+START_TEST(test_timers_run_by_due_time) {
+  Scheduler_t* single = schedCreate(1);
+  Probe_t probes[3] = {0};
+  atomic_store(&order_counter, 0);
+  ck_assert_uint_ne(schedAdd(single, orderTask, &probes[0], 30 * MS), 0);
+  ck_assert_uint_ne(schedAdd(single, orderTask, &probes[1], 10 * MS), 0);
+  ck_assert_uint_ne(schedAdd(single, orderTask, &probes[2], 20 * MS), 0);
+  sleepMs(80);
+  for (int i = 0; i < 3; ++i) ck_assert_int_eq(atomic_load(&probes[i].runs), 1);
+  ck_assert_int_eq(probes[1].seen, 0);
+  ck_assert_int_eq(probes[2].seen, 1);
+  ck_assert_int_eq(probes[0].seen, 2);
+  schedDestroy(single);
+}
+END_TEST
+
+START_TEST(test_cancel_stops_repeating_timer) {
+  Probe_t probe = {.repeat = MS};
+  const SchedTimerId_t id = schedAdd(sched, probeTask, &probe, 0);
+  sleepMs(30);
+  schedCancel(sched, id);
+  const int runs = atomic_load(&probe.runs);
+  ck_assert_int_gt(runs, 1);
+  sleepMs(20);
+  ck_assert_int_eq(atomic_load(&probe.runs), runs);
+  // Stale handles are ignored
+  schedWake(sched, id);
+  schedCancel(sched, id);
+  sleepMs(5);
+  ck_assert_int_eq(atomic_load(&probe.runs), runs);
+}
+END_TEST
+
+START_TEST(test_parked_timer_runs_when_woken) {
+  Probe_t probe = {.repeat = SCHED_TASK_IDLE};
+  const SchedTimerId_t id = schedAdd(sched, probeTask, &probe, SCHED_TASK_IDLE);
+  sleepMs(20);
+  ck_assert_int_eq(atomic_load(&probe.runs), 0);
+  schedWake(sched, id);
+  for (int i = 0; i < 100 && !atomic_load(&probe.runs); ++i) sleepMs(1);
+  ck_assert_int_eq(atomic_load(&probe.runs), 1);
+  sleepMs(20);
+  ck_assert_int_eq(atomic_load(&probe.runs), 1);
+  schedCancel(sched, id);
+}
+END_TEST
+
+START_TEST(test_task_cancels_itself) {
+  Probe_t probe = {0};
+  probe.id = schedAdd(sched, selfCancelTask, &probe, SCHED_TASK_IDLE);
+  schedWake(sched, probe.id);
+  sleepMs(30);
+  ck_assert_int_eq(atomic_load(&probe.runs), 1);
+}
+END_TEST
+
+Suite* scheduler_suite(void) {
+  Suite* s = suite_create(NAME("Scheduler"));
+  TCase* tc_core = tcase_create("Core");
+  tcase_add_checked_fixture(tc_core, setup, teardown);
+
+  tcase_add_test(tc_core, test_timers_run_by_due_time);
+  tcase_add_test(tc_core, test_cancel_stops_repeating_timer);
+  tcase_add_test(tc_core, test_parked_timer_runs_when_woken);
+  tcase_add_test(tc_core, test_task_cancels_itself);
+
+  suite_add_tcase(s, tc_core);
+  return s;
+}
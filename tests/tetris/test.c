@@ -4,7 +4,8 @@
 int main() {
   int failed = 0, total = 0;
 
-  Suite *Tests[] = {controller_suite(), queue_suite(),
+  Suite *Tests[] = {bitboard_suite(), controller_suite(), queue_suite(),
+                    scheduler_suite(),
                     // highscore_suite(),
                     tetromino_suite(), tetromino_mover_suite(), NULL};
   for (int i = 0; Tests[i] != NULL; i++) {
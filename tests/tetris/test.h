@@ -9,8 +9,10 @@
 #define YELLOW "\033[33;1m"
 #define NAME(x) YELLOW x NOCOLOR
 
+Suite* bitboard_suite(void);
 Suite* controller_suite(void);
 Suite* queue_suite(void);
+Suite* scheduler_suite(void);
 // Suite* highscore_suite(void);
 Suite* tetromino_suite(void);
 Suite* tetromino_mover_suite(void);
@@ -1,17 +1,18 @@
 #include <check.h>
 #include <string.h>
 
+#include "bitboard.h"
 #include "test.h"
 #include "tetromino.h"
 #include "tetromino_mover_inner.h"
 
 // Test fixtures
 typedef struct {
-  GameInfo_t game_info;
-  int* field[FIELD_LENGTH];
+  PackedGameInfo_t game_info;
+  FieldCell_t* field[FIELD_LENGTH];
 } TestGameState;
 
-static int field_arr[FIELD_LENGTH * FIELD_WIDTH] = {0};
+static FieldCell_t field_arr[FIELD_LENGTH * FIELD_WIDTH] = {0};
 
 static TestGameState test_state;
 static Tetromino_t test_tetromino;
@@ -24,6 +25,7 @@ void setup(void) {
     test_state.field[i] = field_arr + (i * FIELD_WIDTH);
   }
   test_state.game_info.field = test_state.field;
+  rebuildBitboard(test_state.game_info.field);
 
   test_tetromino.centerCoords.x = 5;
   test_tetromino.centerCoords.y = -1;
@@ -58,6 +60,26 @@ START_TEST(test_markRow_marks_correctly) {
 }
 END_TEST
 
+START_TEST(test_markRow_wide_board) {
+  enum { kWidth = FIELD_WIDTH + 6 };
+  static FieldCell_t wide_arr[FIELD_LENGTH * kWidth];
+  FieldCell_t* wide_field[FIELD_LENGTH];
+  memset(wide_arr, 0, sizeof(wide_arr));
+  for (int i = 0; i < FIELD_LENGTH; ++i) wide_field[i] = wide_arr + i * kWidth;
+
+  setBoardSize(kWidth, FIELD_LENGTH);
+  markRow(wide_field, 5);
+  destroyMarkedRows(&(PackedGameInfo_t){.field = wide_field}, &test_tetromino);
+  setBoardSize(FIELD_WIDTH, FIELD_LENGTH);
+
+  for (int y = 0; y < FIELD_LENGTH; y++) {
+    for (int x = 0; x < kWidth; x++) {
+      ck_assert_int_eq(wide_field[y][x], Empty);
+    }
+  }
+}
+END_TEST
+
 START_TEST(test_destroyMarkedRows_no_marked_rows) {
   fill_row(10, Settled);
   fill_row(11, Settled);
@@ -156,6 +178,7 @@ Suite* tetromino_mover_suite(void) {
   tcase_add_checked_fixture(tc_core, setup, teardown);
 
   tcase_add_test(tc_core, test_markRow_marks_correctly);
+  tcase_add_test(tc_core, test_markRow_wide_board);
   tcase_add_test(tc_core, test_destroyMarkedRows_no_marked_rows);
   tcase_add_test(tc_core, test_destroyMarkedRows_single_marked_row);
   tcase_add_test(tc_core,
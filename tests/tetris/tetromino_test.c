@@ -4,22 +4,25 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include "animation.h"
+#include "bitboard.h"
 #include "test.h"
 #include "tetromino_inner.h"
+#include "tetromino_mover_inner.h"
 
 #define TEST_START_Y 1
 
 // Test fixtures
 typedef struct {
-  GameInfo_t game_info;
-  int* field[FIELD_LENGTH];
-  int* next[NEXTF_LENGTH];
+  PackedGameInfo_t game_info;
+  FieldCell_t* field[FIELD_LENGTH];
+  FieldCell_t* next[NEXTF_LENGTH];
 } TestGameState;
 
 static TestGameState test_state;
 static Tetromino_t test_tetromino;
-static int field_arr[FIELD_LENGTH * FIELD_WIDTH] = {0};
-static int next_arr[NEXTF_LENGTH * NEXTF_WIDTH + 1];
+static FieldCell_t field_arr[FIELD_LENGTH * FIELD_WIDTH] = {0};
+static FieldCell_t next_arr[NEXTF_LENGTH * NEXTF_WIDTH + 1];
 
 static void setup(void) {
   srand(time(NULL));
@@ -37,6 +40,7 @@ static void setup(void) {
 
   test_state.game_info.field = test_state.field;
   test_state.game_info.next = test_state.next;
+  rebuildBitboard(test_state.game_info.field);
 
   test_tetromino.centerCoords.x = START_X;
   test_tetromino.centerCoords.y = TEST_START_Y;
@@ -73,6 +77,7 @@ END_TEST
 
 START_TEST(test_moveDown_collision) {
   test_state.field[TEST_START_Y + 2][START_X] = Settled;
+  rebuildBitboard(test_state.game_info.field);
 
   int result = moveDown(&test_state.game_info, &test_tetromino);
   if (!result) result = moveDown(&test_state.game_info, &test_tetromino);
@@ -82,12 +87,34 @@ START_TEST(test_moveDown_collision) {
 END_TEST
 
 START_TEST(test_smashDown_moves_to_bottom) {
+  setHeadless(true);
   int result = smashDown(&test_state.game_info, &test_tetromino);
+  setHeadless(false);
   ck_assert_int_eq(result, EXIT_SUCCESS);
+  ck_assert(!isAnimating());
   ck_assert_int_eq(test_tetromino.centerCoords.y, START_Y);
 }
 END_TEST
 
+START_TEST(test_smashDown_animates_the_fall) {
+  int result = smashDown(&test_state.game_info, &test_tetromino);
+  ck_assert_int_eq(result, EXIT_SUCCESS);
+  ck_assert_int_eq(getAnimation()->kind, DropAnimation);
+  ck_assert_int_eq(test_tetromino.centerCoords.y, TEST_START_Y + 1);
+  ck_assert(!stepAnimation(&test_state.game_info, &test_tetromino));
+
+  int previous_progress = -1;
+  while (isAnimating()) {
+    ck_assert_int_gt(getAnimationProgress(), previous_progress);
+    previous_progress = getAnimationProgress();
+    thrd_sleep(&(struct timespec){.tv_nsec = ANIMATION_SLEEP_TIME}, NULL);
+    ck_assert(stepAnimation(&test_state.game_info, &test_tetromino));
+  }
+  ck_assert_int_eq(test_tetromino.centerCoords.y, START_Y);
+  ck_assert_int_eq(test_state.field[FIELD_LENGTH - 1][START_X], Settled);
+}
+END_TEST
+
 START_TEST(test_moveLeft_successful) {
   int result = moveLeft(&test_state.game_info, &test_tetromino);
   ck_assert_int_eq(result, EXIT_SUCCESS);
@@ -149,6 +176,33 @@ START_TEST(test_setRandomShape_updates_next) {
 }
 END_TEST
 
+START_TEST(test_setRandomShape_seed_repeats_sequence) {
+  int first[8], second[8];
+  seedRandom(42);
+  for (int i = 0; i < 8; ++i) {
+    setRandomShape(test_state.game_info.next);
+    first[i] = test_state.next[3][4];
+  }
+  seedRandom(42);
+  for (int i = 0; i < 8; ++i) {
+    setRandomShape(test_state.game_info.next);
+    second[i] = test_state.next[3][4];
+  }
+  for (int i = 0; i < 8; ++i) ck_assert_int_eq(first[i], second[i]);
+}
+END_TEST
+
+START_TEST(test_cleanUpData_keeps_random_stream) {
+  seedRandom(7);
+  uint32_t expected = nextRandom();
+  initGameData();
+  seedRandom(7);
+  cleanUpData();
+  ck_assert(isRandomSeeded());
+  ck_assert_uint_eq(nextRandom(), expected);
+}
+END_TEST
+
 START_TEST(test_putTetromino_updates_field) {
   putTetromino(&test_tetromino, test_state.game_info.field);
   ck_assert_int_eq(test_state.field[TEST_START_Y][START_X], I_shape);
@@ -168,6 +222,51 @@ START_TEST(test_settleTetromino_sets_settled_state) {
 }
 END_TEST
 
+// Written out by hand, so a wrong generated table cannot agree with itself
+START_TEST(test_rotation_table_matches_known_offsets) {
+  static const struct {
+    FieldCellState_t shape;
+    Coordinates_t cells[TOTAL_ROTATIONS][4];
+  } expected[] = {
+      {J_shape,
+       {{{-1, -1}, {0, -1}, {0, 0}, {0, 1}},
+        {{1, -1}, {1, 0}, {0, 0}, {-1, 0}},
+        {{1, 1}, {0, 1}, {0, 0}, {0, -1}},
+        {{-1, 1}, {-1, 0}, {0, 0}, {1, 0}}}},
+      {S_shape,
+       {{{1, -1}, {1, 0}, {0, 0}, {0, 1}},
+        {{1, 1}, {0, 1}, {0, 0}, {-1, 0}},
+        {{-1, 1}, {-1, 0}, {0, 0}, {0, -1}},
+        {{-1, -1}, {0, -1}, {0, 0}, {1, 0}}}},
+  };
+  for (size_t s = 0; s < sizeof(expected) / sizeof(expected[0]); ++s) {
+    for (int rotation = Angle0; rotation <= Angle270; ++rotation) {
+      const Tetromino_t rotated = {.shape = expected[s].shape,
+                                   .rotation = rotation};
+      const Coordinates_t* offsets = getPieceOffsets(&rotated);
+      for (int i = 0; i < 4; ++i) {
+        ck_assert_int_eq(offsets[i].x, expected[s].cells[rotation][i].x);
+        ck_assert_int_eq(offsets[i].y, expected[s].cells[rotation][i].y);
+      }
+    }
+  }
+}
+END_TEST
+
+START_TEST(test_rotate_I_shape_kicks_off_walls) {
+  test_tetromino.centerCoords.x = FIELD_WIDTH - 1;
+  test_tetromino.centerCoords.y = 5;
+  ck_assert_int_eq(rotate(&test_state.game_info, &test_tetromino),
+                   EXIT_SUCCESS);
+  ck_assert_int_eq(test_tetromino.rotation, Angle90);
+  test_tetromino.centerCoords.x = 0;
+  ck_assert_int_eq(rotate(&test_state.game_info, &test_tetromino),
+                   EXIT_SUCCESS);
+  ck_assert_int_eq(test_tetromino.rotation, Angle0);
+  ck_assert_int_eq(test_tetromino.centerCoords.x, 1);
+}
+END_TEST
+
 // Test suite
 Suite* tetromino_suite(void) {
   Suite* s;
@@ -182,6 +281,7 @@ Suite* tetromino_suite(void) {
   tcase_add_test(tc_core, test_moveDown_successful);
   tcase_add_test(tc_core, test_moveDown_collision);
   tcase_add_test(tc_core, test_smashDown_moves_to_bottom);
+  tcase_add_test(tc_core, test_smashDown_animates_the_fall);
   tcase_add_test(tc_core, test_moveLeft_successful);
   tcase_add_test(tc_core, test_moveLeft_collision);
   tcase_add_test(tc_core, test_moveRight_successful);
@@ -190,9 +290,13 @@ Suite* tetromino_suite(void) {
   tcase_add_test(tc_core, test_rotate_I_shape_limited);
   tcase_add_test(tc_core, test_getNextTetromino_returns_valid_tetromino);
   tcase_add_test(tc_core, test_setRandomShape_updates_next);
+  tcase_add_test(tc_core, test_setRandomShape_seed_repeats_sequence);
+  tcase_add_test(tc_core, test_cleanUpData_keeps_random_stream);
   tcase_add_test(tc_core, test_putTetromino_updates_field);
   tcase_add_test(tc_core, test_removeTetromino_clears_field);
   tcase_add_test(tc_core, test_settleTetromino_sets_settled_state);
+  tcase_add_test(tc_core, test_rotation_table_matches_known_offsets);
+  tcase_add_test(tc_core, test_rotate_I_shape_kicks_off_walls);
 
   suite_add_tcase(s, tc_core);
 